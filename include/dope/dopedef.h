@@ -36,6 +36,7 @@ enum {
 	DOPECMD_ERR_UNCOMPLETE     = -24,  /* unexpected end of command             */
 	DOPECMD_ERR_NO_SUCH_SCOPE  = -25,  /* variable scope could not be resolved  */
 	DOPECMD_ERR_ILLEGAL_CMD    = -26,  /* command could not be examined         */
+	DOPECMD_ERR_NO_MEM         = -27,  /* out of memory for processing command  */
 	
 	DOPECMD_WARN_TRUNC_RET_STR =  11,  /* return string was truncated */
 };
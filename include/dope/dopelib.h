@@ -22,13 +22,16 @@ enum Event_type {
 	EVENT_TYPE_PRESS     = 3,
 	EVENT_TYPE_RELEASE   = 4,
 	EVENT_TYPE_KEYREPEAT = 5,
+	EVENT_TYPE_ATTRIB    = 6,
+	EVENT_TYPE_ROWS      = 7,
 };
 
 
 struct Command_event
 {
 	Event_type  type;               /* must be EVENT_TYPE_COMMAND */
-	char const *cmd;                /* command string */
+	char const *cmd;                /* command string, valid during the
+	                                   callback only */
 };
 
 
@@ -61,6 +64,38 @@ struct Keyrepeat_event
 };
 
 
+enum Attrib_type {
+	ATTRIB_TYPE_LONG    = 1,
+	ATTRIB_TYPE_FLOAT   = 2,
+	ATTRIB_TYPE_BOOLEAN = 3,
+	ATTRIB_TYPE_STRING  = 4,
+	ATTRIB_TYPE_WIDGET  = 5,
+};
+
+
+struct Attrib_event
+{
+	Event_type  type;               /* must be EVENT_TYPE_ATTRIB */
+	char const *name;               /* attribute as passed to dope_watch,
+	                                   valid during the callback only */
+	Attrib_type value_type;         /* type of the new value */
+	long        long_value;         /* value of long and boolean attributes,
+	                                   id of the widget referred to by
+	                                   widget attributes (0 for none) */
+	float       float_value;        /* value of float attributes */
+	char const *string;             /* value of string attributes, valid
+	                                   during the callback only */
+};
+
+
+struct Rows_event
+{
+	Event_type type;                /* must be EVENT_TYPE_ROWS */
+	long first;                     /* first row requested by a table */
+	long num;                       /* number of requested rows */
+};
+
+
 union Event_union
 {
 	Event_type type;
@@ -69,6 +104,8 @@ union Event_union
 	Press_event     press;
 	Release_event   release;
 	Keyrepeat_event keyrepeat;
+	Attrib_event    attrib;
+	Rows_event      rows;
 };
 
 
@@ -159,12 +196,50 @@ int dope_req(long app_id, char *dst, int dst_size, char const *cmd);
 int dope_reqf(long app_id, char *dst, int dst_size, char const *cmdf, ...);
 
 
+/**
+ * Entry of a bulk request
+ */
+struct Dope_req_entry
+{
+	char const *path;               /* attribute to request, e.g., "vscale.value" */
+	int         error;              /* 0 or error code of this entry */
+	Attrib_type value_type;         /* type of the value */
+	long        long_value;         /* value of long and boolean attributes,
+	                                   widget id for widget attributes */
+	float       float_value;        /* value of float attributes */
+	char const *string;             /* value of string attributes, located
+	                                   in the string buffer */
+};
+
+
+/**
+ * Request the values of several attributes at once
+ *
+ * \param app_id       DOpE application id
+ * \param entries      array of requests, the 'path' of each entry must be
+ *                     set by the caller, the other members are filled in
+ * \param num          number of entries
+ * \param strbuf       buffer for storing the values of string attributes
+ * \param strbuf_size  size of string buffer in bytes
+ * \return             0 on success or the error code of the first failed
+ *                     entry
+ *
+ * All entries are resolved in one pass without passing the command
+ * interpreter. Entries that cannot be read get a negative error code. If
+ * the string buffer is exhausted, the string is truncated and the entry
+ * gets the code DOPECMD_WARN_TRUNC_RET_STR.
+ */
+int dope_req_multi(long app_id, Dope_req_entry *entries, int num,
+                   char *strbuf, int strbuf_size);
+
+
 /**
  * Bind an event to a dope widget
  *
  * \param app_id      DOpE application id
  * \param var         widget to bind an event to
- * \param event_type  identifier for the event type
+ * \param event_type  identifier for the event type, optionally followed by
+ *                    delivery options such as '-rate 60' (see README)
  * \param callback    callback function to be called for incoming events
  * \param arg         additional argument for the callback function
  */
@@ -186,19 +261,75 @@ void dope_bindf(long id, char const *varfmt, char const *event_type,
                 void (*callback)(Event_union *,void *), void *arg,...);
 
 
+/**
+ * Subscribe to the changes of a widget attribute
+ *
+ * \param app_id    DOpE application id
+ * \param var_attr  widget attribute, e.g., "vscale.value"
+ * \param callback  callback function to be called with an 'Attrib_event'
+ * \param arg       additional argument for the callback function
+ * \return          0 on success or a negative error code
+ *
+ * The current value is reported right away, later values whenever the
+ * attribute changed. Changes are sampled once per frame, so a burst of
+ * changes results in only one event carrying the latest value. A
+ * subscription refers to the widget the variable names at the time of the
+ * call. Subscribing to the same attribute again replaces the callback.
+ */
+int dope_watch(long app_id, char const *var_attr,
+               void (*callback)(Event_union *, void *), void *arg);
+
+
+/**
+ * Cancel subscription to the changes of a widget attribute
+ *
+ * \param app_id    DOpE application id
+ * \param var_attr  widget attribute as passed to 'dope_watch'
+ */
+void dope_unwatch(long app_id, char const *var_attr);
+
+
+/**
+ * Pseudo application id referring to the events of all applications
+ *
+ * It can be passed to the event-processing functions below by programs that
+ * drive several DOpE applications from a single thread.
+ */
+enum { DOPE_ALL_APPS = -1 };
+
+
 /**
  * Enter dope eventloop
  *
- * \param app_id  DOpE application id
+ * \param app_id  DOpE application id or DOPE_ALL_APPS
  */
 void dope_eventloop(long app_id);
 
 
+/**
+ * Wait for events
+ *
+ * \param app_id   DOpE application id or DOPE_ALL_APPS
+ * \param timeout  maximum time to wait in milliseconds, a negative value
+ *                 waits without limit
+ * \return         number of pending events, 0 if the timeout expired
+ *
+ * While waiting, user input, timer ticks, and redraw work are processed.
+ * The calling thread sleeps as long as there is nothing to do. Only one
+ * thread waits for input at a time. If several threads wait concurrently,
+ * the timeouts of the other threads may expire late.
+ */
+int dope_wait_event(long app_id, long timeout);
+
+
 /**
  * Return number of pending events
  *
- * \param app_id  DOpE application id
+ * \param app_id  DOpE application id or DOPE_ALL_APPS
  * \return        number of pending events
+ *
+ * This function handles input that arrived in the meantime but does not
+ * block.
  */
 int dope_events_pending(int app_id);
 
@@ -209,8 +340,10 @@ int dope_events_pending(int app_id);
  * This function processes exactly one DOpE event. If no event is pending, it
  * blocks until an event is available. Thus, for non-blocking operation, this
  * function should be called only if dope_events_pending was consulted before.
+ * The event callback is executed by the calling thread without holding the
+ * internal lock of DOpE. So it may issue commands and wait for events.
  *
- * \param app_id  DOpE application id
+ * \param app_id  DOpE application id or DOPE_ALL_APPS
  */
 void dope_process_event(long app_id);
 
@@ -0,0 +1,245 @@
+/*
+ * \brief   Binary command stream interface of DOpE
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * Besides the textual command language, DOpE accepts a compact stream of
+ * opcodes via 'dope_submit'. The stream selects widgets, assigns attributes
+ * and calls widget methods with typed arguments. Because attributes and
+ * methods are looked up in the same registry as used by the command
+ * interpreter, each widget is accessible via both interfaces.
+ *
+ * Stream layout (all values in native byte order):
+ *
+ * ! op    := OP_VAR name | OP_SET name value | OP_CALL name argc value*
+ * ! name  := u8 length, characters
+ * ! value := u8 type, payload
+ *
+ * Names are not null-terminated. Widget names may contain dots to refer to
+ * widgets of sub scopes. An empty name passed to OP_VAR selects the root
+ * scope of the application. String payloads consist of a u16 length, the
+ * characters, and a terminating zero. Widget payloads are names, an empty
+ * name stands for 'none'. Method arguments are passed positionally, omitted
+ * trailing arguments take their default values.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _INCLUDE__DOPE__OPSTREAM_H_
+#define _INCLUDE__DOPE__OPSTREAM_H_
+
+#include <base/stdint.h>
+
+enum Dope_opcode {
+	DOPE_OP_VAR  = 1,  /* select target widget        */
+	DOPE_OP_SET  = 2,  /* assign attribute of target  */
+	DOPE_OP_CALL = 3,  /* call method of target       */
+};
+
+
+enum Dope_optype {
+	DOPE_OPTYPE_LONG    = 1,  /* payload: long           */
+	DOPE_OPTYPE_FLOAT   = 2,  /* payload: float          */
+	DOPE_OPTYPE_BOOLEAN = 3,  /* payload: u8             */
+	DOPE_OPTYPE_STRING  = 4,  /* payload: u16 len, chars */
+	DOPE_OPTYPE_WIDGET  = 5,  /* payload: name           */
+};
+
+
+/**
+ * Execute binary command stream
+ *
+ * \param app_id  DOpE application id
+ * \param buf     opcode stream
+ * \param len     length of opcode stream in bytes
+ * \return        0 on success or the error code of the first failed operation
+ *
+ * The operations are processed in order. Processing stops at the first
+ * failed operation.
+ */
+int dope_submit(long app_id, void const *buf, Genode::size_t len);
+
+
+/***************************************
+ ** Encoder for binary command stream **
+ ***************************************/
+
+struct Dope_opstream
+{
+	unsigned char *buf;       /* destination buffer              */
+	Genode::size_t size;      /* size of destination buffer      */
+	Genode::size_t len;       /* number of bytes encoded so far  */
+	int            overflow;  /* set if an operation did not fit */
+};
+
+
+static inline void _dope_op_put(Dope_opstream *s, void const *src, Genode::size_t n)
+{
+	if (s->overflow || s->len + n > s->size) {
+		s->overflow = 1;
+		return;
+	}
+	for (Genode::size_t i = 0; i < n; i++)
+		s->buf[s->len++] = ((unsigned char const *)src)[i];
+}
+
+
+static inline void _dope_op_u8(Dope_opstream *s, unsigned v)
+{
+	unsigned char c = (unsigned char)v;
+	_dope_op_put(s, &c, 1);
+}
+
+
+static inline void _dope_op_name(Dope_opstream *s, char const *name)
+{
+	Genode::size_t len = 0;
+	while (name && name[len]) len++;
+	if (len > 255) {
+		s->overflow = 1;
+		return;
+	}
+	_dope_op_u8(s, len);
+	_dope_op_put(s, name, len);
+}
+
+
+/**
+ * Initialize encoder
+ *
+ * \param buf   destination buffer
+ * \param size  size of destination buffer in bytes
+ *
+ * If the buffer becomes exhausted, the 'overflow' flag is set and further
+ * operations are dropped. A stream with the overflow flag set must not be
+ * submitted.
+ */
+static inline void dope_op_init(Dope_opstream *s, void *buf, Genode::size_t size)
+{
+	s->buf      = (unsigned char *)buf;
+	s->size     = size;
+	s->len      = 0;
+	s->overflow = 0;
+}
+
+
+/**
+ * Select widget to apply the subsequent operations to
+ */
+static inline void dope_op_var(Dope_opstream *s, char const *name)
+{
+	_dope_op_u8(s, DOPE_OP_VAR);
+	_dope_op_name(s, name);
+}
+
+
+/**
+ * Start method call with 'argc' arguments
+ *
+ * The call must be followed by exactly 'argc' 'dope_op_arg_*' operations.
+ */
+static inline void dope_op_call(Dope_opstream *s, char const *method, unsigned argc)
+{
+	_dope_op_u8(s, DOPE_OP_CALL);
+	_dope_op_name(s, method);
+	_dope_op_u8(s, argc);
+}
+
+
+/*
+ * Typed values, used as method arguments
+ */
+
+static inline void dope_op_arg_long(Dope_opstream *s, long v)
+{
+	_dope_op_u8(s, DOPE_OPTYPE_LONG);
+	_dope_op_put(s, &v, sizeof(v));
+}
+
+
+static inline void dope_op_arg_float(Dope_opstream *s, float v)
+{
+	_dope_op_u8(s, DOPE_OPTYPE_FLOAT);
+	_dope_op_put(s, &v, sizeof(v));
+}
+
+
+static inline void dope_op_arg_bool(Dope_opstream *s, int v)
+{
+	_dope_op_u8(s, DOPE_OPTYPE_BOOLEAN);
+	_dope_op_u8(s, v ? 1 : 0);
+}
+
+
+static inline void dope_op_arg_string(Dope_opstream *s, char const *str)
+{
+	Genode::size_t len = 0;
+	while (str && str[len]) len++;
+	if (len > 0xffff) {
+		s->overflow = 1;
+		return;
+	}
+	unsigned short l = (unsigned short)len;
+	_dope_op_u8(s, DOPE_OPTYPE_STRING);
+	_dope_op_put(s, &l, sizeof(l));
+	_dope_op_put(s, str, len);
+	_dope_op_u8(s, 0);
+}
+
+
+static inline void dope_op_arg_widget(Dope_opstream *s, char const *name)
+{
+	_dope_op_u8(s, DOPE_OPTYPE_WIDGET);
+	_dope_op_name(s, name);
+}
+
+
+/*
+ * Attribute assignments to the selected widget
+ */
+
+static inline void dope_op_set_long(Dope_opstream *s, char const *attr, long v)
+{
+	_dope_op_u8(s, DOPE_OP_SET);
+	_dope_op_name(s, attr);
+	dope_op_arg_long(s, v);
+}
+
+
+static inline void dope_op_set_float(Dope_opstream *s, char const *attr, float v)
+{
+	_dope_op_u8(s, DOPE_OP_SET);
+	_dope_op_name(s, attr);
+	dope_op_arg_float(s, v);
+}
+
+
+static inline void dope_op_set_bool(Dope_opstream *s, char const *attr, int v)
+{
+	_dope_op_u8(s, DOPE_OP_SET);
+	_dope_op_name(s, attr);
+	dope_op_arg_bool(s, v);
+}
+
+
+static inline void dope_op_set_string(Dope_opstream *s, char const *attr, char const *str)
+{
+	_dope_op_u8(s, DOPE_OP_SET);
+	_dope_op_name(s, attr);
+	dope_op_arg_string(s, str);
+}
+
+
+static inline void dope_op_set_widget(Dope_opstream *s, char const *attr, char const *name)
+{
+	_dope_op_u8(s, DOPE_OP_SET);
+	_dope_op_name(s, attr);
+	dope_op_arg_widget(s, name);
+}
+
+#endif /* _INCLUDE__DOPE__OPSTREAM_H_ */
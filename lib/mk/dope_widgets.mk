@@ -3,4 +3,6 @@ SRC_C  = $(addprefix data/,$(notdir $(wildcard $(REP_DIR)/src/lib/dope_widgets/d
 
 CC_OLEVEL = -O0
 
+LIBS = config
+
 vpath % $(REP_DIR)/src/lib/dope_widgets
@@ -16,6 +16,11 @@
  * the terms of the GNU General Public Licence 2.
  */
 
+/* Genode includes */
+#include <base/lock.h>
+#include <base/thread.h>
+
+/* local includes */
 #include "dopestd.h"
 #include "hashtab.h"
 #include "appman.h"
@@ -23,7 +28,6 @@
 #include "scope.h"
 
 enum {
-	MAX_APPS    = 64,   /* maximum amount of DOpE clients          */
 	APP_NAMELEN = 64,   /* application identifier string length    */
 };
 
@@ -36,10 +40,28 @@ struct app {
 };
 
 
+/**
+ * Lock that can be acquired multiple times by the same thread
+ *
+ * Event callbacks are called synchronously while the widget tree is locked.
+ * If such a callback issues DOpE commands, the lock is acquired again by the
+ * same thread.
+ */
+struct nested_lock {
+	Genode::Lock         lock;
+	Genode::Thread_base *owner;   /* thread holding the lock     */
+	int                  depth;   /* number of nested lock calls */
+};
+
 extern SCREEN *curr_scr;
 
 static struct app *apps[MAX_APPS];
 
+static struct nested_lock tree_lock;   /* lock of the widget tree */
+
+/* per-application locks serializing the access to interpreter state */
+static Genode::Lock cmd_locks[MAX_APPS];
+
 int init_appman(struct dope_services *d);
 
 
@@ -115,6 +137,30 @@ static u16 app_id_valid(u32 app_id)
 }
 
 
+static void nested_lock_acquire(struct nested_lock *l)
+{
+	Genode::Thread_base *myself = Genode::Thread_base::myself();
+
+	/*
+	 * The owner is assigned before the depth is incremented. So a thread
+	 * that sees a non-zero depth never sees itself as owner of a lock held
+	 * by another thread.
+	 */
+	if (l->depth == 0 || l->owner != myself) {
+		l->lock.lock();
+		l->owner = myself;
+	}
+	l->depth++;
+}
+
+
+static void nested_lock_release(struct nested_lock *l)
+{
+	if (--l->depth == 0)
+		l->lock.unlock();
+}
+
+
 /**
  * Return name of application with the specified id
  */
@@ -170,7 +216,7 @@ static s32 unregister_app(u32 app_id)
 	app = apps[app_id];
 	if (!app) return -1;
 
-	curr_scr->gen->lock((WIDGET *)curr_scr);
+	nested_lock_acquire(&tree_lock);
 
 	/* prevent any events to be delivered anymore */
 	app->listener = NULL;
@@ -184,7 +230,7 @@ static s32 unregister_app(u32 app_id)
 	/* mark the corresponding app_id to be free */
 	apps[app_id] = NULL;
 
-	curr_scr->gen->unlock((WIDGET *)curr_scr);
+	nested_lock_release(&tree_lock);
 	return 0;
 }
 
@@ -260,24 +306,44 @@ static s32 app_id_of_name(char const *app_name)
 
 
 /**
- * Lock application for mutual exclusive modifications
+ * Lock widget tree for mutual exclusive modifications
+ *
+ * The widget tree is shared by all applications. Hence, the lock is global.
+ * It may be acquired multiple times by the same thread.
  */
 static void lock(s32 app_id)
 {
-	if (curr_scr) {
-		curr_scr->gen->lock((WIDGET *)curr_scr);
-	} else {
-		printf("AppMan(lock): lock not possible because curr_scr is not defined.\n");
-	}
+	nested_lock_acquire(&tree_lock);
 }
 
 
 /**
- * Unlock application
+ * Unlock widget tree
  */
 static void unlock(s32 app_id)
 {
-	if (curr_scr) curr_scr->gen->unlock((WIDGET *)curr_scr);
+	nested_lock_release(&tree_lock);
+}
+
+
+/**
+ * Lock command interpreter state of an application
+ *
+ * In contrast to the widget-tree lock, the command lock is only held for
+ * short periods and must not be acquired twice by the same thread.
+ */
+static void lock_cmd(s32 app_id)
+{
+	if (app_id >= 0 && app_id < MAX_APPS) cmd_locks[app_id].lock();
+}
+
+
+/**
+ * Unlock command interpreter state of an application
+ */
+static void unlock_cmd(s32 app_id)
+{
+	if (app_id >= 0 && app_id < MAX_APPS) cmd_locks[app_id].unlock();
 }
 
 
@@ -297,6 +363,8 @@ static struct appman_services services = {
 	app_id_of_name,
 	lock,
 	unlock,
+	lock_cmd,
+	unlock_cmd,
 };
 
 
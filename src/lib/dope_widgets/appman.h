@@ -18,6 +18,10 @@
 #include "hashtab.h"
 #include "scope.h"
 
+enum {
+	MAX_APPS = 64,   /* maximum amount of DOpE clients */
+};
+
 struct appman_services {
 	s32         (*reg_app)          (char const *app_name);
 	s32         (*unreg_app)        (u32 app_id);
@@ -30,6 +34,8 @@ struct appman_services {
 	s32         (*app_id_of_name)   (char const *app_name);
 	void        (*lock)             (s32 app_id);
 	void        (*unlock)           (s32 app_id);
+	void        (*lock_cmd)         (s32 app_id);
+	void        (*unlock_cmd)       (s32 app_id);
 };
 
 
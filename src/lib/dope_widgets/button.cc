@@ -38,6 +38,7 @@ static struct messenger_services *msg;
 
 struct button_data {
 	char const *text;
+	struct text_layout *layout;            /* cached layout of text           */
 	s16         style;
 	s16         font_id;
 	s16         tx, ty;                    /* text position inside the button */
@@ -71,10 +72,27 @@ static const color_t DARK_GREY   = GFX_RGBA(80, 80, 80, 255);
  ** Functions for internal use **
  ********************************/
 
+/**
+ * Replace cached layout after a change of the text or font
+ */
+static void update_layout(BUTTON *b)
+{
+	font->release_layout(b->bd->layout);
+	b->bd->layout = font->get_layout(b->bd->font_id, b->bd->text);
+}
+
+
+static inline s32 text_width(BUTTON *b)
+{
+	if (b->bd->layout) return b->bd->layout->width;
+	return font->calc_str_width(b->bd->font_id, b->bd->text);
+}
+
+
 static void update_text_pos(BUTTON *b)
 {
 	if (!b->bd->text) return;
-	b->bd->tx = (b->wd->w - 2*b->bd->pad_x - font->calc_str_width (b->bd->font_id, b->bd->text))>>1;
+	b->bd->tx = (b->wd->w - 2*b->bd->pad_x - text_width(b))>>1;
 	b->bd->ty = (b->wd->h - 2*b->bd->pad_y - font->calc_str_height(b->bd->font_id, b->bd->text))>>1;
 }
 
@@ -197,17 +215,16 @@ static int but_draw(BUTTON *b, struct gfx_ds *ds, long x, long y, WIDGET *origin
 	gfx->push_clipping(ds, x + 2, y + 2, w - 4, h - 4);
 
 	if (b->bd->text) {
-		switch (b->bd->style) {
-			case 1:
-				gfx->draw_string(ds, tx, ty, BLACK_SOLID, 0, b->bd->font_id, b->bd->text);
-				break;
-			case 2:
-				gfx->draw_string(ds, tx, ty, DARK_GREY, 0, b->bd->font_id, b->bd->text);
-				break;
-			default:
-				gfx->draw_string(ds, tx, ty, DARK_GREY, 0, b->bd->font_id, b->bd->text);
-				break;
+		color_t     color = (b->bd->style == 1) ? BLACK_SOLID : DARK_GREY;
+		char const *text  = b->bd->text;
+
+		/* skip characters left of the clipping area */
+		if (b->bd->layout) {
+			s32 i = font->layout_char_at(b->bd->layout, gfx->get_clip_x(ds) - tx);
+			tx   += b->bd->layout->offsets[i];
+			text  = b->bd->layout->str + i;
 		}
+		gfx->draw_string(ds, tx, ty, color, 0, b->bd->font_id, text);
 	}
 
 	gfx->pop_clipping(ds);
@@ -219,14 +236,14 @@ static int but_draw(BUTTON *b, struct gfx_ds *ds, long x, long y, WIDGET *origin
 
 static void but_untouch_callback(BUTTON *b, int dx, int dy)
 {
-	char const *clack_msg, *commit_msg = NULL;
+	struct binding *clack_msg, *commit_msg = NULL;
 	
 	if (!b->gen->get_state(b)) return;
 	
-	clack_msg = b->gen->get_bind_msg(b, "clack");
+	clack_msg = b->gen->get_binding(b, "clack");
 	if (clack_msg) msg->send_action_event(b->gen->get_app_id(b), "clack", clack_msg);
 
-	commit_msg = b->gen->get_bind_msg(b, "commit");
+	commit_msg = b->gen->get_binding(b, "commit");
 	if (commit_msg && config_clackcommit)
 		msg->send_action_event(b->gen->get_app_id(b), "commit", commit_msg);
 }
@@ -235,7 +252,7 @@ static void but_untouch_callback(BUTTON *b, int dx, int dy)
 static void (*orig_handle_event) (BUTTON *b, EVENT *e, WIDGET *from);
 static void but_handle_event(BUTTON *b, EVENT *e, WIDGET *from)
 {
-	char const *click_msg, *clack_msg, *commit_msg = NULL;
+	struct binding *click_msg, *clack_msg, *commit_msg = NULL;
 	switch (e->type) {
 
 	case EVENT_PRESS:
@@ -245,9 +262,9 @@ static void but_handle_event(BUTTON *b, EVENT *e, WIDGET *from)
 
 		if (b->bd->click) b->bd->click(b);
 
-		click_msg  = b->gen->get_bind_msg(b, "click");
-		clack_msg  = b->gen->get_bind_msg(b, "clack");
-		commit_msg = b->gen->get_bind_msg(b, "commit");
+		click_msg  = b->gen->get_binding(b, "click");
+		clack_msg  = b->gen->get_binding(b, "clack");
+		commit_msg = b->gen->get_binding(b, "commit");
 
 		if (click_msg || clack_msg || commit_msg)
 			userstate->touch(b, NULL, but_untouch_callback);
@@ -292,8 +309,7 @@ static void but_calc_minmax(BUTTON *b)
 
 	/* the min/max height of the button depends on its text */
 	if (b->bd->text) {
-		b->wd->min_w = font->calc_str_width (b->bd->font_id, b->bd->text)
-		             + b->bd->pad_x * 2 + 6;
+		b->wd->min_w = text_width(b) + b->bd->pad_x * 2 + 6;
 		b->wd->min_h = font->calc_str_height(b->bd->font_id, b->bd->text)
 		             + b->bd->pad_y * 2 + 6;
 		b->wd->max_w = 9999;
@@ -334,17 +350,20 @@ static void but_updatepos(BUTTON *b)
 static void but_free_data(BUTTON *b)
 {
 	if (b->bd->text) free(b->bd->text);
+	font->release_layout(b->bd->layout);
 }
 
 
 /**
  * Catch bind calls to enable the keyboard focus
  */
-static void (*orig_bind) (BUTTON *b, char const *bind_ident, char const *message);
-static void but_bind(BUTTON *b, char const *bind_ident, char const *message)
+static void (*orig_bind) (BUTTON *b, char const *bind_ident,
+                          void (*callback)(Event_union *, void *), void *arg);
+static void but_bind(BUTTON *b, char const *bind_ident,
+                     void (*callback)(Event_union *, void *), void *arg)
 {
 	b->wd->flags |= WID_FLAGS_TAKEFOCUS;
-	orig_bind(b, bind_ident, message);
+	orig_bind(b, bind_ident, callback, arg);
 }
 
 
@@ -367,6 +386,7 @@ static void but_set_text(BUTTON *b, char const *new_txt)
 		free(b->bd->text);
 	}
 	b->bd->text = strdup(new_txt);
+	update_layout(b);
 
 	/*
 	 * If a button's size is completely free, a change
@@ -391,6 +411,7 @@ static char const *but_get_text(BUTTON *b)
 static void but_set_font(BUTTON *b, s32 font_id)
 {
 	b->bd->font_id = font_id;
+	update_layout(b);
 	b->wd->update |= WID_UPDATE_MINMAX;
 }
 
@@ -548,17 +569,17 @@ int init_button(struct dope_services *d)
 	/* define general widget functions */
 	widman->default_widget_methods(&gen_methods);
 
-	orig_updatepos    = gen_methods.updatepos;
-	orig_handle_event = gen_methods.handle_event;
-	orig_bind         = gen_methods.bind;
-
-	gen_methods.get_type     = but_get_type;
-	gen_methods.draw         = but_draw;
-	gen_methods.updatepos    = but_updatepos;
-	gen_methods.handle_event = but_handle_event;
-	gen_methods.calc_minmax  = but_calc_minmax;
-	gen_methods.free_data    = but_free_data;
-	gen_methods.bind         = but_bind;
+	orig_updatepos            = gen_methods.updatepos;
+	orig_handle_event         = gen_methods.handle_event;
+	orig_bind                 = gen_methods.bind_callback;
+
+	gen_methods.get_type      = but_get_type;
+	gen_methods.draw          = but_draw;
+	gen_methods.updatepos     = but_updatepos;
+	gen_methods.handle_event  = but_handle_event;
+	gen_methods.calc_minmax   = but_calc_minmax;
+	gen_methods.free_data     = but_free_data;
+	gen_methods.bind_callback = but_bind;
 
 	build_script_lang();
 
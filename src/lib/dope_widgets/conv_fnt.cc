@@ -343,20 +343,62 @@ static void font_gen_image(struct fntfile_hdr *fnt, u8 *dst)
 }
 
 
+/**
+ * Return font image
+ *
+ * The image of fnt data is bit-packed and must be generated via
+ * 'font_gen_image'.
+ */
+static u8 *font_get_image(struct fntfile_hdr *fnt)
+{
+	return NULL;
+}
+
+
+/**
+ * Check completeness of font data
+ *
+ * Because 'font_probe' modifies the font data, fnt data is not suited
+ * for read-only mappings.
+ */
+static s16 font_check(struct fntfile_hdr *fnt, unsigned long size)
+{
+	return 0;
+}
+
+
+/**
+ * Generate width and offset table of a glyph page
+ *
+ * FNT fonts contain the glyphs of the code points 0 to 255 only.
+ */
+static s16 font_gen_glyph_page(struct fntfile_hdr *fnt, u32 page, s32 *dst_wtab, s32 *dst_otab)
+{
+	if (page) return 0;
+
+	font_gen_width_table(fnt, dst_wtab);
+	font_gen_offset_table(fnt, dst_otab);
+	return 1;
+}
+
+
 /**************************************
  ** Service structure of this module **
  **************************************/
 
 static struct fontconv_services services = {
-	(s16         (*) (void *))        font_probe,
-	(void        (*) (void *, s32 *)) font_gen_width_table,
-	(void        (*) (void *, s32 *)) font_gen_offset_table,
-	(char const *(*) (void *))        font_get_name,
-	(u16         (*) (void *))        font_get_top,
-	(u16         (*) (void *))        font_get_bottom,
-	(u32         (*) (void *))        font_get_image_width,
-	(u32         (*) (void *))        font_get_image_height,
-	(void        (*) (void *, u8 *))  font_gen_image,
+	(s16         (*) (void *))                    font_probe,
+	(void        (*) (void *, s32 *))             font_gen_width_table,
+	(void        (*) (void *, s32 *))             font_gen_offset_table,
+	(char const *(*) (void *))                    font_get_name,
+	(u16         (*) (void *))                    font_get_top,
+	(u16         (*) (void *))                    font_get_bottom,
+	(u32         (*) (void *))                    font_get_image_width,
+	(u32         (*) (void *))                    font_get_image_height,
+	(void        (*) (void *, u8 *))              font_gen_image,
+	(u8         *(*) (void *))                    font_get_image,
+	(s16         (*) (void *, unsigned long))     font_check,
+	(s16         (*) (void *, u32, s32 *, s32 *)) font_gen_glyph_page,
 };
 
 
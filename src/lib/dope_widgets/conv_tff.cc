@@ -160,20 +160,66 @@ static void font_gen_image(struct tff_file_hdr *tff, u8 *dst)
 }
 
 
+/**
+ * Return font image, which directly follows the file header
+ */
+static u8 *font_get_image(struct tff_file_hdr *tff)
+{
+	return (u8 *)tff + sizeof(*tff);
+}
+
+
+/**
+ * Check completeness of font data
+ */
+static s16 font_check(struct tff_file_hdr *tff, unsigned long size)
+{
+	unsigned long img_w, img_h;
+
+	if (size < sizeof(*tff)) return 0;
+
+	img_w = font_get_image_width(tff);
+	img_h = font_get_image_height(tff);
+
+	/* reject sizes that would overflow the image size calculation */
+	if (img_w > 0xffff || img_h > 0xffff) return 0;
+
+	return img_w*img_h <= size - sizeof(*tff);
+}
+
+
+/**
+ * Generate width and offset table of a glyph page
+ *
+ * TFF fonts contain the glyphs of the code points 0 to 255 only.
+ */
+static s16 font_gen_glyph_page(struct tff_file_hdr *tff, u32 page, s32 *dst_wtab, s32 *dst_otab)
+{
+	if (page) return 0;
+
+	font_gen_width_table(tff, dst_wtab);
+	font_gen_offset_table(tff, dst_otab);
+	return 1;
+}
+
+
 /**************************************
  ** Service structure of this module **
  **************************************/
 
 static struct fontconv_services services = {
-	(s16         (*) (void *))       font_probe,
-	(void        (*) (void *,s32 *)) font_gen_width_table,
-	(void        (*) (void *,s32 *)) font_gen_offset_table,
-	(char const *(*) (void *))       font_get_name,
-	(u16         (*) (void *))       font_get_top,
-	(u16         (*) (void *))       font_get_bottom,
-	(u32         (*) (void *))       font_get_image_width,
-	(u32         (*) (void *))       font_get_image_height,
-	(void        (*) (void *,u8 *))  font_gen_image,
+	(s16         (*) (void *))                 font_probe,
+	(void        (*) (void *,s32 *))           font_gen_width_table,
+	(void        (*) (void *,s32 *))           font_gen_offset_table,
+	(char const *(*) (void *))                 font_get_name,
+	(u16         (*) (void *))                 font_get_top,
+	(u16         (*) (void *))                 font_get_bottom,
+	(u32         (*) (void *))                 font_get_image_width,
+	(u32         (*) (void *))                 font_get_image_height,
+	(void        (*) (void *,u8 *))            font_gen_image,
+	(u8         *(*) (void *))                 font_get_image,
+	(s16         (*) (void *,unsigned long))   font_check,
+	(s16         (*) (void *,u32,s32 *,s32 *)) font_gen_glyph_page,
 };
 
 
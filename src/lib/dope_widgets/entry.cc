@@ -28,7 +28,9 @@ struct entry;
 #include "userstate.h"
 #include "messenger.h"
 #include "relax.h"
-#include "tick.h"
+#include "redraw.h"
+#include "utf8.h"
+#include "fenwick.h"
 
 static struct widman_services    *widman;
 static struct gfx_services       *gfx;
@@ -37,12 +39,13 @@ static struct script_services    *script;
 static struct userstate_services *userstate;
 static struct relax_services     *relax;
 static struct messenger_services *msg;
-static struct tick_services      *tick;
+static struct redraw_services    *redraw;
 
 struct entry_data {
 	s16    font_id;                  /* used font                      */
 	s16    flags;                    /* entry properties               */
 	RELAX  tx;                       /* adaptive text position         */
+	struct relax_anim *tx_anim;      /* running text animation         */
 	s16    ty;                       /* text position inside the entry */
 	s32    tw, th;                   /* pixel width and height of text */
 	s32    sel_beg, sel_end;         /* current selection              */
@@ -50,8 +53,10 @@ struct entry_data {
 	s32    curpos;                   /* position of cursor             */
 	s32    cx, ch;                   /* cursor x position and height   */
 	s16    pad_x, pad_y;             /* padding aroung entry           */
-	char  *txtbuf;                   /* textual content of the entry   */
+	char  *txtbuf;                   /* gap buffer holding the text    */
 	s32    txtbuflen;                /* current size of text buffer    */
+	s32    gap_beg, gap_end;         /* gap within the text buffer     */
+	s32   *widths;                   /* index of character widths      */
 	s32    maxlen;                   /* max string length              */
 	s32    vislen;                   /* min visible length             */
 	void (*click)  (WIDGET *);
@@ -78,62 +83,213 @@ int init_entry(struct dope_services *d);
  ** Functions for internal use **
  ********************************/
 
+/*
+ * The text of an entry is stored in a gap buffer. The gap is located at
+ * the most recent edit position so that inserting and deleting characters
+ * at the cursor does not move the tail of the text. The character at
+ * 'gap_beg' is always null, which terminates the text in front of the
+ * gap. The text behind the gap is terminated by the end of the buffer.
+ *
+ * The text is well-formed UTF-8 and the gap never splits a character.
+ * Text indices are byte indices that refer to the start of a character.
+ *
+ * The pixel widths of the characters are kept in a Fenwick tree indexed
+ * by buffer position. The width of a character is assigned to its first
+ * byte. The other bytes of a character as well as the positions within
+ * the gap have a width of zero.
+ */
+
 /**
- * Delete character at specified string position
+ * Return width of the character that starts at the specified buffer position
+ */
+static inline s32 char_width(ENTRY *e, s32 pos)
+{
+	char const  *s = e->ed->txtbuf + pos;
+	struct font *f;
+	s32 offset;
+
+	if (utf8_is_cont(*s)) return 0;
+
+	/* in blind mode, each character is displayed as asterisk */
+	if (e->ed->flags & ENTRY_FLAGS_BLIND)
+		return font->calc_str_width(e->ed->font_id, "*");
+
+	f = font->get_by_id(e->ed->font_id);
+	return f ? font_glyph(font, f, utf8_decode(&s), &offset) : 0;
+}
+
+
+static inline s32 gap_len(ENTRY *e)
+{
+	return e->ed->gap_end - e->ed->gap_beg;
+}
+
+
+static inline s32 text_len(ENTRY *e)
+{
+	return e->ed->txtbuflen - gap_len(e);
+}
+
+
+/**
+ * Return buffer position of the character at the specified text index
+ */
+static inline s32 buf_pos(ENTRY *e, s32 idx)
+{
+	return idx < e->ed->gap_beg ? idx : idx + gap_len(e);
+}
+
+
+/**
+ * Return text index of the character in front of the specified index
+ */
+static s32 prev_char(ENTRY *e, s32 idx)
+{
+	do idx--; while (idx > 0 && utf8_is_cont(e->ed->txtbuf[buf_pos(e, idx)]));
+	return MAX(idx, 0);
+}
+
+
+/**
+ * Return text index of the character behind the specified index
+ */
+static s32 next_char(ENTRY *e, s32 idx)
+{
+	s32 len = text_len(e);
+
+	do idx++; while (idx < len && utf8_is_cont(e->ed->txtbuf[buf_pos(e, idx)]));
+	return MIN(idx, len);
+}
+
+
+static void build_index(ENTRY *e)
+{
+	s32 n = e->ed->txtbuflen;
+
+	e->ed->widths[0] = 0;
+	for (s32 i = 0; i < n; i++)
+		e->ed->widths[i + 1] = (i < e->ed->gap_beg || i >= e->ed->gap_end)
+		                     ? char_width(e, i) : 0;
+	fenwick_build(e->ed->widths, n);
+}
+
+
+/**
+ * Replace text buffer by a buffer of the specified size
  *
- * \return   1 on success
+ * The gap takes all the space that is not occupied by text.
+ *
+ * \return  1 on success
  */
-static int delete_char(ENTRY *e, int idx)
+static int resize_buffer(ENTRY *e, s32 size)
 {
-	char *dst = e->ed->txtbuf + idx;
-	char *src = e->ed->txtbuf + idx + 1;
-	if (idx >= (int)strlen(e->ed->txtbuf)) return 0;
-	while (*src) *(dst++) = *(src++);
-	*dst = 0;
+	s32   tail = e->ed->txtbuflen - e->ed->gap_end;
+	char *buf  = (char *)zalloc(size + 1);
+	s32  *wtab = (s32  *)malloc((size + 1)*sizeof(s32));
+
+	if (!buf || !wtab) {
+		free(buf);
+		free(wtab);
+		return 0;
+	}
+
+	memcpy(buf, e->ed->txtbuf, e->ed->gap_beg);
+	memcpy(buf + size - tail, e->ed->txtbuf + e->ed->gap_end, tail);
+	free(e->ed->txtbuf);
+	free(e->ed->widths);
+
+	e->ed->txtbuf    = buf;
+	e->ed->widths    = wtab;
+	e->ed->txtbuflen = size;
+	e->ed->gap_end   = size - tail;
+	build_index(e);
 	return 1;
 }
 
 
 /**
- * Insert character at specified string position
+ * Move gap to the specified text index
  *
- * If the string buffer exceeds, a new one is allocated.
+ * The text is moved byte by byte. The width of a character is determined
+ * at the position where the character is complete, which is behind the
+ * gap in both directions.
+ */
+static void move_gap(ENTRY *e, s32 idx)
+{
+	char *buf = e->ed->txtbuf;
+
+	/* move characters in front of the gap to its end */
+	while (e->ed->gap_beg > idx) {
+		s32 w;
+		buf[--e->ed->gap_end] = buf[--e->ed->gap_beg];
+		w = char_width(e, e->ed->gap_end);
+		fenwick_add(e->ed->widths, e->ed->txtbuflen, e->ed->gap_beg, -w);
+		fenwick_add(e->ed->widths, e->ed->txtbuflen, e->ed->gap_end,  w);
+	}
+
+	/* move characters behind the gap to its start */
+	while (e->ed->gap_beg < idx) {
+		s32 w = char_width(e, e->ed->gap_end);
+		buf[e->ed->gap_beg++] = buf[e->ed->gap_end++];
+		fenwick_add(e->ed->widths, e->ed->txtbuflen, e->ed->gap_end - 1, -w);
+		fenwick_add(e->ed->widths, e->ed->txtbuflen, e->ed->gap_beg - 1,  w);
+	}
+
+	buf[e->ed->gap_beg] = 0;
+}
+
+
+/**
+ * Delete character at specified string position
  *
  * \return   1 on success
  */
-static int insert_char(ENTRY *e, int idx, char c)
-{
-	int i, len = strlen(e->ed->txtbuf);
-	char *src, *dst;
-
-	/* if txtbuffer exceeds, reallocate a bigger one */
-	if (len >= e->ed->txtbuflen) {
-		char *buf;
-		e->ed->txtbuflen = e->ed->txtbuflen * 2 + 1;
-		buf = (char *)zalloc(e->ed->txtbuflen);
-		if (!buf) return 0;
-		for(i=0; i<=len; i++) buf[i] = e->ed->txtbuf[i];
-		free(e->ed->txtbuf);
-		e->ed->txtbuf = buf;
-	}
-	dst = e->ed->txtbuf + len;
-	src = dst - 1;
+static int delete_char(ENTRY *e, int idx)
+{
+	if (idx < 0 || idx >= text_len(e)) return 0;
 
-	/* move tail of string to the right */
-	for (i=0; i<len-idx; i++) *(dst--) = *(src--);
+	move_gap(e, idx);
+	fenwick_add(e->ed->widths, e->ed->txtbuflen, e->ed->gap_end, -char_width(e, e->ed->gap_end));
 
-	/* insert character */
-	*dst = c;
+	do e->ed->gap_end++;
+	while (e->ed->gap_end < e->ed->txtbuflen && utf8_is_cont(e->ed->txtbuf[e->ed->gap_end]));
 	return 1;
 }
 
 
+/**
+ * Insert character at specified string position
+ *
+ * If the gap of the text buffer is exhausted, a bigger buffer is
+ * allocated.
+ *
+ * \param c  unicode code point
+ * \return   number of inserted bytes, 0 on failure
+ */
+static int insert_char(ENTRY *e, int idx, u32 c)
+{
+	char seq[UTF8_MAX_LEN];
+	int  len = utf8_encode(c, seq);
+
+	/* keep at least one gap position for the null termination */
+	if (gap_len(e) < len + 1 && !resize_buffer(e, e->ed->txtbuflen*2 + len + 1))
+		return 0;
+
+	move_gap(e, idx);
+	memcpy(e->ed->txtbuf + e->ed->gap_beg, seq, len);
+	fenwick_add(e->ed->widths, e->ed->txtbuflen, e->ed->gap_beg, char_width(e, e->ed->gap_beg));
+	e->ed->gap_beg += len;
+	e->ed->txtbuf[e->ed->gap_beg] = 0;
+	return len;
+}
+
+
 static int tick_relax_tx(void *arg)
 {
 	ENTRY *e = (ENTRY *)arg;
 
 	if (!relax->do_relax(&e->ed->tx)) {
-		e->gen->dec_ref(e);
+		e->ed->tx_anim = NULL;
 		return 0;   /* stop ticking */
 	}
 	e->gen->force_redraw(e);
@@ -146,30 +302,45 @@ static int tick_relax_tx(void *arg)
  */
 static inline int get_char_pos(ENTRY *e, int idx)
 {
-	int xpos, tmp = e->ed->txtbuf[idx];
-
-	if (e->ed->flags & ENTRY_FLAGS_BLIND)
-		return idx*font->calc_str_width(e->ed->font_id, "*");
-
-	e->ed->txtbuf[idx] = 0;
-	xpos = font->calc_str_width(e->ed->font_id, e->ed->txtbuf);
-	e->ed->txtbuf[idx] = tmp;
-	return xpos;
+	return fenwick_prefix(e->ed->widths, buf_pos(e, idx));
 }
 
 
 /**
  * Calculate character index that corresponds to the specified position
+ *
+ * The position is rounded to the nearest character boundary.
  */
 static inline int get_char_index(ENTRY *e, int pos)
 {
-	if (e->ed->flags & ENTRY_FLAGS_BLIND) {
-		unsigned step = font->calc_str_width(e->ed->font_id, "*");
-		unsigned res = step ? pos/step : 0;
-		if (res > strlen(e->ed->txtbuf)) res = strlen(e->ed->txtbuf);
-		return res;
-	}
-	return font->calc_char_idx(e->ed->font_id, e->ed->txtbuf, pos);
+	s32 idx, len = text_len(e), w;
+
+	if (pos <= 0) return 0;
+
+	/*
+	 * Find character that covers the position. Because the bytes that
+	 * continue a character have no width, the found index is always
+	 * followed by the start of a character.
+	 */
+	idx = fenwick_find(e->ed->widths, e->ed->txtbuflen, pos);
+	idx = idx <= e->ed->gap_beg ? idx : MAX(idx - gap_len(e), e->ed->gap_beg);
+	if (idx >= len) return len;
+
+	w = char_width(e, buf_pos(e, idx));
+	return get_char_pos(e, idx) + (w>>1) >= pos ? idx : next_char(e, idx);
+}
+
+
+/**
+ * Redraw the text between two x positions
+ */
+static void redraw_span(ENTRY *e, s32 x1, s32 x2)
+{
+	s32 ox = e->ed->pad_x + 3 + e->ed->tx.curr;
+
+	/* include the cursor, which exceeds its position by two pixels */
+	redraw->draw_widgetarea(e, MAX(ox + x1 - 2, 0), 0,
+	                        MIN(ox + x2 + 2, e->wd->w - 1), e->wd->h - 1);
 }
 
 
@@ -182,7 +353,7 @@ static void update_text_pos(ENTRY *e)
 	if (!e || !e->ed || !e->ed->txtbuf) return;
 	
 	e->ed->ty = 0;
-	e->ed->tw = font->calc_str_width (e->ed->font_id, e->ed->txtbuf);
+	e->ed->tw = get_char_pos(e, text_len(e));
 	e->ed->th = font->calc_str_height(e->ed->font_id, e->ed->txtbuf);
 	e->ed->ch = e->ed->th;
 
@@ -220,12 +391,11 @@ static void update_text_pos(ENTRY *e)
 static void start_relax(ENTRY *e)
 {
 	relax->set_duration(&e->ed->tx, 15);
-	if (e->ed->tx.curr == e->ed->tx.dst || e->ed->tx.speed) return;
+	if (e->ed->tx.curr == e->ed->tx.dst || e->ed->tx_anim) return;
 
-	e->gen->inc_ref(e);
 	e->ed->tx.speed = 1;
 
-	if (!tick->add(25, tick_relax_tx, e))
+	if (!(e->ed->tx_anim = relax->animate(tick_relax_tx, e)))
 		e->ed->tx.curr = e->ed->tx.dst;
 }
 
@@ -303,13 +473,29 @@ static int entry_draw(ENTRY *e, struct gfx_ds *ds, long x, long y, WIDGET *origi
 		gfx->draw_box(ds, e->ed->sel_x + tx - 1, ty, e->ed->sel_w, e->ed->ch+1, GFX_RGBA(127,127,127,127));
 	
 	if (e->ed->txtbuf) {
+
+		/* skip characters left of the clipping area */
+		int i   = prev_char(e, get_char_index(e, gfx->get_clip_x(ds) - tx));
+		int len = text_len(e);
+
 		if (e->ed->flags & ENTRY_FLAGS_BLIND) {
 			int step = font->calc_str_width(e->ed->font_id, "*");
-			int i, len = strlen(e->ed->txtbuf);
-			for (i = 0; i < len; i++) {
-				gfx->draw_string(ds, tx + step*i, ty, tc, 0, e->ed->font_id, "*");
+			int x2   = gfx->get_clip_x(ds) + gfx->get_clip_w(ds);
+			int cx   = tx + get_char_pos(e, i);
+			for (; i < len && cx < x2; i = next_char(e, i), cx += step) {
+				gfx->draw_string(ds, cx, ty, tc, 0, e->ed->font_id, "*");
 			}
-		} else gfx->draw_string(ds, tx, ty, tc, 0, e->ed->font_id, e->ed->txtbuf);
+		} else {
+
+			/* text in front of the gap is null-terminated at the gap */
+			if (i < e->ed->gap_beg)
+				gfx->draw_string(ds, tx + get_char_pos(e, i), ty, tc, 0,
+				                 e->ed->font_id, e->ed->txtbuf + i);
+
+			i = MAX(i, e->ed->gap_beg);
+			gfx->draw_string(ds, tx + get_char_pos(e, i), ty, tc, 0,
+			                 e->ed->font_id, e->ed->txtbuf + buf_pos(e, i));
+		}
 	}
 
 	/* draw cursor */
@@ -383,11 +569,15 @@ static void entry_handle_event(ENTRY *e, EVENT *ev, WIDGET *from)
 {
 	int xpos = userstate->get_mx() - e->gen->get_abs_x(e);
 	int ascii;
-	int ev_done = 0;
+	int ev_done = 0, edited = 0;
+	s32 old_cx, old_tw, old_sel;
 
 	switch (ev->type) {
 	case EVENT_PRESS:
 	case EVENT_KEY_REPEAT:
+		old_cx  = e->ed->cx;
+		old_tw  = e->ed->tw;
+		old_sel = e->ed->sel_w;
 		e->ed->sel_beg = e->ed->sel_end = e->ed->sel_w = 0;
 		switch (ev->code) {
 		case Input::BTN_MOUSE:
@@ -399,12 +589,12 @@ static void entry_handle_event(ENTRY *e, EVENT *ev, WIDGET *from)
 			ev_done = 1;
 			break;
 		case Input::KEY_LEFT:
-			if (e->ed->curpos > 0) e->ed->curpos--;
+			if (e->ed->curpos > 0) e->ed->curpos = prev_char(e, e->ed->curpos);
 			ev_done = 2;
 			break;
 			
 		case Input::KEY_RIGHT:
-			if (e->ed->curpos < (int)strlen(e->ed->txtbuf)) e->ed->curpos++;
+			if (e->ed->curpos < text_len(e)) e->ed->curpos = next_char(e, e->ed->curpos);
 			ev_done = 2;
 			break;
 
@@ -414,20 +604,19 @@ static void entry_handle_event(ENTRY *e, EVENT *ev, WIDGET *from)
 			break;
 
 		case Input::KEY_END:
-			e->ed->curpos = strlen(e->ed->txtbuf);
+			e->ed->curpos = text_len(e);
 			ev_done = 2;
 			break;
 
 		case Input::KEY_DELETE:
-			if (e->ed->curpos < (int)strlen(e->ed->txtbuf))
-				delete_char(e, e->ed->curpos);
+			edited = delete_char(e, e->ed->curpos);
 			ev_done = 2;
 			break;
 
 		case Input::KEY_BACKSPACE:
 			if (e->ed->curpos > 0) {
-				e->ed->curpos--;
-				delete_char(e, e->ed->curpos);
+				e->ed->curpos = prev_char(e, e->ed->curpos);
+				edited = delete_char(e, e->ed->curpos);
 			}
 			ev_done = 2;
 			break;
@@ -436,7 +625,7 @@ static void entry_handle_event(ENTRY *e, EVENT *ev, WIDGET *from)
 
 			/* send commit event to client application */
 			{
-				char const *m = e->gen->get_bind_msg(e, "commit");
+				struct binding *m = e->gen->get_binding(e, "commit");
 				int app_id = e->gen->get_app_id(e);
 				if (m) msg->send_action_event(app_id, "commit", m);
 			}
@@ -448,20 +637,31 @@ static void entry_handle_event(ENTRY *e, EVENT *ev, WIDGET *from)
 			return;
 		}
 
-		if (ev_done) {
-			update_text_pos(e);
-			if (ev_done == 2) start_relax(e);
-			e->gen->force_redraw(e);
+		/* insert character, the keymap delivers Latin-1 characters */
+		if (!ev_done) {
+			int len;
+			ascii = (u8)userstate->get_ascii(ev->code);
+			if (!ascii || !(len = insert_char(e, e->ed->curpos, ascii))) return;
+			e->ed->curpos += len;
+			edited  = 1;
+			ev_done = 2;
+		}
+
+		update_text_pos(e);
+
+		/*
+		 * As long as the text does not scroll, only the span between the
+		 * old and new cursor position must be redrawn. An edit also moves
+		 * the text behind the cursor.
+		 */
+		if (ev_done == 2 && !old_sel && e->ed->tx.curr == e->ed->tx.dst) {
+			redraw_span(e, MIN(old_cx, e->ed->cx),
+			            edited ? MAX(old_tw, e->ed->tw) : MAX(old_cx, e->ed->cx));
 			return;
 		}
 
-		/* insert ASCII character */
-		ascii = userstate->get_ascii(ev->code);
-		if (!ascii) return;
-		insert_char(e, e->ed->curpos, ascii);
-		e->ed->curpos++;
-		e->wd->update |= WID_UPDATE_REFRESH;
-		e->gen->update(e);
+		if (ev_done == 2) start_relax(e);
+		e->gen->force_redraw(e);
 	}
 }
 
@@ -508,7 +708,9 @@ static void entry_update(ENTRY *e)
  */
 static void entry_free_data(ENTRY *e)
 {
+	relax->stop(e->ed->tx_anim);
 	if (e->ed->txtbuf) free(e->ed->txtbuf);
+	if (e->ed->widths) free(e->ed->widths);
 }
 
 
@@ -525,26 +727,51 @@ static char const *entry_get_type(ENTRY *e)
  ** Entry specific methods **
  ****************************/
 
+/**
+ * Set text of entry
+ *
+ * Bytes of the new text that are no valid UTF-8 are taken as Latin-1
+ * characters and converted to UTF-8.
+ */
 static void entry_set_text(ENTRY *e, char *new_txt)
 {
-	int i;
+	char const *s;
+	char seq[UTF8_MAX_LEN];
+	s32  len = 0;
 
 	if (!new_txt) return;
 
-	/* clear old text */
-	while (e->ed->txtbuf[0]) delete_char(e, 0);
+	/* determine length of the text in well-formed UTF-8 */
+	for (s = new_txt; *s; )
+		len += utf8_encode(utf8_decode(&s), seq);
+
+	/* drop old text and make room for the new one */
+	e->ed->gap_beg = 0;
+	e->ed->gap_end = e->ed->txtbuflen;
+	if (len + 1 > e->ed->txtbuflen && !resize_buffer(e, len*2 + 2)) len = 0;
+
+	for (s = new_txt; e->ed->gap_beg < len; )
+		e->ed->gap_beg += utf8_encode(utf8_decode(&s), e->ed->txtbuf + e->ed->gap_beg);
+	e->ed->txtbuf[len] = 0;
+	build_index(e);
 
-	/* insert new charaters */
-	for (i = 0; new_txt[i]; i++) insert_char(e, i, new_txt[i]);
+	if (e->ed->curpos > len) e->ed->curpos = len;
+	while (e->ed->curpos > 0 && utf8_is_cont(e->ed->txtbuf[e->ed->curpos])) e->ed->curpos--;
 
 	/* make the new text visible */
 	e->wd->update |= WID_UPDATE_REFRESH;
 }
 
 
+/**
+ * Return text of the entry
+ *
+ * The gap is moved to the end of the text to make the text contiguous.
+ */
 static char *entry_get_text(ENTRY *e)
 {
 	if (!e || !e->ed) return 0;
+	move_gap(e, text_len(e));
 	return e->ed->txtbuf;
 }
 
@@ -556,6 +783,8 @@ static void entry_set_blind(ENTRY *e, long blind_flag)
 	else
 		e->ed->flags &= ~ENTRY_FLAGS_BLIND;
 
+	/* the character widths depend on the blind mode */
+	build_index(e);
 	e->wd->update |= WID_UPDATE_REFRESH;
 }
 
@@ -588,7 +817,9 @@ static ENTRY *create(void)
 	entry->ed->sel_beg   = -1;
 	entry->ed->sel_end   = -1;
 	entry->ed->txtbuflen = 16;
-	entry->ed->txtbuf    = (char *)zalloc(entry->ed->txtbuflen);
+	entry->ed->txtbuf    = (char *)zalloc(entry->ed->txtbuflen + 1);
+	entry->ed->widths    = (s32  *)zalloc((entry->ed->txtbuflen + 1)*sizeof(s32));
+	entry->ed->gap_end   = entry->ed->txtbuflen;
 	entry->wd->flags    |= WID_FLAGS_EDITABLE | WID_FLAGS_HIGHLIGHT;
 
 	/* let the entry receive the keyboard focus even without any bindings */
@@ -632,8 +863,8 @@ int init_entry(struct dope_services *d)
 	script    = (script_services    *)(d->get_module("Script 1.0"));
 	userstate = (userstate_services *)(d->get_module("UserState 1.0"));
 	msg       = (messenger_services *)(d->get_module("Messenger 1.0"));
-	tick      = (tick_services      *)(d->get_module("Tick 1.0"));
 	relax     = (relax_services     *)(d->get_module("Relax 1.0"));
+	redraw    = (redraw_services    *)(d->get_module("RedrawManager 1.0"));
 
 	normal_img = gen_range_img(gfx, 85, 85, 85, 148, 148, 148);
 	focus_img  = gen_range_img(gfx, 85, 85, 85, 162, 162, 162);
@@ -0,0 +1,82 @@
+/*
+ * \brief   Fenwick tree of prefix sums
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * A Fenwick tree stores 'n' values in an array of 'n + 1' elements, of
+ * which the first one is unused. It allows for changing single values and
+ * for querying the sum of the values before a position in logarithmic
+ * time. The Table uses it for the offsets of its rows, the Entry for the
+ * pixel positions of its characters. All values must be non-negative for
+ * 'fenwick_find' to work.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _DOPE_FENWICK_H_
+#define _DOPE_FENWICK_H_
+
+
+/**
+ * Turn array of values into a Fenwick tree in linear time
+ *
+ * \param tree  array with the value of position 'i' stored at 'tree[i + 1]'
+ */
+template <typename T>
+static inline void fenwick_build(T *tree, long n)
+{
+	for (long i = 1; i <= n; i++) {
+		long j = i + (i & -i);
+		if (j <= n) tree[j] += tree[i];
+	}
+}
+
+
+/**
+ * Add 'delta' to the value at position 'pos'
+ */
+template <typename T>
+static inline void fenwick_add(T *tree, long n, long pos, long delta)
+{
+	for (long i = pos + 1; i <= n; i += i & -i)
+		tree[i] += delta;
+}
+
+
+/**
+ * Return sum of the values before position 'pos'
+ */
+template <typename T>
+static inline T fenwick_prefix(T const *tree, long pos)
+{
+	T sum = 0;
+	for (long i = pos; i > 0; i -= i & -i)
+		sum += tree[i];
+	return sum;
+}
+
+
+/**
+ * Return max number of leading values with a sum of at most 'limit'
+ */
+template <typename T>
+static inline long fenwick_find(T const *tree, long n, long limit)
+{
+	long pos = 0, step = 1;
+
+	while (2*step <= n) step *= 2;
+
+	for (; step; step /= 2)
+		if (pos + step <= n && tree[pos + step] <= limit) {
+			pos   += step;
+			limit -= tree[pos];
+		}
+	return pos;
+}
+
+#endif /* _DOPE_FENWICK_H_ */
@@ -25,6 +25,31 @@ struct fontconv_services {
 	u32         (*get_image_width)  (void *fontadr);
 	u32         (*get_image_height) (void *fontadr);
 	void        (*gen_image)        (void *fontadr, u8 *dst_img);
+
+	/**
+	 * Return font image located within the font data
+	 *
+	 * \return  NULL if the image must be generated via 'gen_image'
+	 */
+	u8         *(*get_image)        (void *fontadr);
+
+	/**
+	 * Check if font data of the specified size holds a complete font
+	 *
+	 * The font data is not modified, so it may be mapped read-only.
+	 */
+	s16         (*check)            (void *fontadr, unsigned long size);
+
+	/**
+	 * Generate width and offset table of the glyphs of a code point page
+	 *
+	 * Page 0 corresponds to the tables generated by 'gen_width_table'
+	 * and 'gen_offset_table'.
+	 *
+	 * \param page  code point divided by 256
+	 * \return      0 if the font has no glyphs within the page
+	 */
+	s16         (*gen_glyph_page)   (void *fontadr, u32 page, s32 *dst_wtab, s32 *dst_otab);
 };
 
 
@@ -15,9 +15,14 @@
  * the terms of the GNU General Public Licence 2.
  */
 
+#include <base/env.h>
+#include <os/attached_rom_dataspace.h>
+
+/* local includes */
 #include "dopestd.h"
 #include "fontman.h"
 #include "fontconv.h"
+#include "utf8.h"
 
 static struct fontconv_services *conv_fnt;
 static struct fontconv_services *conv_tff;
@@ -33,17 +38,255 @@ extern unsigned char vera16_tff[];
 
 int init_fontman(struct dope_services *d);
 
+/*
+ * Fonts are registered with their header information only. The glyph
+ * tables and the font image are set up when the font is used for the
+ * first time.
+ */
+struct font_entry {
+	struct font               font;    /* must be the first member      */
+	void                     *data;    /* font data, embedded or mapped */
+	struct fontconv_services *conv;    /* converter of font format      */
+	int                       ready;   /* tables and image are set up   */
+	u8                       *gen_img; /* generated image or NULL       */
+	struct glyph_page        *fallback;/* page of replacement glyphs    */
+};
+
+static struct font_entry **fonts;     /* registered fonts, indexed by id */
+static s32                 num_fonts;
+static s32                 max_fonts;
+
+enum {
+	MIN_FONTS        = 8,     /* initial capacity of font registry     */
+	LAYOUT_BUCKETS   = 256,   /* number of hash chains of layout cache */
+	MAX_IDLE_LAYOUTS = 64,    /* unused layouts kept in the cache      */
+};
+
+struct cached_layout {
+	struct text_layout    layout;      /* must be the first member    */
+	u32                   hash;
+	s32                   ref_cnt;
+	struct cached_layout *next;        /* hash chain                  */
+	struct cached_layout *idle_prev;   /* list of unused layouts,     */
+	struct cached_layout *idle_next;   /* oldest first                */
+};
+
+static struct cached_layout *buckets[LAYOUT_BUCKETS];
+static struct cached_layout *idle_first, *idle_last;
+static int                   num_idle;
+
 
 /********************************
  ** Functions for internal use **
  ********************************/
 
 /**
- * Determine whether a font id is valid or not
+ * Calculate hash of string and font, and determine string length
  */
-static inline int valid_font_id(int font_id)
+static u32 layout_hash(s32 font_id, char const *str, s32 *len)
 {
-	return (font_id >= 0 && font_id <= 2);
+	u32 hash = 2166136261u ^ font_id;
+	s32 i;
+
+	for (i = 0; str[i]; i++)
+		hash = (hash ^ (u8)str[i])*16777619u;
+
+	*len = i;
+	return hash;
+}
+
+
+static void idle_unlink(struct cached_layout *cl)
+{
+	if (cl->idle_prev) cl->idle_prev->idle_next = cl->idle_next;
+	else               idle_first               = cl->idle_next;
+	if (cl->idle_next) cl->idle_next->idle_prev = cl->idle_prev;
+	else               idle_last                = cl->idle_prev;
+	cl->idle_prev = cl->idle_next = NULL;
+	num_idle--;
+}
+
+
+/**
+ * Remove layout from the cache and free it
+ */
+static void free_layout(struct cached_layout *cl)
+{
+	struct cached_layout **chain = &buckets[cl->hash % LAYOUT_BUCKETS];
+
+	for (; *chain; chain = &(*chain)->next)
+		if (*chain == cl) {
+			*chain = cl->next;
+			break;
+		}
+	free(cl);
+}
+
+
+/**
+ * Add font to the font registry
+ *
+ * Only the header of the font data is evaluated.
+ *
+ * \return  font id or -1 on failure
+ */
+static s32 register_font(struct fontconv_services *conv, void *data, char const *name)
+{
+	struct font_entry *fe;
+	char *name_buf;
+
+	/* enlarge registry */
+	if (num_fonts == max_fonts) {
+		s32 max = max_fonts ? 2*max_fonts : MIN_FONTS;
+		struct font_entry **new_fonts = (struct font_entry **)malloc(max*sizeof(*fonts));
+		if (!new_fonts) return -1;
+		if (fonts) {
+			memcpy(new_fonts, fonts, num_fonts*sizeof(*fonts));
+			free(fonts);
+		}
+		fonts     = new_fonts;
+		max_fonts = max;
+	}
+
+	fe = (struct font_entry *)zalloc(sizeof(struct font_entry) + strlen(name) + 1);
+	if (!fe) return -1;
+
+	name_buf = (char *)((adr)fe + sizeof(struct font_entry));
+	memcpy(name_buf, name, strlen(name) + 1);
+
+	fe->font.font_id = num_fonts;
+	fe->font.img_w   = conv->get_image_width(data);
+	fe->font.img_h   = conv->get_image_height(data);
+	fe->font.top     = conv->get_top(data);
+	fe->font.bottom  = conv->get_bottom(data);
+	fe->font.name    = name_buf;
+	fe->data         = data;
+	fe->conv         = conv;
+
+	fonts[num_fonts] = fe;
+	return num_fonts++;
+}
+
+
+/**
+ * Drop glyphs that exceed the font image
+ */
+static void drop_invalid_glyphs(struct font *f, s32 *wtab, s32 *otab)
+{
+	for (int i = 0; i < 256; i++)
+		if (wtab[i] < 0 || otab[i] < 0 || otab[i] > f->img_w
+		 || wtab[i] > f->img_w - otab[i])
+			wtab[i] = otab[i] = 0;
+}
+
+
+/**
+ * Set up glyph tables and image of a font
+ *
+ * If the font converter can provide the font image in place, the image
+ * is used directly from the font data. Glyphs that exceed the font image
+ * are dropped.
+ *
+ * \return  1 on success
+ */
+static int prepare_font(struct font_entry *fe)
+{
+	struct font *f = &fe->font;
+	s32 *wtab = (s32 *)zalloc(256*sizeof(s32));
+	s32 *otab = (s32 *)zalloc(256*sizeof(s32));
+	u8  *img  = fe->conv->get_image(fe->data);
+
+	if (!img && (fe->gen_img = (u8 *)zalloc(f->img_w*f->img_h))) {
+		fe->conv->gen_image(fe->data, fe->gen_img);
+		img = fe->gen_img;
+	}
+
+	if (!wtab || !otab || !img) {
+		ERROR(printf("FontManager(prepare_font): out of memory\n");)
+		free(wtab);
+		free(otab);
+		free(fe->gen_img);
+		fe->gen_img = NULL;
+		return 0;
+	}
+
+	fe->conv->gen_width_table(fe->data, wtab);
+	fe->conv->gen_offset_table(fe->data, otab);
+
+	drop_invalid_glyphs(f, wtab, otab);
+
+	f->width_table  = wtab;
+	f->offset_table = otab;
+	f->image        = img;
+	fe->ready       = 1;
+	return 1;
+}
+
+
+/**
+ * Return font with its glyph tables and image set up
+ *
+ * If a font cannot be set up, the default font is used instead.
+ */
+static struct font *font_of(s32 font_id)
+{
+	struct font_entry *fe;
+
+	if (font_id < 0 || font_id >= num_fonts) return NULL;
+	fe = fonts[font_id];
+
+	if (!fe->ready && !prepare_font(fe))
+		return font_id ? font_of(0) : NULL;
+
+	return &fe->font;
+}
+
+
+/**
+ * Map font file from ROM module
+ *
+ * The mapping of a registered font is never released because the font
+ * may be used until the end of the program.
+ *
+ * \return  attached ROM module or NULL
+ */
+static Genode::Attached_rom_dataspace *map_font_file(char const *name)
+{
+	using namespace Genode;
+
+	try {
+		return new (env()->heap()) Attached_rom_dataspace(name);
+	} catch (...) {
+		return NULL;
+	}
+}
+
+
+/**
+ * Release ROM module that does not hold a usable font
+ */
+static void unmap_font_file(Genode::Attached_rom_dataspace *rom)
+{
+	Genode::destroy(Genode::env()->heap(), rom);
+}
+
+
+/**
+ * Return page of replacement glyphs
+ *
+ * The replacement glyph is the question mark of the font.
+ */
+static struct glyph_page *fallback_page(struct font_entry *fe)
+{
+	static struct glyph_page empty_page;
+
+	if (!fe->fallback && (fe->fallback = (struct glyph_page *)malloc(sizeof(struct glyph_page))))
+		for (int i = 0; i < 256; i++) {
+			fe->fallback->width[i]  = fe->font.width_table['?'];
+			fe->fallback->offset[i] = fe->font.offset_table['?'];
+		}
+
+	return fe->fallback ? fe->fallback : &empty_page;
 }
 
 
@@ -51,23 +294,61 @@ static inline int valid_font_id(int font_id)
  ** Service functions **
  ***********************/
 
-static struct font fonts[3];
+/**
+ * Return glyph page of a font
+ *
+ * Glyph pages are requested from the font converter when they are used
+ * for the first time. Pages without glyphs share the fallback page of
+ * the font.
+ */
+static struct glyph_page *fontman_get_glyph_page(struct font *f, u32 page)
+{
+	struct font_entry *fe = (struct font_entry *)f;
+	struct glyph_page *p;
+
+	if (page >= NUM_GLYPH_PAGES) return fallback_page(fe);
+
+	if (!f->pages && !(f->pages = (struct glyph_page **)zalloc(NUM_GLYPH_PAGES*sizeof(*f->pages))))
+		return fallback_page(fe);
+
+	if (f->pages[page]) return f->pages[page];
+
+	p = (struct glyph_page *)malloc(sizeof(struct glyph_page));
+	if (p && fe->conv->gen_glyph_page(fe->data, page, p->width, p->offset)) {
+		drop_invalid_glyphs(f, p->width, p->offset);
+		return f->pages[page] = p;
+	}
+
+	free(p);
+	return f->pages[page] = fallback_page(fe);
+}
+
+
+static inline s32 glyph_width(struct font *f, u32 c)
+{
+	return c < 256 ? f->width_table[c] : fontman_get_glyph_page(f, c >> 8)->width[c & 0xff];
+}
+
 
 static struct font *fontman_get_by_id(s32 font_id)
 {
-	if (!valid_font_id(font_id)) return NULL;
-	return (struct font *)(&fonts[font_id]);
+	return font_of(font_id);
 }
 
 
 static s32 fontman_calc_str_width(s32 font_id, char const *str)
 {
+	struct font *f = font_of(font_id);
 	s32 result = 0;
-	if (!str) return 0;
-	if (!valid_font_id(font_id)) return 0;
-	while (*str) {
-		result+=fonts[font_id].width_table[(s32)(*str)];
-		str++;
+	if (!str || !f) return 0;
+	for (s32 *wtab = f->width_table; *str; ) {
+		u8 c;
+
+		/* fast path for runs of ASCII characters */
+		for (; (c = *str) && c < 0x80; str++)
+			result += wtab[c];
+
+		if (c) result += glyph_width(f, utf8_decode(&str));
 	}
 	return result;
 }
@@ -75,17 +356,21 @@ static s32 fontman_calc_str_width(s32 font_id, char const *str)
 
 /**
  * Calculate character index of specified pixel position
+ *
+ * The returned byte index refers to the start of a character.
  */
 static s32 fontman_calc_char_idx(s32 font_id, char const *str, s32 pixpos)
 {
+	struct font *f = font_of(font_id);
 	s32 idx = 0, pos = 0, charw;
-	if (!str) return 0;
-	if (!valid_font_id(font_id)) return 0;
+	if (!str || !f) return 0;
 	while (*str) {
-		charw = fonts[font_id].width_table[(s32)(*str)];
+		char const *next = str;
+		charw = glyph_width(f, utf8_decode(&next));
 		if (pos >= pixpos - (charw>>1)) return idx;
 		pos += charw;
-		str++; idx++;
+		idx += next - str;
+		str  = next;
 	}
 	return idx;
 }
@@ -94,8 +379,147 @@ static s32 fontman_calc_char_idx(s32 font_id, char const *str, s32 pixpos)
 static s32 fontman_calc_str_height(s32 font_id, char const *str)
 {
 	if (!str) return 0;
-	if (!valid_font_id(font_id)) return 0;
-	return fonts[font_id].img_h;
+	if (font_id < 0 || font_id >= num_fonts) return 0;
+	return fonts[font_id]->font.img_h;
+}
+
+
+/**
+ * Look up font by name
+ *
+ * Fonts that are not registered yet are loaded from the ROM module of the
+ * same name, which must contain a font in TFF format. The font data is
+ * used directly from the mapped ROM module.
+ */
+static s32 fontman_lookup(char const *name)
+{
+	Genode::Attached_rom_dataspace *rom;
+	void *data;
+	s32 font_id;
+
+	if (!name) return -1;
+
+	for (s32 i = 0; i < num_fonts; i++)
+		if (streq(fonts[i]->font.name, name, 256)) return i;
+
+	if (!(rom = map_font_file(name))) {
+		ERROR(printf("FontManager(lookup): could not open font %s\n", name);)
+		return -1;
+	}
+
+	data = rom->local_addr<void>();
+	if (!conv_tff->check(data, rom->size())) {
+		ERROR(printf("FontManager(lookup): %s is no valid TFF font\n", name);)
+		unmap_font_file(rom);
+		return -1;
+	}
+
+	if ((font_id = register_font(conv_tff, data, name)) < 0)
+		unmap_font_file(rom);
+
+	return font_id;
+}
+
+
+static struct text_layout *fontman_get_layout(s32 font_id, char const *str)
+{
+	struct cached_layout *cl;
+	struct font *f;
+	s32 len, i;
+	u32 hash;
+	char *dst;
+
+	if (!str || !(f = font_of(font_id))) return NULL;
+	hash = layout_hash(font_id, str, &len);
+
+	/* look up cached layout */
+	for (cl = buckets[hash % LAYOUT_BUCKETS]; cl; cl = cl->next) {
+		if (cl->hash != hash || cl->layout.font_id != font_id
+		 || cl->layout.len != len || !streq(cl->layout.str, str, len + 1)) continue;
+
+		if (!cl->ref_cnt) idle_unlink(cl);
+		cl->ref_cnt++;
+		return &cl->layout;
+	}
+
+	/* create new layout, the offsets and the string follow the structure */
+	cl = (struct cached_layout *)zalloc(sizeof(struct cached_layout)
+	                                   + (len + 1)*sizeof(s32) + len + 1);
+	if (!cl) {
+		ERROR(printf("FontManager(get_layout): out of memory\n");)
+		return NULL;
+	}
+
+	cl->layout.offsets = (s32 *)((adr)cl + sizeof(struct cached_layout));
+	dst = (char *)&cl->layout.offsets[len + 1];
+	cl->layout.font_id = font_id;
+	cl->layout.len     = len;
+	cl->layout.height  = f->img_h;
+	cl->layout.str     = dst;
+
+	/*
+	 * The width of a character is assigned to its first byte, the other
+	 * bytes of the character have a width of zero.
+	 */
+	for (i = 0; i < len; ) {
+		char const *next = str + i;
+		s32 x = cl->layout.offsets[i] + glyph_width(f, utf8_decode(&next));
+		for (; str + i < next; i++)
+			cl->layout.offsets[i + 1] = x;
+	}
+	memcpy(dst, str, len + 1);
+	cl->layout.width = cl->layout.offsets[len];
+
+	cl->hash    = hash;
+	cl->ref_cnt = 1;
+	cl->next    = buckets[hash % LAYOUT_BUCKETS];
+	buckets[hash % LAYOUT_BUCKETS] = cl;
+	return &cl->layout;
+}
+
+
+/**
+ * Release layout
+ *
+ * Unused layouts stay in the cache for reuse. If there are too many of
+ * them, the oldest unused layout is freed.
+ */
+static void fontman_release_layout(struct text_layout *layout)
+{
+	struct cached_layout *cl = (struct cached_layout *)layout;
+
+	if (!cl || --cl->ref_cnt > 0) return;
+
+	cl->idle_prev = idle_last;
+	cl->idle_next = NULL;
+	if (idle_last) idle_last->idle_next = cl;
+	else           idle_first           = cl;
+	idle_last = cl;
+
+	if (++num_idle > MAX_IDLE_LAYOUTS) {
+		struct cached_layout *oldest = idle_first;
+		idle_unlink(oldest);
+		free_layout(oldest);
+	}
+}
+
+
+static s32 fontman_layout_char_at(struct text_layout *layout, s32 pixpos)
+{
+	s32 lo = 0, hi;
+
+	if (!layout) return 0;
+
+	/* find last character that starts at or left of the position */
+	for (hi = layout->len; lo < hi; ) {
+		s32 mid = (lo + hi + 1)/2;
+		if (layout->offsets[mid] <= pixpos) lo = mid;
+		else                               hi = mid - 1;
+	}
+
+	/* step back to the start of the character */
+	while (lo > 0 && utf8_is_cont(layout->str[lo])) lo--;
+	return lo;
 }
 
 
@@ -108,6 +532,11 @@ static struct fontman_services services = {
 	fontman_calc_str_width,
 	fontman_calc_str_height,
 	fontman_calc_char_idx,
+	fontman_get_layout,
+	fontman_release_layout,
+	fontman_layout_char_at,
+	fontman_lookup,
+	fontman_get_glyph_page,
 };
 
 
@@ -115,40 +544,17 @@ static struct fontman_services services = {
  ** Module entry point **
  ************************/
 
-static void add_font(struct fontconv_services *conv, void *fontdata,
-                     u32 font_id, struct font *dst)
-{
-	dst->font_id = font_id;
-	dst->img_w   = conv->get_image_width(fontdata);
-	dst->img_h   = conv->get_image_height(fontdata);
-	dst->top     = conv->get_top(fontdata);
-	dst->bottom  = conv->get_bottom(fontdata);
-	dst->name    = conv->get_name(fontdata);
-
-	dst->width_table  = (s32 *)zalloc(256*4);
-	dst->offset_table = (s32 *)zalloc(256*4);
-	dst->image = (u8 *)zalloc(dst->img_w*dst->img_h);
-	if (!dst->width_table || !dst->offset_table || !dst->image) {
-		INFO(printf("FontManager(add_font): out of memory, smoke a cigarette\n"));
-		return;
-	}
-	conv->gen_width_table(fontdata, dst->width_table);
-	conv->gen_offset_table(fontdata, dst->offset_table);
-	conv->gen_image(fontdata, dst->image);
-}
-
-
 int init_fontman(struct dope_services *d)
 {
 	conv_fnt = (fontconv_services *)(d->get_module("ConvertFNT 1.0"));
 	conv_tff = (fontconv_services *)(d->get_module("ConvertTFF 1.0"));
 
-	/* init the three built-in fonts */
-	if (conv_tff->probe(&vera16_tff)) add_font(conv_tff,&vera16_tff[0],0,&fonts[0]);
-//	if (conv_fnt->probe(&default_fnt)) add_font(conv_fnt,&default_fnt[0],0,&fonts[0]);
+	/* register the three built-in fonts with the ids 0, 1, and 2 */
+	if (conv_tff->probe(&vera16_tff)) register_font(conv_tff, &vera16_tff[0], "default");
+//	if (conv_fnt->probe(&default_fnt)) register_font(conv_fnt, &default_fnt[0], "default");
 
-	if (conv_fnt->probe(&mono_fnt))    add_font(conv_fnt,&mono_fnt[0],   1,&fonts[1]);
-	if (conv_fnt->probe(&title_fnt))   add_font(conv_fnt,&title_fnt[0],  2,&fonts[2]);
+	if (conv_fnt->probe(&mono_fnt))    register_font(conv_fnt, &mono_fnt[0],   "monospaced");
+	if (conv_fnt->probe(&title_fnt))   register_font(conv_fnt, &title_fnt[0],  "title");
 
 	d->register_module("FontManager 1.0",&services);
 	return 1;
@@ -15,14 +15,47 @@
 #ifndef _DOPE_FONTMAN_H_
 #define _DOPE_FONTMAN_H_
 
+/**
+ * Glyphs of 256 consecutive code points
+ */
+struct glyph_page {
+	s32 width[256];
+	s32 offset[256];    /* horizontal offset of glyph in font image */
+};
+
+enum { NUM_GLYPH_PAGES = 0x110000 >> 8 };
+
 struct font {
 	s32         font_id;
-	s32        *width_table;
+	s32        *width_table;     /* glyphs of the code points 0 to 255 */
 	s32        *offset_table;
 	s32         img_w,img_h;
 	s16         top,bottom;
 	u8         *image;
 	char const *name;
+
+	/*
+	 * Directory of the glyph pages of all other code points, the pages
+	 * are loaded on demand
+	 */
+	struct glyph_page **pages;
+};
+
+
+/**
+ * Pixel layout of a string
+ *
+ * Layouts are shared by all users of the same string and font. They are
+ * immutable and must be released by each user that obtained them.
+ */
+struct text_layout {
+	s32         font_id;
+	s32         len;        /* length of the string in bytes        */
+	s32         width;      /* pixel width of the string            */
+	s32         height;     /* pixel height of the string           */
+	s32        *offsets;    /* x offset of each byte, the last of
+	                           the 'len + 1' offsets is 'width'     */
+	char const *str;        /* copy of the string                   */
 };
 
 
@@ -31,7 +64,72 @@ struct fontman_services {
 	s32          (*calc_str_width)  (s32 font_id, char const *str);
 	s32          (*calc_str_height) (s32 font_id, char const *str);
 	s32          (*calc_char_idx)   (s32 font_id, char const *str, s32 pixpos);
+
+	/**
+	 * Obtain layout of a string from the layout cache
+	 *
+	 * \return  layout or NULL if the font is invalid or out of memory
+	 */
+	struct text_layout *(*get_layout) (s32 font_id, char const *str);
+
+	/**
+	 * Release layout obtained via 'get_layout'
+	 */
+	void (*release_layout) (struct text_layout *);
+
+	/**
+	 * Return index of the character at the specified pixel position
+	 *
+	 * The returned byte index always refers to the start of a character.
+	 * For positions left of the string, 0 is returned. For positions
+	 * right of the string, the length of the string is returned.
+	 */
+	s32 (*layout_char_at) (struct text_layout *, s32 pixpos);
+
+	/**
+	 * Look up font by name
+	 *
+	 * The built-in fonts are named "default", "monospaced", and "title".
+	 * Other fonts are loaded at runtime from the ROM module of the
+	 * specified name.
+	 *
+	 * \return  font id or -1 if the font is not available
+	 */
+	s32 (*lookup) (char const *name);
+
+	/**
+	 * Return glyph page of a font
+	 *
+	 * Code points without a glyph are displayed using the replacement
+	 * glyph of the font.
+	 *
+	 * \param page  code point divided by 256
+	 */
+	struct glyph_page *(*get_glyph_page) (struct font *, u32 page);
 };
 
 
+/**
+ * Look up glyph of a code point
+ *
+ * \param offset  offset of glyph in font image
+ * \return        width of glyph
+ */
+static inline s32 font_glyph(struct fontman_services *fm, struct font *f,
+                             u32 c, s32 *offset)
+{
+	struct glyph_page *p;
+
+	if (c < 256) {
+		*offset = f->offset_table[c];
+		return f->width_table[c];
+	}
+
+	p = f->pages && f->pages[c >> 8] ? f->pages[c >> 8]
+	                                  : fm->get_glyph_page(f, c >> 8);
+	*offset = p->offset[c & 0xff];
+	return p->width[c & 0xff];
+}
+
+
 #endif /* _DOPE_FONTMAN_H_ */
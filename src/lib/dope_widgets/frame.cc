@@ -25,8 +25,8 @@ struct frame;
 #include "gfx.h"
 #include "widman.h"
 #include "messenger.h"
-#include "tick.h"
 #include "relax.h"
+#include "watch.h"
 
 static struct gfx_services        *gfx;
 static struct script_services     *script;
@@ -34,8 +34,8 @@ static struct widman_services     *widman;
 static struct scrollbar_services  *scroll;
 static struct messenger_services  *msg;
 static struct background_services *bg;
-static struct tick_services       *tick;
 static struct relax_services      *relax;
+static struct watch_services      *watch;
 
 enum {
 	FRAME_MODE_SCRX = 0x04,   /* horizontal scrollbars               */
@@ -46,13 +46,14 @@ enum {
 };
 
 struct frame_data {
-	WIDGET     *content;   /* content of the frame       */
-	u32         mode;      /* frame properties           */
-	RELAX       scroll_x;  /* adaptive scroll x-position */
-	RELAX       scroll_y;  /* adaptive scroll y-position */
-	SCROLLBAR  *sb_x;      /* horizontal scrollbar       */
-	SCROLLBAR  *sb_y;      /* vertical scrollbar         */
-	BACKGROUND *corner;    /* corner between scrollbars  */
+	WIDGET            *content;      /* content of the frame       */
+	u32                mode;         /* frame properties           */
+	RELAX              scroll_x;     /* adaptive scroll x-position */
+	RELAX              scroll_y;     /* adaptive scroll y-position */
+	struct relax_anim *scroll_anim;  /* running scroll animation   */
+	SCROLLBAR         *sb_x;         /* horizontal scrollbar       */
+	SCROLLBAR         *sb_y;         /* vertical scrollbar         */
+	BACKGROUND        *corner;       /* corner between scrollbars  */
 };
 
 int init_frame(struct dope_services *d);
@@ -240,7 +241,7 @@ static void frame_updatepos(FRAME *f)
 
 	/* send resize event */
 	{
-		char const *m = f->gen->get_bind_msg(f,"resize");
+		struct binding *m = f->gen->get_binding(f,"resize");
 		s32 id = f->gen->get_app_id(f);
 		if (m) msg->send_action_event(id,"resized", m);
 	}
@@ -253,6 +254,7 @@ static void frame_updatepos(FRAME *f)
 static void frame_free_data(FRAME *f)
 {
 	if (!f) return;
+	relax->stop(f->fd->scroll_anim);
 	if (f->fd->content) f->gen->release((WIDGET *)f->fd->content);
 	if (f->fd->sb_x)    f->gen->release((WIDGET *)f->fd->sb_x);
 	if (f->fd->sb_y)    f->gen->release((WIDGET *)f->fd->sb_y);
@@ -529,11 +531,12 @@ static int tick_relax_scroll(void *arg)
 	keep_ticking |= relax->do_relax(&f->fd->scroll_y);
 
 	if (!keep_ticking) {
-		f->gen->dec_ref(f);
+		f->fd->scroll_anim = NULL;
 		return 0;   /* stop ticking */
 	}
 	f->gen->updatepos(f);
 	f->gen->force_redraw(f);
+	watch->touch();
 	return 1;   /* keep ticking */
 }
 
@@ -560,15 +563,14 @@ static void frame_expose(FRAME *f, s32 x, s32 y)
 	f->fd->scroll_y.dst = y;
 
 	/* do not initiate a new tick when another is already active */
-	if (f->fd->scroll_x.speed || f->fd->scroll_y.speed) return;
+	if (f->fd->scroll_anim) return;
 
-	f->gen->inc_ref(f);
 	relax->set_duration(&f->fd->scroll_x, 15);
 	relax->set_duration(&f->fd->scroll_y, 15);
 	f->fd->scroll_x.speed++;
 	f->fd->scroll_y.speed++;
 
-	if (!tick->add(25, tick_relax_scroll, f)) {
+	if (!(f->fd->scroll_anim = relax->animate(tick_relax_scroll, f))) {
 		f->fd->scroll_x.curr = f->fd->scroll_x.dst;
 		f->fd->scroll_y.curr = f->fd->scroll_y.dst;
 	}
@@ -630,8 +632,8 @@ int init_frame(struct dope_services *d)
 	gfx     = (gfx_services        *)(d->get_module("Gfx 1.0"));
 	script  = (script_services     *)(d->get_module("Script 1.0"));
 	msg     = (messenger_services  *)(d->get_module("Messenger 1.0"));
-	tick    = (tick_services       *)(d->get_module("Tick 1.0"));
 	relax   = (relax_services      *)(d->get_module("Relax 1.0"));
+	watch   = (watch_services      *)(d->get_module("Watch 1.0"));
 
 	/* define general widget functions */
 	widman->default_widget_methods(&gen_methods);
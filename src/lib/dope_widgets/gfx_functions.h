@@ -112,7 +112,8 @@ static inline int clip_img(int clip_x1, int clip_y1, int clip_x2, int clip_y2,
  *
  * Image and screen have the same pixel format.
  */
-static inline void paint_img(int x, int y, int img_w, int img_h, pixel_t *src)
+static inline void paint_img(int x, int y, int img_w, int img_h,
+                             int linewidth, pixel_t *src)
 {
 	int      i, j;
 	int      w = img_w, h = img_h;
@@ -123,7 +124,7 @@ static inline void paint_img(int x, int y, int img_w, int img_h, pixel_t *src)
 	              &x, &y, &w, &h, &sx, &sy, 1, 1)) return;
 
 	/* calculate start address */
-	src += img_w*sy + sx;
+	src += linewidth*sy + sx;
 	dst  = scr_adr + y*scr_width + x;
 
 	/* paint... */
@@ -131,7 +132,7 @@ static inline void paint_img(int x, int y, int img_w, int img_h, pixel_t *src)
 
 		/* copy line from image to screen */
 		for (i = w, s = src, d = dst; i--; *(d++) = *(s++));
-		src += img_w;
+		src += linewidth;
 		dst += scr_width;
 	}
 }
@@ -157,7 +158,7 @@ static void paint_scaled_img(int x, int y, int w, int h,
 
 	/* use shortcut for non-scaled images */
 	if ((w == sw) && (h == sh)) {
-		paint_img(x, y, sw, sh, src);
+		paint_img(x, y, sw, sh, linewidth, src);
 		return;
 	}
 
@@ -398,26 +399,36 @@ static inline void draw_glyph_line(u8 *src_alpha, u16 color, u16 *dst, int len)
 }
 
 
+/**
+ * Draw UTF-8 encoded string
+ *
+ * Each glyph is clipped individually. Glyphs left of the clipping area
+ * are skipped and drawing stops at the right border of the clipping area.
+ */
 static void scr_draw_string(struct gfx_ds_data *ds, int x, int y,
                             color_t fg_rgba, color_t bg_rgba, int fnt_id,
-                            char const *str_signed)
+                            char const *str)
 {
 	struct font *font = fontman->get_by_id(fnt_id);
-	s32         *wtab = font->width_table;
-	s32         *otab = font->offset_table;
-	s32         img_w = font->img_w;
-	s32         img_h = font->img_h;
+	s32         *wtab, *otab;
+	s32          img_w, img_h;
 	pixel_t     *dst = scr_adr + y*scr_width + x;
-	u8          *str = (u8 *)str_signed;
-	u8          *src = font->image;
+	u8          *src;
 	u8          *s;
 	pixel_t     *d;
 	int          j;
-	int          w;
-	int          h = font->img_h;
+	int          w, l, r;
+	int          h;
 	pixel_t      color = rgba_to_pixel(fg_rgba);
 
-	if (!str) return;
+	if (!str || !font) return;
+
+	wtab  = font->width_table;
+	otab  = font->offset_table;
+	img_w = font->img_w;
+	img_h = font->img_h;
+	src   = font->image;
+	h     = font->img_h;
 
 	/* check top clipping */
 	if (y < clip_y1) {
@@ -432,61 +443,33 @@ static void scr_draw_string(struct gfx_ds_data *ds, int x, int y,
 
 	if (h < 1) return;
 
-	/* skip characters that are completely hidden by the left clipping border */
-	while (*str && (x+wtab[(int)(*str)] < clip_x1)) {
-		x+=wtab[(int)(*str)];
-		dst+=wtab[(int)(*str)];
-		str++;
-	}
-
-	/* draw left cutted character */
-	if (*str && (x+wtab[(int)(*str)] - 1 <= clip_x2) && (x < clip_x1)) {
-		w = wtab[(int)(*str)] - (clip_x1 - x);
-		s = src + otab[(int)(*str)] + (clip_x1 - x);
-		d = dst + (clip_x1 - x);
-		for (j = 0; j < h; j++) {
-			draw_glyph_line(s, color, d, w);
-			s = s + img_w;
-			d = d + scr_width;
-		}
-		dst += wtab[(int)(*str)];
-		x   += wtab[(int)(*str)];
-		str++;
-	}
-
-	/* draw horizontally full visible characters */
-	while (*str && (x + wtab[(int)(*str)] - 1 < clip_x2)) {
-		w = wtab[(int)(*str)];
-		s = src + otab[(int)(*str)];
-		d = dst;
-		for (j = 0; j < h; j++) {
-			draw_glyph_line(s, color, d, w);
-			s = s + img_w;
-			d = d + scr_width;
-		}
-		dst += wtab[(int)(*str)];
-		x   += wtab[(int)(*str)];
-		str++;
-	}
-
-	/* draw right cutted character */
-	if (*str) {
-		w = wtab[(int)(*str)];
-		s = src + otab[(int)(*str)];
-		d = dst;
-		if (x + w - 1 > clip_x2) {
-			w -= x + w - 1 - clip_x2;
-		}
-		if (x < clip_x1) {    /* check if character is also left-cutted */
-			w -= clip_x1 - x;
-			s += clip_x1 - x;
-			d += clip_x1 - x;
-		}
-		for (j = 0; j < h; j++) {
-			draw_glyph_line(s, color, d, w);
-			s += img_w;
-			d += scr_width;
+	while (*str && x <= clip_x2) {
+		u32 c = (u8)*str;
+		s32 offset;
+
+		/* fast path for ASCII characters */
+		if (c < 0x80) {
+			w      = wtab[c];
+			offset = otab[c];
+			str++;
+		} else
+			w = font_glyph(fontman, font, utf8_decode(&str), &offset);
+
+		/* determine visible columns of glyph */
+		l = x < clip_x1 ? clip_x1 - x : 0;
+		r = x + w - 1 > clip_x2 ? clip_x2 - x + 1 : w;
+
+		if (l < r) {
+			s = src + offset + l;
+			d = dst + l;
+			for (j = 0; j < h; j++) {
+				draw_glyph_line(s, color, d, r - l);
+				s += img_w;
+				d += scr_width;
+			}
 		}
+		dst += w;
+		x   += w;
 	}
 }
 
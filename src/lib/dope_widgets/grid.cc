@@ -8,6 +8,17 @@
  * column  sizes  can  be  specified  absolutely or
  * weighted.   Each  widget  can  be   individually
  * positioned using padding, spanning and alignment
+ *
+ * Rows and columns  are kept in arrays  sorted by
+ * their index. Since the section offsets  are in
+ * ascending order,  the sections at a given pixel
+ * position are found by binary search.
+ *
+ * When  the min/max size  of a child changes,  only
+ * the constraints of its row and column are recal-
+ * culated.  As  long as  the  min/max size  of the
+ * grid stays  the same,  only  the  widgets  whose
+ * cells changed are repositioned and redrawn.
  */
 
 /*
@@ -34,6 +45,7 @@ struct grid;
 #include "script.h"
 #include "grid.h"
 #include "redraw.h"
+#include "layout.h"
 #include "list_macros.h"
 
 #define MAX(a, b) ((a)>(b)?(a):(b))
@@ -44,21 +56,39 @@ static struct gfx_services        *gfx;
 static struct background_services *bg;
 static struct script_services     *script;
 static struct redraw_services     *redraw;
+static struct layout_services     *layout;
 
-enum { GRID_UPDATE_CELLMAP = 0x08 };
+enum {
+	GRID_UPDATE_CELLMAP  = 0x08,
+	GRID_UPDATE_SECTIONS = 0x10,   /* min/max of dirty sections changed */
+	MIN_SECTIONS         = 16,    /* initial capacity of section arrays */
+};
 
-struct section;
 struct section {
 	int   fixed;           /* fixed size or -1 (free)           */
 	int   size;            /* row size in pixels                */
 	int   offset;          /* position relative to grid parent  */
 	int   index;           /* index of row/column               */
+	int   pos;             /* position in section array         */
+	int   placed_size;     /* size when widgets were placed     */
+	int   placed_offset;   /* offset when widgets were placed   */
+	int   dirty;           /* min/max must be recalculated      */
 	int   min;             /* minimal size of section           */
 	int   max;             /* maximal size of section           */
 	WIDGET *minforce;      /* widget that enforced the minsize  */
 	WIDGET *maxforce;      /* widget that enforced the maxsize  */
 	float weight;          /* weight of row/column              */
-	struct section *next;  /* next row/column in connected list */
+};
+
+
+/**
+ * Rows or columns of a grid
+ */
+struct sections {
+	struct section **sec;  /* sections sorted by index          */
+	int              num;  /* number of sections                */
+	int              max;  /* capacity of 'sec' array           */
+	int              hit;  /* position of last found section    */
 };
 
 
@@ -72,15 +102,14 @@ struct cell {
 	s16 pad_x;               /* hor.distance of widget to cell border */
 	s16 pad_y;               /* ver.distance of widget to cell border */
 	WIDGET *wid;             /* associated widget                     */
+	int dirty;               /* widget must be repositioned           */
 	struct cell *next;       /* next cell in connected cell-list      */
 };
 
 
 struct grid_data {
-	struct section *rows;           /* list of rows                  */
-	struct section *cols;           /* list of columns               */
-	int             num_rows;       /* number of rows                */
-	int             num_cols;       /* number of columns             */
+	struct sections rows;           /* rows of the grid              */
+	struct sections cols;           /* columns of the grid           */
 	struct cell    *cells;          /* list of cells                 */
 	struct cell   **cellmap;        /* grid map with cell references */
 	u32             cellmapsize;    /* current size of cellmap       */
@@ -101,6 +130,7 @@ void print_grid_info(GRID *g)
 	struct section *sec;
 	struct cell *cc;
 	WIDGET *cw;
+	int i;
 
 	printf("Grid info:\n");
 	if (!g) printf(" grid is zero!\n");
@@ -110,8 +140,8 @@ void print_grid_info(GRID *g)
 	printf(" width  = %d\n", (int)g->wd->w);
 	printf(" height = %d\n", (int)g->wd->h);
 	printf(" row-sections:\n");
-	sec = g->gd->rows;
-	while (sec) {
+	for (i = 0; i < g->gd->rows.num; i++) {
+		sec = g->gd->rows.sec[i];
 		printf("  index: %d\n", sec->index);
 		printf("   offset:%d\n", sec->offset);
 		printf("   size:  %d\n", sec->size);
@@ -120,11 +150,10 @@ void print_grid_info(GRID *g)
 #else
 		printf("   weight:%f\n",  sec->weight);
 #endif
-		sec=sec->next;
 	}
 	printf(" column-sections:\n");
-	sec = g->gd->cols;
-	while (sec) {
+	for (i = 0; i < g->gd->cols.num; i++) {
+		sec = g->gd->cols.sec[i];
 		printf("  index: %d\n", sec->index);
 		printf("   offset:%d\n", sec->offset);
 		printf("   size:  %d\n", sec->size);
@@ -133,7 +162,6 @@ void print_grid_info(GRID *g)
 #else
 		printf("   weight:%f\n",  sec->weight);
 #endif
-		sec = sec->next;
 	}
 	printf(" child-widgets:\n");
 	cc = g->gd->cells;
@@ -159,47 +187,36 @@ void print_grid_info(GRID *g)
 }
 
 
-/**
- * Return the position of an element in a section list
- */
-static inline int get_section_num(struct section *curr, struct section *s)
-{
-	int i;
-	for (i=0; curr; i++) {
-		if (curr == s) return i;
-		curr = curr->next;
-	}
-	return 0;
-}
-
-
 /**
  * Set element of the cellmap
  */
 static void cellmap_set(GRID *g, int x, int y, struct cell *value)
 {
 	/* check agains grid boundaries */
-	if (x >= g->gd->num_cols) return;
-	if (y >= g->gd->num_rows) return;
+	if (x >= g->gd->cols.num) return;
+	if (y >= g->gd->rows.num) return;
 
-	g->gd->cellmap[y*g->gd->num_cols + x] = value;
+	g->gd->cellmap[y*g->gd->cols.num + x] = value;
 }
 
 
 /**
  * Insert references to cells into cellmap
+ *
+ * The cellmap is indexed by the array positions of the sections.
  */
 static inline void update_cellmap(GRID *g)
 {
 	struct cell *curr = g->gd->cells;
 	int i, j;
 
-	memset(g->gd->cellmap, 0, g->gd->num_rows * g->gd->num_cols * sizeof(struct cell *));
+	if (!g->gd->cellmap) return;
+
+	memset(g->gd->cellmap, 0, g->gd->rows.num * g->gd->cols.num * sizeof(struct cell *));
 	while (curr) {
-		for (j=0; j<curr->row_span; j++) for (i=0; i<curr->col_span; i++) {
-			cellmap_set(g, get_section_num(g->gd->cols, curr->col) + i,
-		                   get_section_num(g->gd->rows, curr->row) + j, curr);
-		}
+		if (curr->row && curr->col)
+			for (j=0; j<curr->row_span; j++) for (i=0; i<curr->col_span; i++)
+				cellmap_set(g, curr->col->pos + i, curr->row->pos + j, curr);
 		curr = curr->next;
 	}
 }
@@ -213,7 +230,7 @@ static inline void update_cellmap(GRID *g)
  */
 static void realloc_cellmap(GRID *g)
 {
-	u32 map_size = g->gd->num_rows * g->gd->num_cols;
+	u32 map_size = g->gd->rows.num * g->gd->cols.num;
 
 	/* check if there is enough space in current cellmap */
 	if (map_size > g->gd->cellmapsize) {
@@ -245,58 +262,78 @@ static struct section *new_section(u32 index)
 	section->offset = 0;
 	section->index  = index;
 	section->weight = 1.0;
-	section->next   = NULL;
 	return section;
 }
 
 
 /**
- * Return section structure by its index
- *
- * \return  section struct or NULL if there is no section with such index
+ * Return array position of the first section with an index not below 'idx'
  */
-static struct section *get_section(struct section *curr, s32 idx)
+static int lower_bound(struct sections *ss, s32 idx)
 {
-	while (curr) {
-		if (curr->index == idx) return curr;
-		curr = curr->next;
+	int lo = 0, hi = ss->num;
+
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+		if (ss->sec[mid]->index < idx) lo = mid + 1;
+		else                           hi = mid;
 	}
-	return NULL;
+	return lo;
 }
 
 
 /**
- * Creates a new section and inserts it into section list
+ * Return section structure by its index
  *
- * \param head   head of destination section list
- * \return       newly created section or NULL if section could not be created
+ * \return  section struct or NULL if there is no section with such index
  */
-static struct section *insert_section(struct section **head, s32 idx)
+static struct section *get_section(struct sections *ss, s32 idx)
 {
-	struct section *section = new_section(idx);
-	struct section *curr;
-
-	if (!section) return NULL;
+	int pos = lower_bound(ss, idx);
+	return (pos < ss->num && ss->sec[pos]->index == idx) ? ss->sec[pos] : NULL;
+}
 
-	/* if section list has no elements yet, set first element */
-	if (*head == NULL) return *head = section;
 
-	/* if index of first element is higher than new index */
-	if ((*head)->index > idx) {
-		section->next = *head;
-		return *head = section;
+/**
+ * Creates a new section and inserts it into section array
+ *
+ * \return  newly created section or NULL if section could not be created
+ */
+static struct section *insert_section(struct sections *ss, s32 idx)
+{
+	struct section *section;
+	int pos, i;
+
+	/* grow section array */
+	if (ss->num == ss->max) {
+		int new_max = ss->max ? 2*ss->max : MIN_SECTIONS;
+		struct section **new_sec = (struct section **)malloc(new_max*sizeof(struct section *));
+		if (!new_sec) {
+			INFO(printf("Grid(insert_section): out of memory!\n");)
+			return NULL;
+		}
+		if (ss->sec) {
+			memcpy(new_sec, ss->sec, ss->num*sizeof(struct section *));
+			free(ss->sec);
+		}
+		ss->sec = new_sec;
+		ss->max = new_max;
 	}
 
-	/* search for the needed index */
-	curr = *head;
-	while (curr->next) {
-		if (curr->next->index > idx) break;
-		curr = curr->next;
+	if (!(section = new_section(idx))) return NULL;
+
+	/* shift sections with higher indices, usually there are none */
+	pos = lower_bound(ss, idx);
+	for (i = ss->num; i > pos; i--) {
+		ss->sec[i] = ss->sec[i - 1];
+		ss->sec[i]->pos = i;
 	}
 
-	/* insert new element */
-	section->next = curr->next;
-	return curr->next = section;
+	section->pos = pos;
+	ss->sec[pos] = section;
+	ss->num++;
+	ss->hit = -1;
+	return section;
 }
 
 
@@ -307,13 +344,10 @@ static struct section *insert_section(struct section **head, s32 idx)
  */
 static struct section *get_row(GRID *g, s32 row_idx)
 {
-	struct section *ret = get_section(g->gd->rows, row_idx);
+	struct section *ret = get_section(&g->gd->rows, row_idx);
 	if (!ret) {
 		ret = insert_section(&g->gd->rows, row_idx);
-		if (ret) {
-			g->gd->num_rows++;
-			realloc_cellmap(g);
-		}
+		if (ret) realloc_cellmap(g);
 	}
 	return ret;
 }
@@ -326,13 +360,10 @@ static struct section *get_row(GRID *g, s32 row_idx)
  */
 static struct section *get_column(GRID *g, s32 col_idx)
 {
-	struct section *ret = get_section(g->gd->cols, col_idx);
+	struct section *ret = get_section(&g->gd->cols, col_idx);
 	if (!ret) {
 		ret = insert_section(&g->gd->cols, col_idx);
-		if (ret) {
-			g->gd->num_cols++;
-			realloc_cellmap(g);
-		}
+		if (ret) realloc_cellmap(g);
 	}
 	return ret;
 }
@@ -358,39 +389,39 @@ static struct cell *get_cell(GRID *g, WIDGET *w)
 /**
  * Calculate the sizes of rows/columns-sections
  *
- * \param seclist     begin of section list
- * \param sum_size    desired overall size
- * \param num_secs    max.number of sections to modify
+ * \param ss        rows or columns
+ * \param sum_size  desired overall size
  */
-static void  calc_section_sizes(struct section *seclist,
-                                s32 sum_size, u32 num_secs) {
+static void calc_section_sizes(struct sections *ss, s32 sum_size)
+{
 	struct section *curr;
 	float sum_weights  = 0.0;
 	s32   sum_weighted = sum_size;
 	s32   i;
 
 	/* sum weights of weighted sections */
-	for (curr=seclist, i=num_secs; (i--) && (curr); ) {
+	for (i = 0; i < ss->num; i++) {
+		curr = ss->sec[i];
 		if (curr->fixed < 0) {
 			curr->size = -1;
 			sum_weights += curr->weight;
 		}
-		curr = curr->next;
 	}
-	
+
 	/* define sections with fixed sizes and sum fixed sizes */
-	for (curr=seclist, i=num_secs; (i--) && (curr); ) {
+	for (i = 0; i < ss->num; i++) {
+		curr = ss->sec[i];
 		if (curr->fixed >= 0) {
 			curr->size = curr->fixed;
 			if (curr->size < curr->min) curr->size = curr->min;
 			if (curr->size > curr->max) curr->size = curr->max;
 			sum_weighted -= curr->size;
 		}
-		curr = curr->next;
 	}
-	
+
 	/* enforce max constrains to weighted sections */
-	for (curr=seclist, i=num_secs; (i--) && (curr); ) {
+	for (i = 0; i < ss->num; i++) {
+		curr = ss->sec[i];
 		if (curr->size == -1) {
 			int size = (sum_weighted*curr->weight)/sum_weights;
 			if (size > curr->max) {
@@ -399,16 +430,14 @@ static void  calc_section_sizes(struct section *seclist,
 				sum_weights  -= curr->weight;
 
 				/* weights changed - so lets restart from the beginning of the list */
-				curr = seclist;
-				i = num_secs;
-				continue;
+				i = -1;
 			}
 		}
-		curr = curr->next;
 	}
-	
+
 	/* apply min constrains to weighted sections */
-	for (curr=seclist, i=num_secs; (i--) && (curr); ) {
+	for (i = 0; i < ss->num; i++) {
+		curr = ss->sec[i];
 		if (curr->size == -1) {
 			int size = (sum_weighted*curr->weight)/sum_weights;
 			if (size < curr->min) {
@@ -417,16 +446,14 @@ static void  calc_section_sizes(struct section *seclist,
 				sum_weights  -= curr->weight;
 
 				/* weights changed - so lets restart from the beginning of the list */
-				curr = seclist;
-				i = num_secs;
-				continue;
+				i = -1;
 			}
 		}
-		curr = curr->next;
 	}
-	
+
 	/* balance remaining weighted sections */
-	for (curr=seclist, i=num_secs; (i--) && (curr); ) {
+	for (i = 0; i < ss->num; i++) {
+		curr = ss->sec[i];
 		if (curr->size == -1) {
 
 			/*
@@ -437,47 +464,100 @@ static void  calc_section_sizes(struct section *seclist,
 			curr->size = (sum_weighted*curr->weight)/sum_weights;
 			sum_weighted -= curr->size;
 			sum_weights  -= curr->weight;
+
+			/* keep offsets ascending if the grid is smaller than its min size */
+			if (curr->size < 0) curr->size = 0;
 		}
-		curr = curr->next;
 	}
 }
 
 
 /**
  * Calculate offsets of sections relative to the first section
+ *
+ * \param from  array position of first section with a changed size
  */
-static void calc_section_offsets(struct section *curr)
+static void calc_section_offsets(struct sections *ss, int from)
 {
 	s32 curr_offset = 0;
-	if (!curr) return;
-	while (curr) {
-		curr->offset = curr_offset;
-		curr_offset = curr_offset + curr->size;
-		curr = curr->next;
+
+	if (from > 0 && from <= ss->num)
+		curr_offset = ss->sec[from - 1]->offset + ss->sec[from - 1]->size;
+	else
+		from = 0;
+
+	for (int i = from; i < ss->num; i++) {
+		ss->sec[i]->offset = curr_offset;
+		curr_offset += ss->sec[i]->size;
+	}
+}
+
+
+/**
+ * Return array position of first section that changed its size since the
+ * widgets were placed
+ */
+static int first_resized_section(struct sections *ss)
+{
+	int i;
+	for (i = 0; i < ss->num; i++)
+		if (ss->sec[i]->size != ss->sec[i]->placed_size) break;
+	return i;
+}
+
+
+/**
+ * Check if one of the specified number of sections changed its geometry
+ * since the widgets were placed
+ */
+static int sections_changed(struct sections *ss, struct section *s, int num_sections)
+{
+	for (int i = s->pos; i < s->pos + num_sections && i < ss->num; i++)
+		if (ss->sec[i]->size   != ss->sec[i]->placed_size
+		 || ss->sec[i]->offset != ss->sec[i]->placed_offset) return 1;
+	return 0;
+}
+
+
+/**
+ * Remember current section geometry as the one the widgets are placed at
+ */
+static void commit_sections(struct sections *ss)
+{
+	for (int i = 0; i < ss->num; i++) {
+		ss->sec[i]->placed_size   = ss->sec[i]->size;
+		ss->sec[i]->placed_offset = ss->sec[i]->offset;
 	}
 }
 
 
 /**
  * Return size of the specified number of neighbour sections
+ *
+ * The span ends at the first missing section index.
  */
-static s32 get_section_size(struct section *curr, u32 num_sections)
+static s32 get_section_size(struct sections *ss, struct section *s, u32 num_sections)
 {
-	if (!curr || !num_sections) return 0;
-	if (num_sections > 1)
-		return curr->size + get_section_size(get_section(curr, curr->index+1), num_sections-1);
-	else
-		return curr->size;
+	struct section *last = s;
+
+	if (!s || !num_sections) return 0;
+
+	for (u32 i = 1; i < num_sections && s->pos + (s32)i < ss->num; i++) {
+		struct section *next = ss->sec[s->pos + i];
+		if (next->index != s->index + (s32)i) break;
+		last = next;
+	}
+	return last->offset + last->size - s->offset;
 }
 
 
 /**
  * Calculate sum of section min sizes
  */
-static s32 get_sections_minsum(struct section *s)
+static s32 get_sections_minsum(struct sections *ss)
 {
 	s32 min = 0;
-	while (s) { min += s->min; s = s->next; }
+	for (int i = 0; i < ss->num; i++) min += ss->sec[i]->min;
 	return min;
 }
 
@@ -485,10 +565,10 @@ static s32 get_sections_minsum(struct section *s)
 /**
  * Calculate sum of section max sizes
  */
-static s32 get_sections_maxsum(struct section *s)
+static s32 get_sections_maxsum(struct sections *ss)
 {
 	s32 max = 0;
-	while (s) { max += s->max; s = s->next; }
+	for (int i = 0; i < ss->num; i++) max += ss->sec[i]->max;
 	return max;
 }
 
@@ -540,33 +620,78 @@ static void position_widget(WIDGET *w, int cx, int cy, int cw, int ch, int stick
 }
 
 
+/**
+ * Set position of cell widget to the position of its cell
+ */
+static void place_cell(GRID *g, struct cell *cc)
+{
+	s32 cell_x, cell_y, cell_w, cell_h;
+
+	cc->dirty = 0;
+	if (!cc->col || !cc->row || !cc->wid) return;
+
+	cell_x = cc->col->offset + cc->pad_x;
+	cell_y = cc->row->offset + cc->pad_y;
+	cell_w = get_section_size(&g->gd->cols, cc->col, cc->col_span) - (float)(2*cc->pad_x);
+	cell_h = get_section_size(&g->gd->rows, cc->row, cc->row_span) - (float)(2*cc->pad_y);
+	position_widget(cc->wid, cell_x, cell_y, cell_w, cell_h, cc->sticky);
+}
+
+
 /**
  * Set positions of grid widgets to its cells positions
  */
 static void place_widgets(GRID *g)
 {
-	struct cell *cc;        /* current cell */
-	WIDGET *cw;             /* current widget */
-	s32 cell_x, cell_y, cell_w, cell_h;
+	for (struct cell *cc = g->gd->cells; cc; cc = cc->next)
+		place_cell(g, cc);
+}
 
-	cc = g->gd->cells;
-	while (cc) {
-		if (cc->col && cc->row) {
-			cell_x = cc->col->offset + cc->pad_x;
-			cell_y = cc->row->offset + cc->pad_y;
-			cell_w = get_section_size(cc->col, cc->col_span) - (float)(2*cc->pad_x);
-			cell_h = get_section_size(cc->row, cc->row_span) - (float)(2*cc->pad_y);
-			cw = cc->wid;
-			if (cw) position_widget(cw, cell_x, cell_y, cell_w, cell_h, cc->sticky);
-		}
-		cc = cc->next;
+
+/**
+ * Reposition cell widget and redraw its old and new area
+ */
+static void replace_cell(GRID *g, struct cell *cc)
+{
+	WIDGET *cw = cc->wid;
+	long x1, y1, x2, y2;
+
+	if (!cc->col || !cc->row || !cw) return;
+
+	/* remember old widget area */
+	x1 = cw->wd->x;  x2 = cw->wd->x + cw->wd->w - 1;
+	y1 = cw->wd->y;  y2 = cw->wd->y + cw->wd->h - 1;
+
+	place_cell(g, cc);
+
+	/* redraw union of old and new widget area */
+	x1 = MIN(x1, cw->wd->x);  x2 = MAX(x2, cw->wd->x + cw->wd->w - 1);
+	y1 = MIN(y1, cw->wd->y);  y2 = MAX(y2, cw->wd->y + cw->wd->h - 1);
+	redraw->draw_widgetarea(g, x1, y1, x2, y2);
+}
+
+/**
+ * Return array position of the first section that ends behind 'pos'
+ *
+ * \return  position or number of sections if there is no such section
+ */
+static int first_section_behind(struct sections *ss, int pos)
+{
+	int lo = 0, hi = ss->num;
+
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+		if (ss->sec[mid]->offset + ss->sec[mid]->size <= pos) lo = mid + 1;
+		else                                                 hi = mid;
 	}
+	return lo;
 }
 
+
 /**
  * Calculate range of sections that are visible at a specified pixel range
  *
- * \param cs    list of sections
+ * \param ss    rows or columns
  * \param min   start of visible pixel range
  * \param max   end of visible pixel range
  * \param beg   result: index of first visible section
@@ -574,20 +699,24 @@ static void place_widgets(GRID *g)
  * \returns     1 if there are visible sections,
  *              0 if range does not contain any visible sections
  */
-static inline int calc_visible_sections(struct section *cs, int min, int max,
+static inline int calc_visible_sections(struct sections *ss, int min, int max,
                                         int *beg, int *end) {
-	int i = 0;
+	int lo, hi;
 
-	/* skip invisible sections at the beginning of section list */
-	for (; cs && (cs->offset + cs->size < min); cs = cs->next, i++);
-	if (!cs) return 0;
-	*beg = i;
+	/* skip invisible sections at the beginning of section array */
+	*beg = first_section_behind(ss, min - 1);
+	if (*beg == ss->num) return 0;
 
 	/* search last visible section */
-	for (; cs && (cs->offset < max); cs = cs->next, i++);
+	lo = *beg; hi = ss->num;
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+		if (ss->sec[mid]->offset < max) lo = mid + 1;
+		else                            hi = mid;
+	}
 
-	/* i is the index after the last visible section */
-	*end = i - 1;
+	/* lo is the index after the last visible section */
+	*end = lo - 1;
 	if (*beg > *end) return 0;
 
 	return 1;
@@ -644,8 +773,8 @@ static int grid_draw(GRID *g, struct gfx_ds *ds, long x, long y, WIDGET *origin)
 	y += g->wd->y;
 
 	/* determine visible cells of the grid */
-	if (!calc_visible_sections(g->gd->cols, cx1-x, cx2-x, &col_beg, &col_end)
-	 || !calc_visible_sections(g->gd->rows, cy1-y, cy2-y, &row_beg, &row_end)) {
+	if (!calc_visible_sections(&g->gd->cols, cx1-x, cx2-x, &col_beg, &col_end)
+	 || !calc_visible_sections(&g->gd->rows, cy1-y, cy2-y, &row_beg, &row_end)) {
 
 		/* if there are no visible sections at all we just draw the background */
 		ret |= g->gen->draw_bg(g, ds, cx1, cy1, cx2 - cx1 + 1, cy2 - cy1 + 1, origin, 0);
@@ -665,7 +794,7 @@ static int grid_draw(GRID *g, struct gfx_ds *ds, long x, long y, WIDGET *origin)
 		for (i = col_beg, cx = cx1; i <= col_end; i++) {
 
 			/* fetch current cell from cell map, skip empty positions */
-			cc = g->gd->cellmap[g->gd->num_cols*j + i];
+			cc = g->gd->cellmap[g->gd->cols.num*j + i];
 			if (!cc || !cc->wid || !cc->col || !cc->row) continue;
 
 			/* determine cell area */
@@ -737,46 +866,68 @@ static int grid_draw(GRID *g, struct gfx_ds *ds, long x, long y, WIDGET *origin)
 }
 
 
+/**
+ * Look up section that covers the specified position
+ *
+ * The section of the last lookup is checked first.
+ *
+ * \return  array position of section or -1 if there is none
+ */
+static inline int find_section(struct sections *ss, long pos)
+{
+	struct section *cs;
+	int i;
+
+	/* pointer moved within the section of the last lookup */
+	if (ss->hit >= 0 && ss->hit < ss->num) {
+		cs = ss->sec[ss->hit];
+		if ((pos >= cs->offset) && (pos < cs->offset + cs->size))
+			return ss->hit;
+	}
+
+	i = first_section_behind(ss, pos);
+	if (i == ss->num || pos < ss->sec[i]->offset) return -1;
+
+	return ss->hit = i;
+}
+
+
 static WIDGET *grid_find(GRID *g, long x, long y)
 {
 	struct cell *cc;
 	WIDGET *cw;
 	WIDGET *result;
+	int col, row;
 
 	x -= g->wd->x;
 	y -= g->wd->y;
 
 	/* check if position is inside the window */
-	if ((x >= 0) && (y >= 0) && (x < g->wd->w) && (y < g->wd->h)) {
-
-		/* go through all cells and check their widgets */
-		cc = g->gd->cells;
-		while (cc) {
-			cw = cc->wid;
-			if (cw) {
-				result = cw->gen->find(cw, x, y);
-				if (result) return result;
-			}
-			cc = cc->next;
-		}
+	if ((x < 0) || (y < 0) || (x >= g->wd->w) || (y >= g->wd->h))
+		return NULL;
+
+	/*
+	 * Cells do not overlap. Hence, the cell map tells us the only
+	 * candidate at the position once we know the row and column. The
+	 * cell map is stale while placement changes are pending. In this
+	 * case, we go through all cells and check their widgets.
+	 */
+	if (g->gd->cellmap && !(g->gd->update & GRID_UPDATE_CELLMAP)) {
+		col = find_section(&g->gd->cols, x);
+		row = find_section(&g->gd->rows, y);
+		if ((col < 0) || (row < 0)) return g;
+
+		cc = g->gd->cellmap[g->gd->cols.num*row + col];
+		if (cc && (cw = cc->wid) && (result = cw->gen->find(cw, x, y)))
+			return result;
 		return g;
 	}
-	return NULL;
-}
 
-
-/**
- * Update cellmap when placement changed
- */
-static void (*orig_update) (GRID *);
-static void grid_update(GRID *g)
-{
-	if (g->gd->update & GRID_UPDATE_CELLMAP) {
-		g->wd->update |= WID_UPDATE_MINMAX;
-		update_cellmap(g);
+	for (cc = g->gd->cells; cc; cc = cc->next) {
+		cw = cc->wid;
+		if (cw && (result = cw->gen->find(cw, x, y))) return result;
 	}
-	orig_update(g);
-	g->gd->update = 0;
+	return g;
 }
 
 
@@ -789,60 +940,68 @@ static void (*orig_updatepos) (GRID *g);
 static void grid_updatepos(GRID *g)
 {
 	/* calculate sizes of rows/columns */
-	calc_section_sizes(g->gd->cols, g->wd->w, 99999);
-	calc_section_sizes(g->gd->rows, g->wd->h, 99999);
+	calc_section_sizes(&g->gd->cols, g->wd->w);
+	calc_section_sizes(&g->gd->rows, g->wd->h);
 
 	/* calculate offsets of rows/columns */
-	calc_section_offsets(g->gd->cols);
-	calc_section_offsets(g->gd->rows);
+	calc_section_offsets(&g->gd->cols, 0);
+	calc_section_offsets(&g->gd->rows, 0);
 	
 	/* set child widget positions */
 	place_widgets(g);
+	commit_sections(&g->gd->cols);
+	commit_sections(&g->gd->rows);
 	orig_updatepos(g);
 }
 
 
 /**
- * Determine min/max size of grid widget
- *
- * The min/max properties of a Grid depend on the min/max properties of
- * its child widgets.
- *
- * FIXME: The span placement does not work, yet.
+ * Assign initial min/max values to rows or columns
  */
-static void grid_calc_minmax(GRID *g)
+static void reset_sections_minmax(struct sections *ss, int dirty_only)
 {
-	struct cell *c;
-	struct section *s;
-	WIDGET *cw;
-
-	/* if grid has no content let it have any size */
-	if (!g->gd->rows || !g->gd->cols) {
-		g->wd->min_w = g->wd->min_h = 0;
-		return;
-	}
-
-	/* assign initial min/max values to all rows and columns */
-	s = g->gd->rows;
-	while (s) {
+	for (int i = 0; i < ss->num; i++) {
+		struct section *s = ss->sec[i];
+		if (dirty_only && !s->dirty) continue;
 		if (s->fixed < 0) {
 			s->min = 0; s->max = 999999;
 		} else {
 			s->min = s->max = s->fixed;
 		}
-		s = s->next;
 	}
-	
-	s = g->gd->cols;
-	while (s) {
-		if (s->fixed < 0) {
-			s->min = 0; s->max = 999999;
-		} else {
-			s->min = s->max = s->fixed;
-		}
-		s = s->next;
+}
+
+
+/**
+ * Resolve conflicting min/max values of rows or columns
+ *
+ * If min > max, min is stronger than max.
+ */
+static void limit_sections_minmax(struct sections *ss, int dirty_only)
+{
+	for (int i = 0; i < ss->num; i++) {
+		struct section *s = ss->sec[i];
+		if (dirty_only && !s->dirty) continue;
+		if (s->min < s->fixed) s->min = s->fixed;
+		if (s->min > s->max)   s->max = s->min;
+		s->dirty = 0;
 	}
-	
+}
+
+
+/**
+ * Calculate min/max values of rows and columns
+ *
+ * \param dirty_only  revisit only the sections marked as dirty
+ */
+static void calc_sections_minmax(GRID *g, int dirty_only)
+{
+	struct cell *c;
+	WIDGET *cw;
+
+	reset_sections_minmax(&g->gd->rows, dirty_only);
+	reset_sections_minmax(&g->gd->cols, dirty_only);
+
 	/*
 	 * Calculate min/max values for columns/rows by finding the highest min
 	 * and lowest max value of the widgets inside a column/row.
@@ -853,7 +1012,7 @@ static void grid_calc_minmax(GRID *g)
 		int cw_min, cw_max;
 		cw = c->wid;
 //		if ((c->row) && (c->row->fixed < 0)) {
-		if (c->row) {
+		if (c->row && (!dirty_only || c->row->dirty)) {
 			cw_min = cw->gen->get_min_h(cw) + 2*c->pad_y;
 			cw_max = cw->gen->get_max_h(cw) + 2*c->pad_y;
 			if (cw_min >= c->row->min) {
@@ -868,7 +1027,7 @@ static void grid_calc_minmax(GRID *g)
 			}
 		}
 //		if ((c->col) && (c->col->fixed < 0)) {
-		if (c->col) {
+		if (c->col && (!dirty_only || c->col->dirty)) {
 			cw_min = cw->gen->get_min_w(cw) + 2*c->pad_x;
 			cw_max = cw->gen->get_max_w(cw) + 2*c->pad_x;
 			if (cw_min >= c->col->min) {
@@ -885,25 +1044,105 @@ static void grid_calc_minmax(GRID *g)
 		c = c->next;
 	}
 
-	/* check if min > max - in this case min is stronger than max */
-	s = g->gd->rows;
-	while (s) {
-		if (s->min < s->fixed) s->min = s->fixed;
-		if (s->min > s->max)   s->max = s->min;
-		s = s->next;
+	limit_sections_minmax(&g->gd->rows, dirty_only);
+	limit_sections_minmax(&g->gd->cols, dirty_only);
+
+	g->wd->min_w = get_sections_minsum(&g->gd->cols);
+	g->wd->max_w = get_sections_maxsum(&g->gd->cols);
+
+	g->wd->min_h = get_sections_minsum(&g->gd->rows);
+	g->wd->max_h = get_sections_maxsum(&g->gd->rows);
+}
+
+
+/**
+ * Determine min/max size of grid widget
+ *
+ * The min/max properties of a Grid depend on the min/max properties of
+ * its child widgets.
+ *
+ * FIXME: The span placement does not work, yet.
+ */
+static void grid_calc_minmax(GRID *g)
+{
+	/* if grid has no content let it have any size */
+	if (!g->gd->rows.num || !g->gd->cols.num) {
+		g->wd->min_w = g->wd->min_h = 0;
+		return;
 	}
-	s = g->gd->cols;
-	while (s) {
-		if (s->min < s->fixed) s->min = s->fixed;
-		if (s->min > s->max)   s->max = s->min;
-		s = s->next;
+
+	calc_sections_minmax(g, 0);
+}
+
+
+/**
+ * Relayout grid after the min/max size of children in dirty sections changed
+ *
+ * The sizes of the sections are distributed anew. Only widgets whose cells
+ * changed their geometry are repositioned and only their old and new areas
+ * get redrawn.
+ *
+ * \return  0 if the min/max size of the grid itself changed, which requires
+ *          the parent to update the whole grid
+ */
+static int relayout_dirty_sections(GRID *g)
+{
+	s32 min_w = g->wd->min_w, max_w = g->wd->max_w;
+	s32 min_h = g->wd->min_h, max_h = g->wd->max_h;
+	struct cell *cc;
+
+	calc_sections_minmax(g, 1);
+
+	if (g->wd->min_w != min_w || g->wd->max_w != max_w
+	 || g->wd->min_h != min_h || g->wd->max_h != max_h) {
+
+		/* let the update of the grid detect the change */
+		g->wd->min_w = min_w;  g->wd->max_w = max_w;
+		g->wd->min_h = min_h;  g->wd->max_h = max_h;
+		return 0;
 	}
 
-	g->wd->min_w = get_sections_minsum(g->gd->cols);
-	g->wd->max_w = get_sections_maxsum(g->gd->cols);
+	calc_section_sizes(&g->gd->cols, g->wd->w);
+	calc_section_sizes(&g->gd->rows, g->wd->h);
+
+	calc_section_offsets(&g->gd->cols, first_resized_section(&g->gd->cols));
+	calc_section_offsets(&g->gd->rows, first_resized_section(&g->gd->rows));
+
+	for (cc = g->gd->cells; cc; cc = cc->next)
+		if (cc->dirty
+		 || (cc->col && sections_changed(&g->gd->cols, cc->col, cc->col_span))
+		 || (cc->row && sections_changed(&g->gd->rows, cc->row, cc->row_span)))
+			replace_cell(g, cc);
 
-	g->wd->min_h = get_sections_minsum(g->gd->rows);
-	g->wd->max_h = get_sections_maxsum(g->gd->rows);
+	commit_sections(&g->gd->cols);
+	commit_sections(&g->gd->rows);
+	return 1;
+}
+
+
+/**
+ * Update cellmap when placement changed
+ *
+ * If only the min/max sizes of children changed, the grid is relayouted
+ * incrementally.
+ */
+static void (*orig_update) (GRID *);
+static void grid_update(GRID *g)
+{
+	if (g->gd->update & GRID_UPDATE_CELLMAP) {
+		g->wd->update |= WID_UPDATE_MINMAX;
+		update_cellmap(g);
+	}
+
+	/* only children in dirty sections changed their min/max size */
+	if (g->gd->update == GRID_UPDATE_SECTIONS && !g->wd->update
+	 && relayout_dirty_sections(g)) {
+		g->gd->update = 0;
+		return;
+	}
+
+	orig_update(g);
+	g->gd->update = 0;
 }
 
 
@@ -913,11 +1152,11 @@ static int grid_do_layout(GRID *g, WIDGET *child)
 	struct section *row, *col;
 	int w, h, cx, cy, cw, ch;
 	int ox, oy, ow, oh;
-	int force_update = 0;
+	int force_update = 0, new_child = 0;
 
 	/* if child is new, get familar with it */ 
 	if (child->wd->update & WID_UPDATE_NEWCHILD) {
-		force_update = 1;
+		force_update = new_child = 1;
 		child->wd->update &= ~WID_UPDATE_NEWCHILD;
 	}
 
@@ -956,9 +1195,21 @@ static int grid_do_layout(GRID *g, WIDGET *child)
 	 || (row && row->maxforce == child && child->wd->max_h < row->max))
 		force_update = 1;
 
+	/*
+	 * If only the min/max size of a placed child changed, revisit its row
+	 * and column and keep the other widgets untouched where possible.
+	 */
+	if (force_update && !new_child && col && row
+	 && !(g->gd->update & GRID_UPDATE_CELLMAP)) {
+		col->dirty = row->dirty = c->dirty = 1;
+		g->gd->update |= GRID_UPDATE_SECTIONS;
+		layout->update(g);
+		return 0;
+	}
+
 	if (force_update) {
 		g->wd->update |= WID_UPDATE_MINMAX;
-		g->gen->update(g);
+		layout->update(g);
 		return 0;
 	}
 
@@ -986,6 +1237,16 @@ static int grid_do_layout(GRID *g, WIDGET *child)
 }
 
 
+/**
+ * Free section array and its sections
+ */
+static void free_sections(struct sections *ss)
+{
+	for (int i = 0; i < ss->num; i++) free(ss->sec[i]);
+	free(ss->sec);
+}
+
+
 /**
  * Free grid data
  */
@@ -1000,10 +1261,10 @@ static void grid_free_data(GRID *g)
 		cc = nc;
 	}
 	
-	/* free cell list and section lists */
-	FREE_CONNECTED_LIST(struct cell,    g->gd->cells, free);
-	FREE_CONNECTED_LIST(struct section, g->gd->rows,  free);
-	FREE_CONNECTED_LIST(struct section, g->gd->cols,  free);
+	/* free cell list and section arrays */
+	FREE_CONNECTED_LIST(struct cell, g->gd->cells, free);
+	free_sections(&g->gd->rows);
+	free_sections(&g->gd->cols);
 	
 	/* free cell map */
 	free(g->gd->cellmap);
@@ -1019,8 +1280,8 @@ static inline int get_position(GRID *g, WIDGET *cw, int *out_x, int *out_y)
 	int x, y;
 
 	/* go through the cellmap */
-	for (y = 0; y < g->gd->num_rows; y++) for (x = 0; x < g->gd->num_cols; x++) {
-		cc = g->gd->cellmap[g->gd->num_cols*y + x];
+	for (y = 0; y < g->gd->rows.num; y++) for (x = 0; x < g->gd->cols.num; x++) {
+		cc = g->gd->cellmap[g->gd->cols.num*y + x];
 		if (cc && (cc->wid == cw)) {
 			*out_x = x;
 			*out_y = y;
@@ -1039,13 +1300,13 @@ static inline int get_position(GRID *g, WIDGET *cw, int *out_x, int *out_y)
  */
 static inline WIDGET *get_next_kfocus(GRID *g, int x, int y, int dir, int off)
 {
-	int max = g->gd->num_cols * g->gd->num_rows;
+	int max = g->gd->cols.num * g->gd->rows.num;
 	int offset;
 	WIDGET *nw;
 	struct cell *cc;
 
 	/* determine start offset in cellmap to begin the search */
-	offset = (y*g->gd->num_cols + x + off) % max;
+	offset = (y*g->gd->cols.num + x + off) % max;
 	for (; (offset >= 0) && (offset < max); offset += dir) {
 
 		cc = g->gd->cellmap[offset];
@@ -1373,7 +1634,7 @@ static void script_column_config(GRID *g, long index, float weight, long width)
 	 * create a column with default width.
 	 */
 	if (weight == -1 && width == -1
-	 && !get_section(g->gd->cols, index)) weight = 1.0;
+	 && !get_section(&g->gd->cols, index)) weight = 1.0;
 
 	if (width!=-1) grid_set_col_w(g, index, width);
 	else if (weight > 0.0) grid_set_col_weight(g, index, weight);
@@ -1388,7 +1649,7 @@ static void script_row_config(GRID *g, long index, float weight, long width)
 	 * create a row with default width.
 	 */
 	if (weight == -1 && width == -1
-	 && !get_section(g->gd->rows, index)) weight = 1.0;
+	 && !get_section(&g->gd->rows, index)) weight = 1.0;
 
 	if (width!=-1) grid_set_row_h(g, index, width);
 	else if (weight > 0.0) grid_set_row_weight(g, index, weight);
@@ -1461,6 +1722,7 @@ int init_grid(struct dope_services *d)
 	bg     = (background_services *)(d->get_module("Background 1.0"));
 	script = (script_services     *)(d->get_module("Script 1.0"));
 	redraw = (redraw_services     *)(d->get_module("RedrawManager 1.0"));
+	layout = (layout_services     *)(d->get_module("Layout 1.0"));
 
 	/* define general widget functions */
 	widman->default_widget_methods(&gen_methods);
@@ -8,6 +8,11 @@
  * added while specifying  an identifier. This
  * identifier is  also used to retrieve a hash
  * table element.
+ *
+ * The hash value is calculated over the whole
+ * identifier (FNV-1a). The bucket array grows
+ * automatically when the number of elements
+ * exceeds the load limit.
  */
 
 /*
@@ -22,11 +27,18 @@
 #include "hashtab.h"
 #include "list_macros.h"
 
-#define MIN(a,b) ((a)<(b)?(a):(b))
+enum {
+	MIN_TAB_SIZE = 8,            /* smallest number of buckets          */
+	MAX_LOAD     = 2,            /* max average bucket chain length     */
+	FNV_OFFSET   = 2166136261u,  /* FNV-1a 32-bit offset basis          */
+	FNV_PRIME    = 16777619u,    /* FNV-1a 32-bit prime                 */
+};
 
 struct hashtab_entry;
 struct hashtab_entry {
 	char           const *ident;
+	u32                   ident_len;  /* length of identifier string    */
+	u32                   hashval;    /* full hash value of identifier  */
 	void                 *value;
 	struct hashtab_entry *next;
 	void                (*destroy_elem_function) (void *value);
@@ -34,9 +46,11 @@ struct hashtab_entry {
 
 struct hashtab {
 	int ref_cnt;                    /* reference counter                   */
-	u32 tab_size;                   /* hash table size                     */
-	u32 max_hash_length;            /* number of chars for building hashes */
+	u32 tab_size;                   /* hash table size (power of two)      */
+	u32 num_elem;                   /* number of stored elements           */
 	struct hashtab_entry **tab;     /* hash table itself                   */
+	struct hashtab_entry *cursor;   /* last entry returned by iteration    */
+	u32 cursor_idx;                 /* bucket index of cursor entry        */
 };
 
 int init_hashtable(struct dope_services *d);
@@ -48,44 +62,112 @@ void hashtab_print_info(HASHTAB *h);
  ********************************/
 
 /**
- * Calculate hash value for a given string by adding its characters
+ * Calculate FNV-1a hash value of an identifier
+ *
+ * \param ident    identifier string, not necessarily null-terminated
+ * \param max_len  maximum number of characters to consider
+ * \param out_len  resulting effective length of the identifier
  */
-static u32 hash_value(char const *ident, u32 max_cnt)
+static u32 hash_value(char const *ident, u32 max_len, u32 *out_len)
 {
-	u32 result = 0;
-	if (!ident) return 0;
-	while ((*ident) && (max_cnt>0)) {
-		result += *ident;
-		ident++;
-		max_cnt--;
-	}
+	u32 result = FNV_OFFSET;
+	u32 len = 0;
+
+	if (ident)
+		for (; len < max_len && ident[len]; len++) {
+			result ^= (u8)ident[len];
+			result *= FNV_PRIME;
+		}
+
+	*out_len = len;
 	return result;
 }
 
 
+/**
+ * Check if entry matches the identifier of the specified hash value and length
+ */
+static inline int entry_matches(struct hashtab_entry *e, char const *ident,
+                                u32 hashval, u32 len)
+{
+	if (e->hashval != hashval || e->ident_len != len) return 0;
+
+	for (u32 i = 0; i < len; i++)
+		if (e->ident[i] != ident[i]) return 0;
+
+	return 1;
+}
+
+
+/**
+ * Allocate zeroed bucket array
+ */
+static struct hashtab_entry **alloc_buckets(u32 tab_size)
+{
+	return (struct hashtab_entry **)zalloc(sizeof(struct hashtab_entry *)*tab_size);
+}
+
+
+/**
+ * Double the number of buckets and redistribute the entries
+ *
+ * The entries are just relinked, identifiers and hash values stay the same.
+ * If the new bucket array cannot be allocated, the table keeps its size.
+ */
+static void grow(HASHTAB *h)
+{
+	u32 new_size = h->tab_size*2;
+	struct hashtab_entry **new_tab = alloc_buckets(new_size);
+	if (!new_tab) return;
+
+	for (u32 i = 0; i < h->tab_size; i++) {
+		struct hashtab_entry *e = h->tab[i], *next;
+		for (; e; e = next) {
+			u32 idx = e->hashval & (new_size - 1);
+			next = e->next;
+			e->next = new_tab[idx];
+			new_tab[idx] = e;
+		}
+	}
+
+	free(h->tab);
+	h->tab      = new_tab;
+	h->tab_size = new_size;
+	h->cursor   = NULL;
+}
+
+
 /***********************
  ** Service functions **
  ***********************/
 
 /**
- * Create a new hash table of the specified size
+ * Create a new hash table with an initial number of buckets
+ *
+ * The initial size is rounded up to the next power of two.
  */
-static HASHTAB *hashtab_create(u32 tab_size, u32 max_hash_length)
+static HASHTAB *hashtab_create(u32 tab_size)
 {
-	INFO(printf("Entering HashTable(create)!\n");)
 	struct hashtab *new_hashtab;
-	new_hashtab = (struct hashtab *)zalloc(sizeof(struct hashtab)
-	                                     + sizeof(void *)*tab_size);
-	INFO(printf("HashTable(create): zalloc done\n");)
+	u32 size = MIN_TAB_SIZE;
+
+	while (size < tab_size) size *= 2;
+
+	new_hashtab = (struct hashtab *)zalloc(sizeof(struct hashtab));
 	if (!new_hashtab) {
 		INFO(printf("HashTable(create): out of memory!\n");)
 		return NULL;
 	}
 
+	new_hashtab->tab = alloc_buckets(size);
+	if (!new_hashtab->tab) {
+		INFO(printf("HashTable(create): out of memory!\n");)
+		free(new_hashtab);
+		return NULL;
+	}
+
 	new_hashtab->ref_cnt  = 1;
-	new_hashtab->tab_size = tab_size;
-	new_hashtab->max_hash_length = max_hash_length;
-	new_hashtab->tab = (struct hashtab_entry **)((long)new_hashtab + sizeof(struct hashtab));
+	new_hashtab->tab_size = size;
 	return new_hashtab;
 }
 
@@ -95,8 +177,6 @@ static HASHTAB *hashtab_create(u32 tab_size, u32 max_hash_length)
  */
 static inline void free_hashtab_entry(struct hashtab_entry *e)
 {
-	if (e->ident)
-		free(e->ident);
 	if (e->destroy_elem_function)
 		e->destroy_elem_function(e->value);
 	free(e);
@@ -127,28 +207,30 @@ static void hashtab_dec_ref(HASHTAB *h)
 	for (i=0; i<h->tab_size; i++) {
 		FREE_CONNECTED_LIST(struct hashtab_entry, h->tab[i], free_hashtab_entry);
 	}
+	free(h->tab);
 	free(h);
 }
 
 
 /**
  * Requests an element of a hash table
+ *
+ * The identifier is considered up to max_len characters or up to its
+ * null-termination, whatever comes first.
  */
 static void *hashtab_get_elem(HASHTAB *h, char const *ident, unsigned max_len)
 {
-	u32 hashval;
+	u32 hashval, len;
 	struct hashtab_entry *ce;
 
-	if (!h) return NULL;
-	hashval = hash_value(ident, MIN(max_len, h->max_hash_length)) % (h->tab_size);
-	INFO(printf("hashval for %s is %ld, max_len = %d\n", ident, hashval, max_len));
-	ce = h->tab[hashval];
-	if (!ce) return NULL;
-	while (!streq(ident, ce->ident, max_len)) {
-		ce = ce->next;
-		if (!ce) return NULL;
-	}
-	return ce->value;
+	if (!h || !ident) return NULL;
+	hashval = hash_value(ident, max_len, &len);
+
+	for (ce = h->tab[hashval & (h->tab_size - 1)]; ce; ce = ce->next)
+		if (entry_matches(ce, ident, hashval, len))
+			return ce->value;
+
+	return NULL;
 }
 
 
@@ -157,34 +239,25 @@ static void *hashtab_get_elem(HASHTAB *h, char const *ident, unsigned max_len)
  */
 static void hashtab_remove_elem(HASHTAB *h, char const *ident)
 {
-	u32 hashval;
-	struct hashtab_entry *ce, *re;
-	if (!h) return;
-	hashval = hash_value(ident, h->max_hash_length) % (h->tab_size);
-	ce = h->tab[hashval];
+	u32 hashval, len;
+	struct hashtab_entry **ce, *re;
+
+	if (!h || !ident) return;
+	hashval = hash_value(ident, ~0U, &len);
+
+	/* search for element in bucket list */
+	ce = &h->tab[hashval & (h->tab_size - 1)];
+	while (*ce && !entry_matches(*ce, ident, hashval, len))
+		ce = &(*ce)->next;
 
-	/* if element is first element of bucket */
-	if (streq(ident, ce->ident, 255)) {
-		h->tab[hashval] = ce->next;
-		free_hashtab_entry(ce);
-		return;
-	}
-	
-	/* search for for element in bucket list */
-	while (ce->next && !streq(ident, ce->next->ident, 255)) {
-		ce = ce->next;
-	}
-	
-	re = ce->next;   /* element to remove */
-	
 	/* return if desired element is not in bucket list */
-	if (!re) return;
+	if (!(re = *ce)) return;
 
-	/* unchain element */
-	ce->next = re->next;
-	
-	/* deallocate and zero element */
+	/* unchain and deallocate element */
+	if (h->cursor == re) h->cursor = NULL;
+	*ce = re->next;
 	free_hashtab_entry(re);
+	h->num_elem--;
 }
 
 
@@ -193,17 +266,34 @@ static void hashtab_remove_elem(HASHTAB *h, char const *ident)
  */
 static void hashtab_add_elem(HASHTAB *h, char const *ident, void *value)
 {
-	u32 hashval;
+	u32 hashval, len;
 	struct hashtab_entry *ne;
+	char *ne_ident;
 
-	if (!h) return;
-	if (hashtab_get_elem(h, ident, 255)) hashtab_remove_elem(h, ident);
-	hashval = hash_value(ident, h->max_hash_length) % (h->tab_size);
-	ne = (struct hashtab_entry *)zalloc(sizeof(struct hashtab_entry));
-	ne->ident = strdup(ident);
-	ne->value = value;
-	ne->next  = h->tab[hashval];
-	h->tab[hashval] = ne;
+	if (!h || !ident) return;
+	hashtab_remove_elem(h, ident);
+
+	if (h->num_elem >= h->tab_size*MAX_LOAD) grow(h);
+
+	hashval = hash_value(ident, ~0U, &len);
+	ne = (struct hashtab_entry *)zalloc(sizeof(struct hashtab_entry) + len + 1);
+	if (!ne) {
+		ERROR(printf("HashTable(add_elem): out of memory!\n");)
+		return;
+	}
+
+	/* store copy of the identifier right after the entry */
+	ne_ident = (char *)((adr)ne + sizeof(struct hashtab_entry));
+	memcpy(ne_ident, ident, len);
+	ne_ident[len] = 0;
+
+	ne->ident     = ne_ident;
+	ne->ident_len = len;
+	ne->hashval   = hashval;
+	ne->value     = value;
+	ne->next      = h->tab[hashval & (h->tab_size - 1)];
+	h->tab[hashval & (h->tab_size - 1)] = ne;
+	h->num_elem++;
 }
 
 
@@ -218,7 +308,7 @@ void hashtab_print_info(HASHTAB *h)
 		return;
 	}
 	printf(" tab_size=%d\n", (int)h->tab_size);
-	printf(" max_hash_length=%d\n", (int)h->max_hash_length);
+	printf(" num_elem=%d\n", (int)h->num_elem);
 	for (unsigned i = 0; i < h->tab_size; i++) {
 		printf(" hash #%d: ", i);
 		e = h->tab[i];
@@ -239,8 +329,13 @@ void hashtab_print_info(HASHTAB *h)
  */
 static void *hashtab_get_first(HASHTAB *h)
 {
+	if (!h) return NULL;
 	for (unsigned i = 0; i < h->tab_size; i++) {
-		if (h->tab[i]) return h->tab[i]->value;
+		if (h->tab[i]) {
+			h->cursor     = h->tab[i];
+			h->cursor_idx = i;
+			return h->cursor->value;
+		}
 	}
 	return NULL;
 }
@@ -248,6 +343,10 @@ static void *hashtab_get_first(HASHTAB *h)
 
 /**
  * Returns successor of a given hash table entry
+ *
+ * When iterating via get_first and get_next, the position of the previously
+ * returned entry is remembered so that the search for the value can be
+ * skipped.
  */
 static void *hashtab_get_next(HASHTAB *h, void *value)
 {
@@ -255,21 +354,38 @@ static void *hashtab_get_next(HASHTAB *h, void *value)
 
 	unsigned i = 0;
 
-	/* find first occurence of value in hash table lists */
-	for (; i < h->tab_size; i++) {
-		e = h->tab[i];
-		while (e && (e->value != value)) e = e->next;
-		if (e && (e->value == value)) break;
+	if (!h) return NULL;
+
+	if (h->cursor && h->cursor->value == value) {
+		e = h->cursor;
+		i = h->cursor_idx;
+	} else {
+
+		/* find first occurence of value in hash table lists */
+		for (; i < h->tab_size; i++) {
+			e = h->tab[i];
+			while (e && (e->value != value)) e = e->next;
+			if (e && (e->value == value)) break;
+		}
 	}
 
+	h->cursor = NULL;
 	if (!e || (i == h->tab_size)) return NULL;
 
 	/* is the next element in current hash list? */
-	if (e->next) return e->next->value;
+	if (e->next) {
+		h->cursor     = e->next;
+		h->cursor_idx = i;
+		return e->next->value;
+	}
 
 	/* otherwise take first element of next hash list */
 	for (i++; i < h->tab_size; i++) {
-		if (h->tab[i]) return h->tab[i]->value;
+		if (h->tab[i]) {
+			h->cursor     = h->tab[i];
+			h->cursor_idx = i;
+			return h->tab[i]->value;
+		}
 	}
 	return NULL;
 }
@@ -19,7 +19,15 @@
 struct hashtab;
 
 struct hashtab_services {
-	HASHTAB *(*create)      (u32 tab_size, u32 max_hash_length);
+
+	/**
+	 * Create hash table
+	 *
+	 * \param tab_size  initial number of buckets, the table grows
+	 *                  automatically with the number of elements
+	 */
+	HASHTAB *(*create)      (u32 tab_size);
+
 	void     (*inc_ref)     (HASHTAB *h);
 	void     (*dec_ref)     (HASHTAB *h);
 	void     (*add_elem)    (HASHTAB *h, char const *ident, void *value);
@@ -73,15 +73,21 @@ extern int init_scale            (struct dope_services *);
 extern int init_scrollbar        (struct dope_services *);
 extern int init_frame            (struct dope_services *);
 extern int init_grid             (struct dope_services *);
+extern int init_table            (struct dope_services *);
+extern int init_textview         (struct dope_services *);
+extern int init_plot             (struct dope_services *);
 extern int init_redraw           (struct dope_services *);
 extern int init_simple_scheduler (struct dope_services *);
 extern int init_hashtable        (struct dope_services *);
+extern int init_symtab           (struct dope_services *);
 extern int init_tokenizer        (struct dope_services *);
 extern int init_scope            (struct dope_services *);
 extern int init_script           (struct dope_services *);
 extern int init_appman           (struct dope_services *);
 extern int init_winlayout        (struct dope_services *);
 extern int init_messenger        (struct dope_services *);
+extern int init_watch            (struct dope_services *);
+extern int init_layout           (struct dope_services *);
 extern int init_vscreen          (struct dope_services *);
 extern int init_vtextscreen      (struct dope_services *);
 extern int init_sharedmem        (struct dope_services *);
@@ -113,14 +119,14 @@ long dope_init()
 	init_sharedmem(&dope);
 	init_timer(&dope);
 	init_tick(&dope);
-	init_relax(&dope);
 	init_keymap(&dope);
 	init_cache(&dope);
 	init_hashtable(&dope);
+	init_symtab(&dope);
 	init_appman(&dope);
 	init_tokenizer(&dope);
-	init_messenger(&dope);
 	init_script(&dope);
+	init_messenger(&dope);
 	init_clipping(&dope);
 	init_scrdrv(&dope);
 	init_input(&dope);
@@ -133,7 +139,10 @@ long dope_init()
 	init_gfximg32(&dope);
 	init_gfx(&dope);
 	init_redraw(&dope);
+	init_relax(&dope);
+	init_watch(&dope);
 	init_userstate(&dope);
+	init_layout(&dope);
 	init_widman(&dope);
 	init_scope(&dope);
 	init_button(&dope);
@@ -145,6 +154,9 @@ long dope_init()
 	init_scrollbar(&dope);
 	init_scale(&dope);
 	init_frame(&dope);
+	init_table(&dope);
+	init_textview(&dope);
+	init_plot(&dope);
 	init_container(&dope);
 	init_grid(&dope);
 	init_winlayout(&dope);
@@ -16,10 +16,16 @@
 #include <input_session/input_session.h>
 #include <input/event.h>
 #include <base/env.h>
+#include <base/signal.h>
+#include <timer_session/connection.h>
+#include <report_session/connection.h>
+#include <os/attached_rom_dataspace.h>
+#include <os/config.h>
 
 /* local includes */
 #include "dopestd.h"
 #include "event.h"
+#include "timer.h"
 #include "input.h"
 
 
@@ -29,6 +35,49 @@ static int curr_ev, num_ev;            /* current and maximum event index */
 extern Input::Session *input_session;  /* initialized by scrdrv.cc  */
 static Input::Event *ev_buf;           /* Genode input event buffer */
 
+/*
+ * Signals that end a blocking 'wait'. The timer is used for timeouts only,
+ * it is separate from the timer of the timer module.
+ */
+static Genode::Signal_receiver           *sig_rec;
+static Genode::Signal_context_capability  wakeup_sig;
+static Timer::Session                    *timeout_timer;
+
+static struct timer_services *timer;
+
+/*
+ * Recorded input
+ *
+ * A recording consists of the 'RECORD_MAGIC' value followed by one
+ * 'input_record' per event. Recordings are delivered as report and
+ * replayed from a ROM module. The report is submitted at most once per
+ * 'RECORD_SUBMIT_USEC' while events are recorded.
+ */
+enum {
+	RECORD_MAGIC       = 0x49706f44,   /* "DopI" in little-endian byte order */
+	RECORD_BUF_SIZE    = 1024*1024,    /* size of report buffer              */
+	RECORD_SUBMIT_USEC = 1000*1000,    /* interval of report submissions     */
+};
+
+struct input_record {
+	u32 delta_usec;                 /* time since the previous event */
+	s16 type;                       /* DOpE event type               */
+	s16 code;                       /* key/button code               */
+	s16 abs_x, abs_y;               /* absolute mouse position       */
+};
+
+static Report::Connection *record_report;
+static char *record_buf;            /* report buffer, 0 if not recording     */
+static u32   record_len;            /* number of bytes recorded              */
+static int   record_dirty;          /* events recorded since last submission */
+static u32   record_time;           /* time of last recorded event           */
+static u32   record_submitted;      /* time of last submission               */
+
+static struct input_record const *replay_curr;  /* next record to replay    */
+static struct input_record const *replay_end;   /* end of recording         */
+static u32   replay_due;            /* time when 'replay_curr' is due        */
+static long  replay_speed = 1;      /* speedup factor of the replay          */
+
 int init_input(struct dope_services *d);
 
 
@@ -50,6 +99,60 @@ static inline void assign_event(EVENT *e, int type, int code, int ax, int ay)
 }
 
 
+/**
+ * Publish recorded events
+ */
+static void submit_recording(void)
+{
+	record_report->submit(record_len);
+	record_dirty     = 0;
+	record_submitted = timer->get_time();
+}
+
+
+/**
+ * Return time until recorded events are due for submission
+ *
+ * \return  microseconds or -1 if there are no unsubmitted events
+ */
+static s32 record_submit_due(void)
+{
+	if (!record_dirty) return -1;
+
+	u32 elapsed = timer->get_diff(record_submitted, timer->get_time());
+	return elapsed < RECORD_SUBMIT_USEC ? RECORD_SUBMIT_USEC - elapsed : 0;
+}
+
+
+/**
+ * Append event to recording
+ */
+static void record_event(EVENT *e)
+{
+	struct input_record *r;
+	u32 now = timer->get_time();
+
+	/* stop recording when the report buffer is exhausted */
+	if (record_len + sizeof(*r) > RECORD_BUF_SIZE) {
+		ERROR(printf("Input(record_event): buffer exhausted, recording stopped\n");)
+		submit_recording();
+		record_buf = 0;
+		return;
+	}
+
+	r = (struct input_record *)(record_buf + record_len);
+	r->delta_usec = now - record_time;
+	r->type       = e->type;
+	r->code       = e->code;
+	r->abs_x      = e->abs_x;
+	r->abs_y      = e->abs_y;
+
+	record_time   = now;
+	record_len   += sizeof(*r);
+	record_dirty  = 1;
+}
+
+
 /***********************
  ** Service functions **
  ***********************/
@@ -69,8 +172,13 @@ static int get_event(EVENT *e) {
 	}
 
 	/* return if there is still no event in event queue */
-	if (curr_ev == num_ev)
+	if (curr_ev == num_ev) {
+
+		/* publish recorded events periodically once the input is drained */
+		if (record_submit_due() == 0)
+			submit_recording();
 		return 0;
+	}
 
 	Input::Event *ev = &ev_buf[curr_ev];
 
@@ -90,20 +198,101 @@ static int get_event(EVENT *e) {
 		break;
 
 	default:
-		break;
+		curr_ev++;
+		return 1;
 	}
 
+	if (record_buf) record_event(e);
+
 	curr_ev++;
 	return 1;
 }
 
 
+/**
+ * Block until input is available, the timeout expired, or a wakeup occurred
+ */
+static void wait(s32 timeout_usec)
+{
+	s32 submit_usec;
+
+	/* there are buffered events or events that are not fetched yet */
+	if (curr_ev < num_ev || input_session->is_pending() || timeout_usec == 0)
+		return;
+
+	/* wake up for the submission of recorded events */
+	submit_usec = record_submit_due();
+	if (submit_usec >= 0 && (timeout_usec < 0 || submit_usec < timeout_usec))
+		timeout_usec = MAX(submit_usec, 1);
+
+	if (timeout_usec > 0)
+		timeout_timer->trigger_once(timeout_usec);
+
+	sig_rec->wait_for_signal();
+}
+
+
+static void wakeup(void)
+{
+	Genode::Signal_transmitter(wakeup_sig).submit();
+}
+
+
+/**
+ * Get next event of a recording once it is due
+ */
+static int replay_get_event(EVENT *e)
+{
+	if (replay_curr == replay_end
+	 || (s32)(timer->get_time() - replay_due) < 0)
+		return 0;
+
+	assign_event(e, replay_curr->type, replay_curr->code,
+	                replay_curr->abs_x, replay_curr->abs_y);
+
+	if (++replay_curr < replay_end)
+		replay_due += replay_curr->delta_usec / replay_speed;
+
+	return 1;
+}
+
+
+/**
+ * Block until the next recorded event is due or the timeout expired
+ */
+static void replay_wait(s32 timeout_usec)
+{
+	if (timeout_usec == 0) return;
+
+	if (replay_curr < replay_end) {
+		s32 due_usec = replay_due - timer->get_time();
+		if (due_usec <= 0) return;
+		if (timeout_usec < 0 || due_usec < timeout_usec)
+			timeout_usec = due_usec;
+	}
+
+	if (timeout_usec > 0)
+		timeout_timer->trigger_once(timeout_usec);
+
+	sig_rec->wait_for_signal();
+}
+
+
 /**************************************
  ** Service structure of this module **
  **************************************/
 
 static struct input_services input = {
 	get_event,
+	wait,
+	wakeup,
+};
+
+
+static struct input_services replay = {
+	replay_get_event,
+	replay_wait,
+	wakeup,
 };
 
 
@@ -111,13 +300,118 @@ static struct input_services input = {
  ** Module entry point **
  ************************/
 
+/**
+ * Start recording of input events
+ */
+static void start_recording(void)
+{
+	using namespace Genode;
+
+	static Report::Connection report("input", RECORD_BUF_SIZE);
+	record_report = &report;
+	record_buf    = (char *)env()->rm_session()->attach(report.dataspace());
+
+	*(u32 *)record_buf = RECORD_MAGIC;
+	record_len       = sizeof(u32);
+	record_time      = timer->get_time();
+	record_submitted = record_time;
+}
+
+
+/**
+ * Open recording to replay
+ *
+ * \return  0 if the ROM module does not contain a valid recording
+ */
+static int start_replay(char const *rom_name)
+{
+	using namespace Genode;
+
+	static Attached_rom_dataspace rom(rom_name);
+	u32 const *magic = rom.local_addr<u32>();
+
+	if (rom.size() < sizeof(u32) || *magic != RECORD_MAGIC) return 0;
+
+	replay_curr = (struct input_record const *)(magic + 1);
+	replay_end  = replay_curr + (rom.size() - sizeof(u32))/sizeof(struct input_record);
+
+	if (replay_curr < replay_end)
+		replay_due = timer->get_time() + replay_curr->delta_usec/replay_speed;
+	return 1;
+}
+
+
+/**
+ * Evaluate input configuration
+ *
+ * '<input record="yes"/>' reports all input events as "input" report.
+ * '<input replay="rom" speed="2"/>' replaces the user input by the events
+ * recorded in the specified ROM module, replayed at twice the speed.
+ *
+ * \return  1 if input is replayed from a recording
+ */
+static int config_input(void)
+{
+	using namespace Genode;
+
+	char rom_name[64];
+	Xml_node node = config()->xml_node();
+
+	try { node = node.sub_node("input"); }
+	catch (Xml_node::Nonexistent_sub_node) { return 0; }
+
+	try {
+		if (node.attribute("record").has_value("yes"))
+			start_recording();
+	} catch (Xml_node::Nonexistent_attribute) { }
+
+	try {
+		node.attribute("speed").value(&replay_speed);
+		if (replay_speed < 1) replay_speed = 1;
+	} catch (Xml_node::Nonexistent_attribute) { }
+
+	try {
+		node.attribute("replay").value(rom_name, sizeof(rom_name));
+	} catch (Xml_node::Nonexistent_attribute) { return 0; }
+
+	try {
+		if (start_replay(rom_name)) return 1;
+		ERROR(printf("Input(config_input): %s is no input recording\n", rom_name);)
+	} catch (...) {
+		ERROR(printf("Input(config_input): could not open %s\n", rom_name);)
+	}
+	return 0;
+}
+
+
 int init_input(struct dope_services *d)
 {
 	using namespace Genode;
 
+	timer = (timer_services *)d->get_module("Timer 1.0");
+
 	void *addr = env()->rm_session()->attach(input_session->dataspace());
 	ev_buf = (Input::Event *)addr;
 
+	static Signal_receiver   rec;
+	static Signal_context    input_ctx, timeout_ctx, wakeup_ctx;
+	static Timer::Connection timeout;
+
+	sig_rec       = &rec;
+	timeout_timer = &timeout;
+	wakeup_sig    = rec.manage(&wakeup_ctx);
+
+	timeout.sigh(rec.manage(&timeout_ctx));
+
+	try {
+		if (config_input()) {
+			d->register_module("Input 1.0", &replay);
+			return 1;
+		}
+	} catch (...) { }
+
+	input_session->sigh(rec.manage(&input_ctx));
+
 	d->register_module("Input 1.0",&input);
 	return 1;
 }
@@ -20,6 +20,21 @@
 
 struct input_services {
 	int     (*get_event)    (EVENT *e);
+
+	/**
+	 * Block until input is available
+	 *
+	 * \param timeout_usec  maximum time to block in microseconds,
+	 *                      a negative value blocks without timeout
+	 *
+	 * The function may return early, for example if 'wakeup' was called.
+	 */
+	void    (*wait)         (s32 timeout_usec);
+
+	/**
+	 * Wake up a thread that blocks in 'wait'
+	 */
+	void    (*wakeup)       (void);
 };
 
 
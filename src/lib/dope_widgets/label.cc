@@ -32,6 +32,7 @@ static struct script_services  *script;
 
 struct label_data {
 	char const *text;
+	struct text_layout *layout;   /* cached layout of text */
 	s16         font_id;
 	s16         tx, ty;       /* text position inside the label cell */
 	s16         pad_x, pad_y;
@@ -47,10 +48,27 @@ int init_label(struct dope_services *d);
  ** Functions for internal use **
  ********************************/
 
+/**
+ * Replace cached layout after a change of the text or font
+ */
+static void update_layout(LABEL *l)
+{
+	font->release_layout(l->ld->layout);
+	l->ld->layout = font->get_layout(l->ld->font_id, l->ld->text);
+}
+
+
+static inline s32 text_width(LABEL *l)
+{
+	if (l->ld->layout) return l->ld->layout->width;
+	return font->calc_str_width(l->ld->font_id, l->ld->text);
+}
+
+
 static void update_text_pos(LABEL *l)
 {
 	if (!l->ld->text) return;
-	l->ld->tx = (l->wd->w - font->calc_str_width (l->ld->font_id, l->ld->text))>>1;
+	l->ld->tx = (l->wd->w - text_width(l))>>1;
 	l->ld->ty = (l->wd->h - font->calc_str_height(l->ld->font_id, l->ld->text))>>1;
 }
 
@@ -68,7 +86,13 @@ static int lab_draw(LABEL *l, struct gfx_ds *ds, long x, long y, WIDGET *origin)
 	if (origin) return 0;
 
 	gfx->push_clipping(ds, x + l->wd->x, y + l->wd->y, l->wd->w, l->wd->h);
-	if (l->ld->text) {
+	if (l->ld->layout) {
+		struct text_layout *lay = l->ld->layout;
+
+		/* skip characters left of the clipping area */
+		s32 i = font->layout_char_at(lay, gfx->get_clip_x(ds) - tx);
+		gfx->draw_string(ds, tx + lay->offsets[i], ty, BLACK_SOLID, 0, l->ld->font_id, lay->str + i);
+	} else if (l->ld->text) {
 		gfx->draw_string(ds, tx, ty, BLACK_SOLID, 0, l->ld->font_id, l->ld->text);
 	}
 	gfx->pop_clipping(ds);
@@ -83,8 +107,7 @@ static int lab_draw(LABEL *l, struct gfx_ds *ds, long x, long y, WIDGET *origin)
 static void lab_calc_minmax(LABEL *l)
 {
 	if (l->ld->text) {
-		l->wd->min_w = l->wd->max_w = font->calc_str_width (l->ld->font_id, l->ld->text)
-		                            + l->ld->pad_x * 2;
+		l->wd->min_w = l->wd->max_w = text_width(l) + l->ld->pad_x * 2;
 		l->wd->min_h = l->wd->max_h = font->calc_str_height(l->ld->font_id, l->ld->text)
 		                            + l->ld->pad_y * 2;
 	} else {
@@ -108,6 +131,7 @@ static void lab_updatepos(LABEL *l)
 static void lab_free_data(LABEL *l)
 {
 	if (l->ld->text) free(l->ld->text);
+	font->release_layout(l->ld->layout);
 }
 
 
@@ -129,6 +153,7 @@ static void lab_set_text(LABEL *l, char const *new_txt)
 	if ((!l) || (!l->ld)) return;
 	if (l->ld->text) free(l->ld->text);
 	l->ld->text = strdup(new_txt);
+	update_layout(l);
 	l->wd->update |= WID_UPDATE_MINMAX;
 }
 
@@ -142,16 +167,14 @@ static char const *lab_get_text(LABEL *l)
 /**
  * Set font of label
  *
- * Currently, only the font identifiers 'default' and
- * 'monospaced' are defined.
+ * Besides the built-in fonts 'default', 'monospaced', and 'title', a
+ * font can be loaded from the ROM module of the specified name.
  */
 static void lab_set_font(LABEL *l, char const *fontname)
 {
-	if (streq(fontname, "default", 255)) {
-		l->ld->font_id = 0;
-	} else if (streq(fontname, "monospaced", 255)) {
-		l->ld->font_id = 1;
-	}
+	s32 font_id = font->lookup(fontname);
+	if (font_id >= 0) l->ld->font_id = font_id;
+	update_layout(l);
 	l->wd->update |= WID_UPDATE_MINMAX;
 }
 
@@ -161,10 +184,8 @@ static void lab_set_font(LABEL *l, char const *fontname)
  */
 static char const *lab_get_font(LABEL *l)
 {
-	switch (l->ld->font_id) {
-		case 1:  return "monospaced";
-		default: return "default";
-	}
+	struct font *f = font->get_by_id(l->ld->font_id);
+	return f ? f->name : "";
 }
 
 
@@ -233,6 +254,7 @@ static LABEL *create(void)
 	/* set label specific attributes */
 	label->ld->pad_x = label->ld->pad_y = 2;
 	label->ld->text  = strdup("");
+	update_layout(label);
 	update_text_pos(label);
 	gen_methods.update(label);
 
@@ -0,0 +1,213 @@
+/*
+ * \brief   DOpE layout module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * Attribute changes of widgets do not propagate to their parents right
+ * away. Instead, the widgets are queued and the layout of the affected
+ * parents is updated in a single pass before the next redraw requests
+ * are executed. Because the most deeply nested widgets are processed
+ * first, a parent with many changed children relayouts only once.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+struct private_widget;
+#define WIDGET struct private_widget
+
+#include "dopestd.h"
+#include "widget_data.h"
+#include "widget.h"
+#include "layout.h"
+
+WIDGET {
+	struct widget_methods *gen;
+	void                  *widget_specific_methods;
+	struct widget_data    *wd;
+};
+
+enum {
+	MIN_HEAP_SIZE = 64,
+	REQ_PARENT    = 0,   /* parent must adapt to changed child */
+	REQ_UPDATE    = 1,   /* widget must be updated             */
+};
+
+struct request {
+	WIDGET *w;      /* widget, referenced while queued */
+	s32     depth;  /* nesting level of widget         */
+	s32     type;   /* REQ_PARENT or REQ_UPDATE        */
+};
+
+/*
+ * Requests are kept in a binary max-heap ordered by the nesting level of
+ * their widgets. The most deeply nested widget is at 'heap[0]'.
+ */
+static struct request *heap;       /* request heap                  */
+static s32             heap_len;   /* number of queued requests     */
+static s32             heap_size;  /* capacity of heap array        */
+static int             flushing;   /* layout pass is in progress    */
+
+int init_layout(struct dope_services *d);
+
+
+/********************************
+ ** Functions for internal use **
+ ********************************/
+
+static void sift_up(s32 idx)
+{
+	struct request r = heap[idx];
+
+	for (; idx > 0 && heap[(idx - 1)/2].depth < r.depth; idx = (idx - 1)/2)
+		heap[idx] = heap[(idx - 1)/2];
+
+	heap[idx] = r;
+}
+
+
+static void sift_down(s32 idx)
+{
+	struct request r = heap[idx];
+	s32 child;
+
+	for (; (child = 2*idx + 1) < heap_len; idx = child) {
+		if (child + 1 < heap_len && heap[child + 1].depth > heap[child].depth)
+			child++;
+		if (heap[child].depth <= r.depth) break;
+		heap[idx] = heap[child];
+	}
+
+	heap[idx] = r;
+}
+
+
+/**
+ * Determine nesting level of widget
+ */
+static s32 depth_of(WIDGET *w)
+{
+	s32 depth = 0;
+	while ((w = (WIDGET *)w->gen->get_parent(w))) depth++;
+	return depth;
+}
+
+
+/**
+ * Queue request
+ *
+ * \return  0 if the heap could not be enlarged
+ */
+static int queue_request(WIDGET *w, s32 type)
+{
+	if (heap_len == heap_size) {
+		s32 new_size = heap_size ? 2*heap_size : MIN_HEAP_SIZE;
+		struct request *new_heap = (struct request *)malloc(new_size*sizeof(struct request));
+		if (!new_heap) return 0;
+
+		if (heap) {
+			memcpy(new_heap, heap, heap_len*sizeof(struct request));
+			free(heap);
+		}
+		heap      = new_heap;
+		heap_size = new_size;
+	}
+
+	w->gen->inc_ref(w);
+	heap[heap_len].w     = w;
+	heap[heap_len].depth = depth_of(w);
+	heap[heap_len].type  = type;
+	sift_up(heap_len++);
+	return 1;
+}
+
+
+/**
+ * Call 'do_layout' function of the widget's parent
+ */
+static void layout_parent(WIDGET *child)
+{
+	WIDGET *parent = (WIDGET *)child->gen->get_parent(child);
+	if (parent) parent->gen->do_layout(parent, child);
+}
+
+
+/***********************
+ ** Service functions **
+ ***********************/
+
+static void layout_update_parent(WIDGET *child)
+{
+	if (!queue_request(child, REQ_PARENT))
+		layout_parent(child);
+}
+
+
+static void layout_update(WIDGET *w)
+{
+	if (w->wd->update & WID_UPDATE_LAYOUT) return;
+
+	if (!queue_request(w, REQ_UPDATE)) {
+		w->gen->update(w);
+		return;
+	}
+	w->wd->update |= WID_UPDATE_LAYOUT;
+}
+
+
+static void layout_flush(void)
+{
+	if (flushing) return;
+	flushing = 1;
+
+	while (heap_len) {
+		struct request r = heap[0];
+
+		if (--heap_len) {
+			heap[0] = heap[heap_len];
+			sift_down(0);
+		}
+
+		if (r.type == REQ_PARENT)
+			layout_parent(r.w);
+
+		/*
+		 * Skip the request if the widget got updated in the meantime, for
+		 * example by a previous request for the same widget.
+		 */
+		else if (r.w->wd->update & WID_UPDATE_LAYOUT) {
+			r.w->wd->update &= ~WID_UPDATE_LAYOUT;
+			r.w->gen->update(r.w);
+		}
+
+		r.w->gen->dec_ref(r.w);
+	}
+
+	flushing = 0;
+}
+
+
+/**************************************
+ ** Service structure of this module **
+ **************************************/
+
+static struct layout_services services = {
+	layout_update_parent,
+	layout_update,
+	layout_flush,
+};
+
+
+/************************
+ ** Module entry point **
+ ************************/
+
+int init_layout(struct dope_services *d)
+{
+	d->register_module("Layout 1.0", &services);
+	return 1;
+}
@@ -0,0 +1,48 @@
+/*
+ * \brief   Interface of layout module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _DOPE_LAYOUT_H_
+#define _DOPE_LAYOUT_H_
+
+#include "widget.h"
+
+struct layout_services {
+
+	/**
+	 * Let the parent of a widget adapt its layout to the widget
+	 *
+	 * Must be called when the min/max size of the widget changed. The
+	 * 'do_layout' function of the parent is called during the next
+	 * layout pass.
+	 */
+	void (*update_parent) (WIDGET *child);
+
+	/**
+	 * Update widget during the next layout pass
+	 *
+	 * The widget's update flags must be set by the caller. Multiple
+	 * requests for the same widget result in a single update.
+	 */
+	void (*update) (WIDGET *w);
+
+	/**
+	 * Execute layout pass
+	 *
+	 * Pending requests are processed with the most deeply nested widgets
+	 * first. So a parent adapts to all of its changed children at once.
+	 * The caller must hold the widget-tree lock.
+	 */
+	void (*flush) (void);
+};
+
+#endif /* _DOPE_LAYOUT_H_ */
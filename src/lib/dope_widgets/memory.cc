@@ -14,11 +14,17 @@
  * the terms of the GNU General Public Licence 2.
  */
 
+/* Genode includes */
+#include <base/lock.h>
+
 /* local includes */
 #include "dopestd.h"
 
 static char heap[4000*1000];
 
+/* client threads may allocate concurrently, e.g., while executing commands */
+static Genode::Lock heap_lock;
+
 struct memblock;
 struct memblock {
 	long    size;
@@ -61,6 +67,8 @@ void free(void const *adr)
 
 	blk = (struct memblock *)((long)adr - 8);
 
+	Genode::Lock::Guard guard(heap_lock);
+
 	/* search previous block */
 	prevblk = firstmemblock;
 	while ((prevblk != NULL) && (prevblk->next != blk)) {
@@ -89,6 +97,8 @@ void *malloc(unsigned int blocksize)
 	blocksize += 4;
 	blocksize &= 0xfffffffc;
 
+	Genode::Lock::Guard guard(heap_lock);
+
 	blk = firstmemblock;
 	minblk = (memblock *)-1;
 
@@ -2,6 +2,14 @@
  * \brief   DOpE messenger module
  * \date    2004-05-31
  * \author  Norman Feske
+ *
+ * Events are not delivered to the application right away. Each application
+ * has an event queue, which is drained by the thread that calls
+ * 'dope_process_event'.
+ *
+ * Bindings may carry delivery options, which are evaluated before an event
+ * enters the queue. Thereby, high-frequency events such as motion or
+ * slider changes can be thinned out without waking up the application.
  */
 
 /*
@@ -17,7 +25,69 @@
 /* local includes */
 #include "dopestd.h"
 #include "event.h"
+#include "widget.h"
+#include "widget_data.h"
 #include "messenger.h"
+#include "appman.h"
+#include "script.h"
+#include "timer.h"
+#include "tick.h"
+
+static struct script_services *script;
+static struct timer_services  *timer;
+static struct tick_services   *tick;
+
+enum {
+	MIN_QUEUE_SIZE = 32,    /* initial capacity of an event queue      */
+	MAX_QUEUE_SIZE = 4096,  /* events beyond this limit get dropped    */
+	MAX_ATTR_LEN   = 64,    /* max length of compared attribute values */
+};
+
+struct bind_cond;
+struct bind_cond {
+	char const       *name;       /* attribute name                   */
+	char const       *value;      /* expected textual attribute value */
+	struct bind_cond *next;
+};
+
+struct bind_filter {
+
+	/* delivery options */
+	struct bind_cond *conds;      /* attribute conditions             */
+	long              min_dist;   /* minimum motion distance          */
+	u32               min_usec;   /* minimum time between motion      */
+	int               coalesce;   /* replace pending equal events     */
+
+	/* delivery state */
+	int               delivered;  /* motion was delivered before      */
+	u32               last_time;  /* time of last delivered motion    */
+	long              acc_x;      /* motion held back by 'min_dist'   */
+	long              acc_y;
+	struct tick      *tick;       /* pending delivery of held motion  */
+	s32               held_app;   /* receiver of held motion          */
+	struct binding const *held_b; /* binding of held motion           */
+	Event_union       held_ev;    /* latest motion held back by rate  */
+};
+
+struct queued_event {
+	u32                   seq;             /* global sequence number   */
+	struct binding const *b;               /* originating binding      */
+	void                (*callback) (Event_union *, void *);
+	void                 *arg;             /* argument of callback     */
+	Event_union           ev;              /* event data               */
+};
+
+struct event_queue {
+	struct queued_event *buf;              /* ring buffer              */
+	int                  size;             /* capacity of ring buffer  */
+	int                  head;             /* index of oldest event    */
+	int                  num;              /* number of queued events  */
+	int                  dropped;          /* events dropped since the
+	                                          queue was drained last   */
+};
+
+static struct event_queue queues[MAX_APPS];
+static u32                next_seq;        /* sequence number of next event */
 
 int init_messenger(struct dope_services *d);
 
@@ -26,16 +96,257 @@ int init_messenger(struct dope_services *d);
  ** Functions for internal use **
  ********************************/
 
-static unsigned long hex2u32(const char *s)
+/**
+ * Append event to the event queue of an application
+ *
+ * The ring buffer is doubled in size when it becomes exhausted. Once it
+ * cannot grow anymore, events are dropped. Only the first dropped event is
+ * reported, the number of dropped events is reported when the queue drains.
+ */
+static void enqueue(s32 app_id, struct binding const *b, Event_union *ev)
+{
+	struct event_queue *q;
+	struct queued_event *qe;
+
+	if (app_id < 0 || app_id >= MAX_APPS || !b->callback) return;
+	q = &queues[app_id];
+
+	if (q->num == q->size) {
+		int new_size = q->size ? q->size*2 : MIN_QUEUE_SIZE;
+		struct queued_event *new_buf;
+
+		if (new_size > MAX_QUEUE_SIZE
+		 || !(new_buf = (struct queued_event *)malloc(new_size*sizeof(*new_buf)))) {
+			if (!q->dropped++)
+				ERROR(printf("Messenger(enqueue): event queue of app %d overflows\n", (int)app_id);)
+			return;
+		}
+
+		/* unroll ring buffer into the new buffer */
+		for (int i = 0; i < q->num; i++)
+			new_buf[i] = q->buf[(q->head + i) % q->size];
+
+		free(q->buf);
+		q->buf  = new_buf;
+		q->size = new_size;
+		q->head = 0;
+	}
+
+	qe = &q->buf[(q->head + q->num) % q->size];
+	qe->seq      = next_seq++;
+	qe->b        = b;
+	qe->callback = b->callback;
+	qe->arg      = b->arg;
+	qe->ev       = *ev;
+	q->num++;
+}
+
+
+/**
+ * Merge motion event into an older motion event that was not delivered
+ */
+static inline void merge_motion(Event_union *dst, Event_union const *ev)
+{
+	dst->motion.rel_x += ev->motion.rel_x;
+	dst->motion.rel_y += ev->motion.rel_y;
+	dst->motion.abs_x  = ev->motion.abs_x;
+	dst->motion.abs_y  = ev->motion.abs_y;
+}
+
+
+/**
+ * Replace pending event of the same binding and type by a new one
+ *
+ * \return  1 if a pending event was replaced
+ */
+static int coalesce(s32 app_id, struct binding const *b, Event_union *ev)
+{
+	struct event_queue *q;
+
+	if (app_id < 0 || app_id >= MAX_APPS) return 0;
+	q = &queues[app_id];
+
+	for (int i = q->num - 1; i >= 0; i--) {
+		struct queued_event *qe = &q->buf[(q->head + i) % q->size];
+
+		if (qe->b != b || qe->callback != b->callback || qe->arg != b->arg
+		 || qe->ev.type != ev->type) continue;
+
+		if (ev->type == EVENT_TYPE_COMMAND
+		 && !streq(qe->ev.command.cmd, ev->command.cmd, 256)) continue;
+
+		if (ev->type == EVENT_TYPE_MOTION)
+			merge_motion(&qe->ev, ev);
+		else
+			qe->ev = *ev;
+		return 1;
+	}
+	return 0;
+}
+
+
+/**
+ * Check attribute conditions of binding
+ */
+static int conds_match(struct bind_filter *f, WIDGET *w)
+{
+	char value[MAX_ATTR_LEN];
+
+	for (struct bind_cond *c = f->conds; c; c = c->next) {
+		if (!w || script->get_attrib(w, c->name, value, sizeof(value)) < 0)
+			return 0;
+		if (!streq(value, c->value, MAX_ATTR_LEN))
+			return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Tick callback that delivers the motion held back by the rate limit
+ */
+static int deliver_held(void *arg)
+{
+	struct bind_filter *f = (struct bind_filter *)arg;
+
+	f->tick      = NULL;
+	f->last_time = timer->get_time();
+
+	if (!f->coalesce || !coalesce(f->held_app, f->held_b, &f->held_ev))
+		enqueue(f->held_app, f->held_b, &f->held_ev);
+	return 0;
+}
+
+
+/**
+ * Apply distance threshold and rate limit to motion event
+ *
+ * \return  1 if the event must not be queued now
+ */
+static int hold_motion(struct bind_filter *f, s32 app_id,
+                       struct binding const *b, Event_union *ev)
 {
-	int i;
-	unsigned long result=0;
-	for (i=0;i<8;i++,s++) {
-		if (!(*s)) return result;
-		result = result*16 + (*s & 0xf);
-		if (*s > '9') result += 9;
+	if (f->min_dist) {
+		f->acc_x += ev->motion.rel_x;
+		f->acc_y += ev->motion.rel_y;
+		if (f->acc_x*f->acc_x + f->acc_y*f->acc_y < f->min_dist*f->min_dist)
+			return 1;
+
+		ev->motion.rel_x = f->acc_x;
+		ev->motion.rel_y = f->acc_y;
+		f->acc_x = f->acc_y = 0;
+	}
+
+	if (!f->min_usec) return 0;
+
+	/* a delivery is already scheduled, just keep the latest motion */
+	if (f->tick) {
+		merge_motion(&f->held_ev, ev);
+		return 1;
+	}
+
+	u32 now     = timer->get_time();
+	u32 elapsed = timer->get_diff(f->last_time, now);
+
+	if (f->delivered && elapsed < f->min_usec) {
+		f->held_app = app_id;
+		f->held_b   = b;
+		f->held_ev  = *ev;
+		f->tick     = tick->add((f->min_usec - elapsed + 999)/1000, deliver_held, f);
+		if (f->tick) return 1;
 	}
-	return result;
+
+	f->delivered = 1;
+	f->last_time = now;
+	return 0;
+}
+
+
+/**
+ * Queue event unless the delivery options of the binding suppress it
+ */
+static void deliver(s32 app_id, struct binding const *b, Event_union *ev)
+{
+	struct bind_filter *f = b->filter;
+
+	if (f) {
+		if (!conds_match(f, b->widget)) return;
+
+		if (ev->type == EVENT_TYPE_MOTION && hold_motion(f, app_id, b, ev))
+			return;
+	}
+
+	/* only the newest row request is of interest to the client */
+	if (((f && f->coalesce) || ev->type == EVENT_TYPE_ROWS)
+	 && coalesce(app_id, b, ev)) return;
+
+	enqueue(app_id, b, ev);
+}
+
+
+/**
+ * Read next space-separated token
+ *
+ * \return  position after the token
+ */
+static char const *next_token(char const *s, char const **tok, int *len)
+{
+	while (*s == ' ') s++;
+	*tok = s;
+	for (*len = 0; s[*len] && s[*len] != ' '; (*len)++);
+	return s + *len;
+}
+
+
+/**
+ * Create attribute condition from a 'name=value' token
+ */
+static struct bind_cond *new_cond(char const *tok, int len)
+{
+	struct bind_cond *c;
+	char *name, *value;
+	int name_len;
+
+	for (name_len = 0; name_len < len && tok[name_len] != '='; name_len++);
+	if (name_len == 0 || name_len == len) return NULL;
+
+	/* store name and value right after the condition */
+	c = (struct bind_cond *)zalloc(sizeof(struct bind_cond) + len + 1);
+	if (!c) return NULL;
+
+	name  = (char *)((adr)c + sizeof(struct bind_cond));
+	value = name + name_len + 1;
+	memcpy(name, tok, len);
+	name[name_len] = 0;
+	name[len]      = 0;
+
+	c->name  = name;
+	c->value = value;
+	return c;
+}
+
+
+/**
+ * Determine application with the oldest pending event
+ *
+ * \return  application id or -1 if no event is pending
+ */
+static s32 oldest_app(void)
+{
+	s32 app = -1;
+	u32 min_age = 0;
+
+	for (s32 i = 0; i < MAX_APPS; i++) {
+		struct event_queue *q = &queues[i];
+		if (!q->num) continue;
+
+		u32 age = next_seq - q->buf[q->head].seq;
+		if (app < 0 || age > min_age) {
+			app     = i;
+			min_age = age;
+		}
+	}
+	return app;
 }
 
 
@@ -43,15 +354,10 @@ static unsigned long hex2u32(const char *s)
  ** Service functions **
  ***********************/
 
-static void send_input_event(s32 app_id, EVENT *e, char const *bindarg)
+static void send_input_event(s32 app_id, EVENT *e, struct binding const *b)
 {
-	void (*callback) (Event_union *, void *);
-	void *arg;
 	Event_union de;
 
-	callback = (void (*)(Event_union *,void*))hex2u32(bindarg);
-	arg = (void *)hex2u32(bindarg+10);
-
 	switch (e->type) {
 
 	case EVENT_MOUSE_ENTER:
@@ -90,22 +396,233 @@ static void send_input_event(s32 app_id, EVENT *e, char const *bindarg)
 	default:
 		return;
 	}
-	callback(&de, arg);
+	deliver(app_id, b, &de);
 }
 
 
-static void send_action_event(s32 app_id, char const *action, char const *bindarg)
+static void send_action_event(s32 app_id, char const *action, struct binding const *b)
 {
-	void (*callback) (Event_union *, void *);
-	void *arg;
 	Event_union de;
 
-	callback = (void (*)(Event_union *,void*))hex2u32(bindarg);
-	arg = (void *)hex2u32(bindarg+10);
-
 	de.type = EVENT_TYPE_COMMAND;
 	de.command.cmd = action;
-	callback(&de, arg);
+	deliver(app_id, b, &de);
+}
+
+
+static void send_event(s32 app_id, Event_union *ev, struct binding const *b)
+{
+	deliver(app_id, b, ev);
+}
+
+
+/**
+ * Drop queued events that originate from a binding
+ *
+ * The order of the remaining events is preserved.
+ */
+static void discard(s32 app_id, struct binding const *b)
+{
+	struct event_queue *q;
+	int num = 0;
+
+	if (app_id < 0 || app_id >= MAX_APPS) return;
+	q = &queues[app_id];
+
+	for (int i = 0; i < q->num; i++) {
+		struct queued_event *qe = &q->buf[(q->head + i) % q->size];
+		if (qe->b == b) continue;
+		q->buf[(q->head + num++) % q->size] = *qe;
+	}
+	q->num = num;
+}
+
+
+/**
+ * Create delivery options from their textual description
+ *
+ * \param options  space-separated list of '-rate <hz>', '-distance <pixels>',
+ *                 '-coalesce yes' and '-if <attribute>=<value>'
+ * \return         filter or NULL if no option was given
+ */
+static struct bind_filter *create_filter(char const *options)
+{
+	struct bind_filter *f;
+	char const *tok, *arg;
+	int len, arg_len;
+
+	if (!(f = (struct bind_filter *)zalloc(sizeof(struct bind_filter)))) {
+		ERROR(printf("Messenger(create_filter): out of memory!\n");)
+		return NULL;
+	}
+
+	for (;;) {
+		options = next_token(options, &tok, &len);
+		if (!len) break;
+		options = next_token(options, &arg, &arg_len);
+
+		if (streq(tok, "-rate", len)) {
+			long hz = atol(arg);
+			f->min_usec = hz > 0 ? 1000*1000/hz : 0;
+
+		} else if (streq(tok, "-distance", len)) {
+			f->min_dist = atol(arg);
+
+		} else if (streq(tok, "-coalesce", len)) {
+			f->coalesce = streq(arg, "yes", arg_len);
+
+		} else if (streq(tok, "-if", len)) {
+			struct bind_cond *c = new_cond(arg, arg_len);
+			if (!c) {
+				ERROR(printf("Messenger(create_filter): invalid condition\n");)
+				continue;
+			}
+			c->next  = f->conds;
+			f->conds = c;
+
+		} else {
+			ERROR(printf("Messenger(create_filter): unknown option\n");)
+		}
+	}
+
+	if (!f->conds && !f->min_dist && !f->min_usec && !f->coalesce) {
+		free(f);
+		return NULL;
+	}
+	return f;
+}
+
+
+/**
+ * Destroy delivery options, a held-back event is dropped
+ */
+static void free_filter(struct bind_filter *f)
+{
+	struct bind_cond *c, *next;
+
+	if (!f) return;
+	if (f->tick) tick->remove(f->tick);
+
+	for (c = f->conds; c; c = next) {
+		next = c->next;
+		free(c);
+	}
+	free(f);
+}
+
+
+/**
+ * Return number of queued events
+ *
+ * \param app_id  application id or a negative value for all applications
+ */
+static int pending(s32 app_id)
+{
+	int num = 0;
+
+	if (app_id >= MAX_APPS) return 0;
+	if (app_id >= 0) return queues[app_id].num;
+
+	for (int i = 0; i < MAX_APPS; i++)
+		num += queues[i].num;
+	return num;
+}
+
+
+/**
+ * Return length of string including the termination, 0 for NULL
+ */
+static inline size_t str_size(char const *s)
+{
+	return s ? strlen(s) + 1 : 0;
+}
+
+
+/**
+ * Copy string to 'dst' and advance 'dst'
+ */
+static inline char const *copy_str(char const *s, char **dst)
+{
+	size_t size = str_size(s);
+	char  *copy = *dst;
+
+	if (!s) return NULL;
+	memcpy(copy, s, size);
+	*dst += size;
+	return copy;
+}
+
+
+static struct delivery *dequeue(s32 app_id)
+{
+	struct event_queue  *q;
+	struct queued_event *qe;
+	struct delivery     *d;
+	Event_union         *ev;
+	size_t               size = 0;
+	char                *strings;
+
+	if (app_id < 0) app_id = oldest_app();
+	if (app_id < 0 || app_id >= MAX_APPS) return NULL;
+
+	q = &queues[app_id];
+	if (!q->num) return NULL;
+
+	qe = &q->buf[q->head];
+	ev = &qe->ev;
+
+	if (ev->type == EVENT_TYPE_COMMAND)
+		size = str_size(ev->command.cmd);
+	if (ev->type == EVENT_TYPE_ATTRIB) {
+		size = str_size(ev->attrib.name);
+		if (ev->attrib.value_type == ATTRIB_TYPE_STRING)
+			size += str_size(ev->attrib.string);
+	}
+
+	/* the event and the copied strings follow the delivery */
+	d = (struct delivery *)malloc(sizeof(struct delivery) + sizeof(Event_union) + size);
+	if (!d) {
+		ERROR(printf("Messenger(dequeue): out of memory\n");)
+		return NULL;
+	}
+	d->callback = qe->callback;
+	d->arg      = qe->arg;
+	d->ev       = (Event_union *)((adr)d + sizeof(struct delivery));
+	*d->ev      = *ev;
+
+	strings = (char *)((adr)d->ev + sizeof(Event_union));
+	if (ev->type == EVENT_TYPE_COMMAND)
+		d->ev->command.cmd = copy_str(ev->command.cmd, &strings);
+	if (ev->type == EVENT_TYPE_ATTRIB) {
+		d->ev->attrib.name = copy_str(ev->attrib.name, &strings);
+		if (ev->attrib.value_type == ATTRIB_TYPE_STRING)
+			d->ev->attrib.string = copy_str(ev->attrib.string, &strings);
+	}
+
+	q->head = (q->head + 1) % q->size;
+	q->num--;
+
+	if (!q->num && q->dropped) {
+		ERROR(printf("Messenger(dequeue): dropped %d events of app %d\n", q->dropped, (int)app_id);)
+		q->dropped = 0;
+	}
+	return d;
+}
+
+
+/**
+ * Discard event queue of an application
+ */
+static void release_app(s32 app_id)
+{
+	if (app_id < 0 || app_id >= MAX_APPS) return;
+
+	free(queues[app_id].buf);
+	queues[app_id].buf     = NULL;
+	queues[app_id].size    = 0;
+	queues[app_id].head    = 0;
+	queues[app_id].num     = 0;
+	queues[app_id].dropped = 0;
 }
 
 
@@ -116,6 +633,13 @@ static void send_action_event(s32 app_id, char const *action, char const *bindar
 static struct messenger_services services = {
 	send_input_event,
 	send_action_event,
+	send_event,
+	pending,
+	dequeue,
+	release_app,
+	discard,
+	create_filter,
+	free_filter,
 };
 
 
@@ -125,6 +649,10 @@ static struct messenger_services services = {
 
 int init_messenger(struct dope_services *d)
 {
+	script = (script_services *)(d->get_module("Script 1.0"));
+	timer  = (timer_services  *)(d->get_module("Timer 1.0"));
+	tick   = (tick_services   *)(d->get_module("Tick 1.0"));
+
 	d->register_module("Messenger 1.0",&services);
 	return 1;
 }
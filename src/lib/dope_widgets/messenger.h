@@ -17,9 +17,59 @@
 
 #include "event.h"
 
+union Event_union;
+struct binding;
+struct bind_filter;
+
+/**
+ * Event taken from the queue of an application
+ *
+ * The strings referred to by the event are copied along with it, so the
+ * event stays valid without holding the widget-tree lock.
+ */
+struct delivery {
+	void             (*callback) (union Event_union *, void *);
+	void              *arg;
+	union Event_union *ev;   /* located right after the structure */
+};
+
 struct messenger_services {
-	void (*send_input_event) (s32 app_id, EVENT *e, char const *bindarg);
-	void (*send_action_event)(s32 app_id, char const *action, char const *bindarg);
+	void (*send_input_event) (s32 app_id, EVENT *e, struct binding const *b);
+	void (*send_action_event)(s32 app_id, char const *action, struct binding const *b);
+
+	/**
+	 * Queue event that was composed by the caller
+	 */
+	void (*send_event)       (s32 app_id, union Event_union *ev, struct binding const *b);
+
+	int  (*pending)          (s32 app_id);
+
+	/**
+	 * Remove oldest queued event
+	 *
+	 * \param app_id  application id or a negative value for the oldest
+	 *                event of all applications
+	 * \return        delivery to be freed by the caller after invoking
+	 *                the callback, or NULL if no event is queued
+	 */
+	struct delivery *(*dequeue) (s32 app_id);
+
+	void (*release_app)      (s32 app_id);
+
+	/**
+	 * Drop queued events of a binding that is about to vanish
+	 */
+	void (*discard)          (s32 app_id, struct binding const *b);
+
+	/**
+	 * Create delivery options of a binding
+	 *
+	 * \param options  textual options that follow the event name of a
+	 *                 binding identifier
+	 * \return         filter or NULL if no option was specified
+	 */
+	struct bind_filter *(*create_filter) (char const *options);
+	void                (*free_filter)   (struct bind_filter *);
 };
 
 #endif /* _DOPE_MESSENGER_H_ */
@@ -0,0 +1,594 @@
+/*
+ * \brief   DOpE Plot widget module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * A Plot displays the history of one or more series of values, for
+ * example the CPU load over time. Each series keeps its samples in a
+ * ring buffer of fixed capacity. The ring buffers of all series reside
+ * in a shared memory block, which the client can map to write samples
+ * directly. Alternatively, samples can be appended in batches via the
+ * 'append' method.
+ *
+ * The graph is painted into an image that is organized as a ring of
+ * pixel columns, one column per sample. A new sample paints only its own
+ * column and advances the ring, so its costs depend on the height of the
+ * graph only. Drawing the widget copies the two parts of the column ring
+ * to the screen such that the newest sample appears at the right border.
+ * If the graph is wider than the capacity of the ring buffers, the column
+ * ring covers only the right part of the image.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+struct plot;
+#define WIDGET struct plot
+
+/* local includes */
+#include "dopestd.h"
+#include "plot.h"
+#include "gfx.h"
+#include "sharedmem.h"
+#include "script.h"
+#include "widget_data.h"
+#include "widget_help.h"
+#include "widman.h"
+#include "redraw.h"
+
+static struct widman_services    *widman;
+static struct gfx_services       *gfx;
+static struct script_services    *script;
+static struct redraw_services    *redraw;
+static struct sharedmem_services *shmem;
+
+enum {
+	MAX_SERIES       = 8,     /* max number of series of a plot          */
+	DEFAULT_CAPACITY = 512,   /* default number of samples per series    */
+	MAX_CAPACITY     = 65536, /* max number of samples per series        */
+	PAD              = 2,     /* distance of graph to the widget border  */
+	MIN_SIZE         = 16,    /* min width and height of graph           */
+};
+
+struct series {
+	char const *ident;
+	color_t     color;
+};
+
+struct plot_data {
+	struct series  series[MAX_SERIES];
+	s32            num_series;
+	s32            colcnt;          /* counter for color assignment          */
+	float          from, to;        /* visible range of values               */
+	SHAREDMEM     *smb;             /* sample buffer shared with the client  */
+	char           smb_ident[64];
+	float         *samples;         /* one ring buffer per series            */
+	s32            capacity;        /* number of samples per series          */
+	s32            head;            /* ring position of the next sample      */
+	s32            num;             /* number of valid samples               */
+	GFX_CONTAINER *image;           /* ring of pixel columns                 */
+	u16           *pixels;
+	s32            img_w, img_h;
+	s32            img_col;         /* image column of the next sample       */
+	s32            ring_w;          /* number of columns used as ring        */
+};
+
+enum { NUM_DEFAULT_COLORS = 4 };
+static color_t default_colors[NUM_DEFAULT_COLORS] = {
+	GFX_RGB(255U, 64U,  64U),
+	GFX_RGB( 64U, 128U, 255U),
+	GFX_RGB(  0U, 200U,  0U),
+	GFX_RGB(200U, 200U,  0U)
+};
+
+static const color_t BG_COLOR    = GFX_RGB(40, 40, 40);
+static const color_t BLACK_SOLID = GFX_RGBA(0, 0, 0, 255);
+static const color_t WHITE_MIXED = GFX_RGBA(255, 255, 255, 127);
+
+int init_plot(struct dope_services *d);
+
+
+/********************************
+ ** Functions for internal use **
+ ********************************/
+
+static inline void draw_pressed_frame(GFX_CONTAINER *d, int x, int y, int w, int h)
+{
+	gfx->draw_hline(d, x, y, w, BLACK_SOLID);
+	gfx->draw_vline(d, x, y, h, BLACK_SOLID);
+	gfx->draw_hline(d, x, y + h - 1, w, WHITE_MIXED);
+	gfx->draw_vline(d, x + w - 1, y, h, WHITE_MIXED);
+}
+
+
+/**
+ * Convert two-digit hex number to a unsigned char
+ */
+static inline u8 hex2u8(const char *s)
+{
+	u32 result = 0;
+	for (int i = 0; i < 2; i++, s++) {
+		if (!(*s)) return result;
+		result = result*16 + (*s & 0xf);
+		if (*s > '9') result += 9;
+	}
+	return result;
+}
+
+
+static inline float *sample(PLOT *p, s32 series, s32 idx)
+{
+	return &p->pd->samples[series*p->pd->capacity + idx];
+}
+
+
+/**
+ * Return image line that corresponds to a value
+ *
+ * The samples are written by the client, so the value is clamped before
+ * the conversion to an integer. NaN values are shown at the bottom.
+ */
+static inline s32 value_to_y(PLOT *p, float v)
+{
+	float range = p->pd->to - p->pd->from;
+	s32 h = p->pd->img_h;
+	float pos;
+
+	if (range == 0) return h - 1;
+	pos = (v - p->pd->from)*(h - 1)/range;
+
+	if (!(pos > 0))    return h - 1;
+	if (pos >= h - 1)  return 0;
+	return (h - 1) - (s32)pos;
+}
+
+
+/**
+ * Paint sample into an image column
+ *
+ * Each series is drawn as a line from its previous sample to the painted
+ * sample.
+ */
+static void paint_column(PLOT *p, s32 col, s32 idx, int has_prev)
+{
+	s32  prev = idx ? idx - 1 : p->pd->capacity - 1;
+	s32  w    = p->pd->img_w;
+	u16 *dst  = p->pd->pixels + col;
+	u16  bg   = rgba_to_rgb565(BG_COLOR);
+
+	for (s32 y = 0; y < p->pd->img_h; y++)
+		dst[y*w] = bg;
+
+	for (s32 s = 0; s < p->pd->num_series; s++) {
+		s32 y1 = value_to_y(p, *sample(p, s, idx));
+		s32 y0 = has_prev ? value_to_y(p, *sample(p, s, prev)) : y1;
+		u16 c  = rgba_to_rgb565(p->pd->series[s].color);
+
+		for (s32 y = MIN(y0, y1); y <= MAX(y0, y1); y++)
+			dst[y*w] = c;
+	}
+}
+
+
+/**
+ * Paint the newest samples into the next image columns
+ */
+static void paint_samples(PLOT *p, s32 num)
+{
+	if (!p->pd->pixels) return;
+
+	num = MIN(num, MIN(p->pd->num, p->pd->ring_w));
+	for (s32 i = num; i > 0; i--) {
+		s32 idx = (p->pd->head - i + p->pd->capacity) % p->pd->capacity;
+		paint_column(p, p->pd->img_col, idx, i < p->pd->num);
+		p->pd->img_col = (p->pd->img_col + 1) % p->pd->ring_w;
+	}
+}
+
+
+/**
+ * Paint all visible samples anew
+ */
+static void repaint(PLOT *p)
+{
+	u16 bg = rgba_to_rgb565(BG_COLOR);
+
+	if (!p->pd->pixels) return;
+
+	for (s32 i = 0; i < p->pd->img_w*p->pd->img_h; i++)
+		p->pd->pixels[i] = bg;
+
+	p->pd->ring_w  = MIN(p->pd->img_w, p->pd->capacity);
+	p->pd->img_col = 0;
+	paint_samples(p, p->pd->num);
+}
+
+
+/**
+ * Adapt size of the column image to the size of the widget
+ */
+static void adapt_image(PLOT *p)
+{
+	s32 w = p->wd->w - 2*PAD, h = p->wd->h - 2*PAD;
+
+	if (p->pd->image && w == p->pd->img_w && h == p->pd->img_h) return;
+
+	if (p->pd->image) gfx->dec_ref(p->pd->image);
+	p->pd->image  = NULL;
+	p->pd->pixels = NULL;
+	p->pd->img_w  = p->pd->img_h = 0;
+
+	if (w < 1 || h < 1) return;
+
+	if (!(p->pd->image = gfx->alloc_img(w, h, GFX_IMG_TYPE_RGB16))) {
+		ERROR(printf("Plot(adapt_image): out of memory!\n");)
+		return;
+	}
+	p->pd->pixels = (u16 *)gfx->map(p->pd->image);
+	p->pd->img_w  = w;
+	p->pd->img_h  = h;
+	repaint(p);
+}
+
+
+/**
+ * Replace sample buffer
+ *
+ * The newest samples of the existing series are kept.
+ *
+ * \return  0 if the capacity is invalid or out of memory
+ */
+static int resize_buffer(PLOT *p, long capacity, s32 num_series)
+{
+	SHAREDMEM *smb;
+	float     *samples;
+	s32        keep;
+	size_t     num, size;
+
+	if (capacity < 1 || capacity > MAX_CAPACITY
+	 || num_series < 0 || num_series > MAX_SERIES) return 0;
+
+	num  = (size_t)capacity*(size_t)MAX(num_series, 1);
+	if (num > (size_t)~0/sizeof(float)) return 0;
+	size = num*sizeof(float);
+	keep = MIN(p->pd->num, (s32)capacity);
+
+	if (!(smb = shmem->alloc(size))) {
+		ERROR(printf("Plot(resize_buffer): out of memory!\n");)
+		return 0;
+	}
+	samples = (float *)shmem->get_address(smb);
+	memset(samples, 0, size);
+
+	for (s32 s = 0; s < MIN(num_series, p->pd->num_series); s++)
+		for (s32 i = 0; i < keep; i++) {
+			s32 idx = (p->pd->head - keep + i + p->pd->capacity) % p->pd->capacity;
+			samples[s*capacity + i] = *sample(p, s, idx);
+		}
+
+	if (p->pd->smb) shmem->destroy(p->pd->smb);
+	p->pd->smb      = smb;
+	p->pd->samples  = samples;
+	p->pd->capacity = capacity;
+	p->pd->head     = keep % capacity;
+	p->pd->num      = keep;
+	return 1;
+}
+
+
+/**
+ * Show samples that were added to the ring buffers
+ */
+static void commit_samples(PLOT *p, s32 num)
+{
+	if (num < 1 || !p->pd->pixels) return;
+
+	paint_samples(p, num);
+	redraw->draw_widgetarea(p, PAD, PAD, PAD + p->pd->img_w - 1, PAD + p->pd->img_h - 1);
+}
+
+
+/****************************
+ ** General widget methods **
+ ****************************/
+
+static int plot_draw(PLOT *p, struct gfx_ds *ds, long x, long y, WIDGET *origin)
+{
+	s32 w = p->pd->img_w, h = p->pd->img_h, col = p->pd->img_col;
+
+	x += p->wd->x + PAD;
+	y += p->wd->y + PAD;
+
+	if (origin == p) return 1;
+	if (origin) return 0;
+
+	gfx->push_clipping(ds, x - 1, y - 1, p->wd->w - 2*PAD + 2, p->wd->h - 2*PAD + 2);
+
+	/*
+	 * The column of the next sample holds the oldest sample. The column
+	 * ring occupies the right part of the image, the columns left of it
+	 * are empty.
+	 */
+	if (p->pd->image) {
+		s32 rw = p->pd->ring_w, rx = x + w - rw;
+
+		if (w > rw)
+			gfx->draw_slice(ds, x, y, w - rw, h, rw, 0, w - rw, h, p->pd->image, 255);
+
+		gfx->draw_slice(ds, rx, y, rw - col, h, col, 0, rw - col, h, p->pd->image, 255);
+		if (col)
+			gfx->draw_slice(ds, rx + rw - col, y, col, h, 0, 0, col, h, p->pd->image, 255);
+	}
+	draw_pressed_frame(ds, x - 1, y - 1, p->wd->w - 2*PAD + 2, p->wd->h - 2*PAD + 2);
+
+	gfx->pop_clipping(ds);
+	return 1;
+}
+
+
+static void plot_calc_minmax(PLOT *p)
+{
+	p->wd->min_w = p->wd->min_h = MIN_SIZE + 2*PAD;
+	p->wd->max_w = p->wd->max_h = 99999;
+}
+
+
+/**
+ * Update plot after change of position or size
+ */
+static void (*orig_updatepos)(WIDGET *w);
+static void plot_updatepos(PLOT *p)
+{
+	adapt_image(p);
+	orig_updatepos(p);
+}
+
+
+static void plot_free_data(PLOT *p)
+{
+	for (s32 s = 0; s < p->pd->num_series; s++)
+		free(p->pd->series[s].ident);
+
+	if (p->pd->image) gfx->dec_ref(p->pd->image);
+	if (p->pd->smb)   shmem->destroy(p->pd->smb);
+}
+
+
+/**
+ * Return widget type identifier
+ */
+static char const *plot_get_type(PLOT *p)
+{
+	return "Plot";
+}
+
+static struct widget_methods gen_methods;
+
+
+/***************************
+ ** Plot specific methods **
+ ***************************/
+
+static void plot_seriesconfig(PLOT *p, char const *ident, char const *color)
+{
+	s32 s;
+
+	if (!ident) return;
+
+	/* search identifier in existing series or add a new series */
+	for (s = 0; s < p->pd->num_series; s++)
+		if (streq(ident, p->pd->series[s].ident, 256)) break;
+
+	if (s == p->pd->num_series) {
+		if (s == MAX_SERIES || !resize_buffer(p, p->pd->capacity, s + 1)) return;
+		p->pd->series[s].ident = strdup(ident);
+		p->pd->series[s].color = default_colors[(p->pd->colcnt++) % NUM_DEFAULT_COLORS];
+		p->pd->num_series++;
+	}
+
+	if (color && (*color == '#') && (strlen(color) >= 7))
+		p->pd->series[s].color = GFX_RGB(hex2u8(color + 1), hex2u8(color + 3), hex2u8(color + 5));
+
+	repaint(p);
+	p->wd->update |= WID_UPDATE_REFRESH;
+	gen_methods.update(p);
+}
+
+
+static void plot_append(PLOT *p, char const *values)
+{
+	s32 s = 0, num = 0;
+
+	if (!values || !p->pd->num_series) return;
+
+	while (*values) {
+
+		/* skip whitespace */
+		while (*values == ' ' || *values == '\t' || *values == '\n') values++;
+		if (!*values) break;
+
+		*sample(p, s, p->pd->head) = atof(values);
+		while (*values && *values != ' ' && *values != '\t' && *values != '\n') values++;
+
+		/* sample is complete when all series got a value */
+		if (++s < p->pd->num_series) continue;
+
+		s = 0;
+		p->pd->head = (p->pd->head + 1) % p->pd->capacity;
+		p->pd->num  = MIN(p->pd->num + 1, p->pd->capacity);
+		num++;
+	}
+	commit_samples(p, num);
+}
+
+
+static void plot_advance(PLOT *p, long num)
+{
+	if (!p->pd->samples || num < 1) return;
+
+	/* the head follows the writes of the client, older samples got overwritten */
+	p->pd->head = (p->pd->head + num % p->pd->capacity) % p->pd->capacity;
+
+	num = MIN(num, p->pd->capacity);
+	p->pd->num = MIN(p->pd->num + num, p->pd->capacity);
+	commit_samples(p, num);
+}
+
+
+/**
+ * Map sample buffer to another thread's address space
+ *
+ * The buffer holds the ring buffers of all series one after another.
+ * Each ring buffer consists of 'capacity' float values. Changing the
+ * capacity or adding a series replaces the buffer.
+ */
+static char const *plot_map(PLOT *p, char *dst_thread_ident)
+{
+	char dst_th_buf[16];
+	void *dst_th = (void *)dst_th_buf;
+
+	if (!p->pd->smb) return "Error: Plot has no sample buffer.";
+
+	shmem->share(p->pd->smb, dst_th);
+	shmem->get_ident(p->pd->smb, &p->pd->smb_ident[0]);
+	return &p->pd->smb_ident[0];
+}
+
+
+static void plot_set_capacity(PLOT *p, long capacity)
+{
+	if (capacity < 1 || capacity > MAX_CAPACITY || capacity == p->pd->capacity)
+		return;
+	if (!resize_buffer(p, capacity, p->pd->num_series)) return;
+
+	repaint(p);
+	p->wd->update |= WID_UPDATE_REFRESH;
+}
+
+
+static long plot_get_capacity(PLOT *p)
+{
+	return p->pd->capacity;
+}
+
+
+static long plot_get_head(PLOT *p)
+{
+	return p->pd->head;
+}
+
+
+static void plot_set_from(PLOT *p, float from)
+{
+	p->pd->from = from;
+	repaint(p);
+	p->wd->update |= WID_UPDATE_REFRESH;
+}
+
+
+static float plot_get_from(PLOT *p)
+{
+	return p->pd->from;
+}
+
+
+static void plot_set_to(PLOT *p, float to)
+{
+	p->pd->to = to;
+	repaint(p);
+	p->wd->update |= WID_UPDATE_REFRESH;
+}
+
+
+static float plot_get_to(PLOT *p)
+{
+	return p->pd->to;
+}
+
+
+static struct plot_methods plot_methods = {
+	plot_seriesconfig,
+	plot_append,
+	plot_advance,
+};
+
+
+/***********************
+ ** Service functions **
+ ***********************/
+
+static PLOT *create(void)
+{
+	PLOT *p = ALLOC_WIDGET(struct plot);
+	SET_WIDGET_DEFAULTS(p, struct plot, &plot_methods);
+
+	/* set plot specific attributes */
+	p->pd->from = 0.0;
+	p->pd->to   = 100.0;
+	resize_buffer(p, DEFAULT_CAPACITY, 0);
+	gen_methods.update(p);
+
+	return p;
+}
+
+
+/**************************************
+ ** Service structure of this module **
+ **************************************/
+
+static struct plot_services services = {
+	create
+};
+
+
+/************************
+ ** Module entry point **
+ ************************/
+
+static void build_script_lang(void)
+{
+	widtype *widtype;
+
+	widtype = script->reg_widget_type("Plot", (void *(*)(void))create);
+
+	script->reg_widget_method(widtype, "void seriesconfig(string ident,string color=\"<default>\")", (void *)plot_seriesconfig);
+	script->reg_widget_method(widtype, "void append(string values)", (void *)plot_append);
+	script->reg_widget_method(widtype, "void advance(long num)", (void *)plot_advance);
+	script->reg_widget_method(widtype, "string map(string thread=\"caller\")", (void *)plot_map);
+	script->reg_widget_attrib(widtype, "long capacity", (void *)plot_get_capacity, (void *)plot_set_capacity, (void *)gen_methods.update);
+	script->reg_widget_attrib(widtype, "long head", (void *)plot_get_head, NULL, NULL);
+	script->reg_widget_attrib(widtype, "float from", (void *)plot_get_from, (void *)plot_set_from, (void *)gen_methods.update);
+	script->reg_widget_attrib(widtype, "float to", (void *)plot_get_to, (void *)plot_set_to, (void *)gen_methods.update);
+
+	widman->build_script_lang(widtype, &gen_methods);
+}
+
+
+int init_plot(struct dope_services *d)
+{
+	widman = (widman_services    *)(d->get_module("WidgetManager 1.0"));
+	gfx    = (gfx_services       *)(d->get_module("Gfx 1.0"));
+	script = (script_services    *)(d->get_module("Script 1.0"));
+	redraw = (redraw_services    *)(d->get_module("RedrawManager 1.0"));
+	shmem  = (sharedmem_services *)(d->get_module("SharedMemory 1.0"));
+
+	/* define general widget functions */
+	widman->default_widget_methods(&gen_methods);
+
+	orig_updatepos = gen_methods.updatepos;
+
+	gen_methods.get_type    = plot_get_type;
+	gen_methods.draw        = plot_draw;
+	gen_methods.calc_minmax = plot_calc_minmax;
+	gen_methods.updatepos   = plot_updatepos;
+	gen_methods.free_data   = plot_free_data;
+
+	build_script_lang();
+
+	d->register_module("Plot 1.0", &services);
+	return 1;
+}
@@ -0,0 +1,58 @@
+/*
+ * \brief   Interface of DOpE Plot widget module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _DOPE_PLOT_H_
+#define _DOPE_PLOT_H_
+
+#include "widget.h"
+
+struct plot_methods;
+struct plot_data;
+
+#define PLOT struct plot
+
+struct plot {
+	struct widget_methods *gen;
+	struct plot_methods   *plot;
+	struct widget_data    *wd;
+	struct plot_data      *pd;
+};
+
+struct plot_methods {
+
+	/**
+	 * Define series or change its color
+	 */
+	void (*seriesconfig) (PLOT *, char const *ident, char const *color);
+
+	/**
+	 * Append samples
+	 *
+	 * \param values  whitespace-separated values, each sample consists
+	 *                of one value per series
+	 */
+	void (*append)  (PLOT *, char const *values);
+
+	/**
+	 * Take samples that the client wrote into the shared sample buffer
+	 *
+	 * \param num  number of samples written at the ring position 'head'
+	 */
+	void (*advance) (PLOT *, long num);
+};
+
+struct plot_services {
+	PLOT *(*create) (void);
+};
+
+#endif /* _DOPE_PLOT_H_ */
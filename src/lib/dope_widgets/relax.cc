@@ -13,33 +13,50 @@
  */
 
 #include "dopestd.h"
+#include "timer.h"
+#include "tick.h"
+#include "redraw.h"
 #include "relax.h"
 
-int init_relax(struct dope_services *d);
+enum {
+	FRAME_MSEC = 25,   /* period of the animation frame clock       */
+	MAX_STEPS  = 40,   /* max frames to catch up with at once       */
+	MAX_SKIP   = 3,    /* max frames to skip while redraw is behind */
+};
 
+struct relax_anim;
+struct relax_anim {
+	int              (*callback) (void *);  /* NULL if finished */
+	void              *arg;                 /* callback argument */
+	struct relax_anim *next;
+};
 
-/***********************
- ** Service functions **
- ***********************/
+static struct timer_services  *timer;
+static struct tick_services   *tick;
+static struct redraw_services *redraw;
 
-/**
- * Define duration of relaxation process
+/*
+ * All running animations are stepped by one frame clock. Their redraw
+ * requests thereby end up in the redraw queue together. Progress is
+ * measured in elapsed frame periods rather than in clock ticks.
  */
-static void set_duration(RELAX *r, float time)
-{
-	float delta = (r->curr > r->dst) ? r->curr - r->dst : r->dst - r->curr;
-	if (time == 0) time = 0.00001;
-	r->accel = 4*delta/(time*time);
+static struct relax_anim *first_anim;      /* list of animations              */
+static struct tick       *clock_tick;      /* tick of frame clock             */
+static u32                frame_time;      /* time animations are advanced to */
+static int                frame_steps = 1; /* frames of the current step      */
+static int                num_skipped;     /* frames skipped in a row         */
+
+int init_relax(struct dope_services *d);
 
-	/* assure an acceleration of at least 1.0 */
-	if (r->accel < 1.0) r->accel = 1.0;
-}
 
+/********************************
+ ** Functions for internal use **
+ ********************************/
 
 /**
- * Do a relaxation iteration
+ * Do a single relaxation iteration
  */
-static int relax_do_relax(RELAX *r)
+static int relax_step(RELAX *r)
 {
 	float delta;
 
@@ -70,7 +87,120 @@ static int relax_do_relax(RELAX *r)
 	if (r->speed < 1) r->speed = 1;
 
 	return 1;  /* relaxation in progress */
-};
+}
+
+
+/**
+ * Tick callback of the frame clock
+ */
+static int frame_clock(void *arg)
+{
+	struct relax_anim *a, **ap;
+	u32 elapsed = timer->get_time() - frame_time;
+
+	/* give the redraw manager the chance to catch up */
+	if (redraw->get_noque() && num_skipped < MAX_SKIP) {
+		num_skipped++;
+		return 1;
+	}
+	num_skipped = 0;
+
+	frame_steps = elapsed / (FRAME_MSEC*1000);
+	if (!frame_steps) return 1;
+	frame_time += frame_steps * FRAME_MSEC*1000;
+	if (frame_steps > MAX_STEPS) frame_steps = MAX_STEPS;
+
+	/* animations started by a callback begin with the next frame */
+	for (a = first_anim; a; a = a->next)
+		if (a->callback && !a->callback(a->arg))
+			a->callback = NULL;
+
+	frame_steps = 1;
+
+	/* free finished animations */
+	for (ap = &first_anim; (a = *ap); ) {
+		if (a->callback) {
+			ap = &a->next;
+			continue;
+		}
+		*ap = a->next;
+		free(a);
+	}
+
+	if (first_anim) return 1;
+
+	clock_tick = NULL;
+	return 0;
+}
+
+
+/***********************
+ ** Service functions **
+ ***********************/
+
+/**
+ * Define duration of relaxation process
+ */
+static void set_duration(RELAX *r, float time)
+{
+	float delta = (r->curr > r->dst) ? r->curr - r->dst : r->dst - r->curr;
+	if (time == 0) time = 0.00001;
+	r->accel = 4*delta/(time*time);
+
+	/* assure an acceleration of at least 1.0 */
+	if (r->accel < 1.0) r->accel = 1.0;
+}
+
+
+/**
+ * Advance relaxation
+ *
+ * Within the frame clock, the relaxation is advanced by all frames
+ * elapsed since the last step. Otherwise, a single iteration is done.
+ */
+static int relax_do_relax(RELAX *r)
+{
+	int i, ret = 0;
+	for (i = 0; i < frame_steps; i++)
+		ret = relax_step(r);
+	return ret;
+}
+
+
+/**
+ * Register animation at the frame clock
+ */
+static struct relax_anim *relax_animate(int (*callback)(void *), void *arg)
+{
+	struct relax_anim *a = (struct relax_anim *)zalloc(sizeof(struct relax_anim));
+	if (!a) return NULL;
+
+	/* start frame clock with the first animation */
+	if (!clock_tick) {
+		if (!(clock_tick = tick->add(FRAME_MSEC, frame_clock, NULL))) {
+			free(a);
+			return NULL;
+		}
+		frame_time = timer->get_time();
+	}
+
+	a->callback = callback;
+	a->arg      = arg;
+	a->next     = first_anim;
+	first_anim  = a;
+	return a;
+}
+
+
+/**
+ * Stop animation
+ *
+ * The animation is freed by the frame clock.
+ */
+static void relax_stop(struct relax_anim *a)
+{
+	if (a) a->callback = NULL;
+}
 
 
 /**************************************
@@ -80,6 +210,8 @@ static int relax_do_relax(RELAX *r)
 static struct relax_services services = {
 	set_duration,
 	relax_do_relax,
+	relax_animate,
+	relax_stop,
 };
 
 
@@ -89,6 +221,10 @@ static struct relax_services services = {
 
 int init_relax(struct dope_services *d)
 {
+	timer  = (timer_services  *)(d->get_module("Timer 1.0"));
+	tick   = (tick_services   *)(d->get_module("Tick 1.0"));
+	redraw = (redraw_services *)(d->get_module("RedrawManager 1.0"));
+
 	d->register_module("Relax 1.0", &services);
 	return 1;
 }
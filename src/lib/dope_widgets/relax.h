@@ -23,9 +23,39 @@ RELAX {
 	float accel;
 };
 
+struct relax_anim;
 struct relax_services {
+
+	/**
+	 * Define duration of relaxation process
+	 *
+	 * \param time  duration in frames of the animation frame clock
+	 */
 	void (*set_duration) (RELAX *, float time);
+
+	/**
+	 * Advance relaxation by the frames elapsed since the last frame
+	 *
+	 * \return  0 if the destination value is reached
+	 */
 	int  (*do_relax)     (RELAX *);
+
+	/**
+	 * Register animation at the frame clock
+	 *
+	 * \param callback  called once per frame, the animation is finished
+	 *                  when the callback returns 0
+	 * \return          animation handle or NULL if out of memory
+	 *
+	 * The handle becomes invalid once the callback returned 0 or the
+	 * animation got stopped via 'stop'.
+	 */
+	struct relax_anim *(*animate) (int (*callback)(void *), void *arg);
+
+	/**
+	 * Stop animation
+	 */
+	void (*stop) (struct relax_anim *);
 };
 
 
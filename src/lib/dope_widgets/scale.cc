@@ -259,14 +259,16 @@ static WIDGET *scale_find(SCALE *w,long x,long y)
  *
  * We have to bind the event to the child widgets of the scale.
  */
-static void (*orig_bind)(WIDGET *w, char const *bind_ident, char const *message);
-static void scale_bind(SCALE *s, char const *bind_ident, char const *message)
+static void (*orig_bind)(WIDGET *w, char const *bind_ident,
+                         void (*callback)(Event_union *, void *), void *arg);
+static void scale_bind(SCALE *s, char const *bind_ident,
+                       void (*callback)(Event_union *, void *), void *arg)
 {
 	WIDGET *cw;
 
-	if ((cw = s->sd->slider))    cw->gen->bind(cw, bind_ident, message);
-	if ((cw = s->sd->slider_bg)) cw->gen->bind(cw, bind_ident, message);
-	orig_bind(s, bind_ident, message);
+	if ((cw = s->sd->slider))    cw->gen->bind_callback(cw, bind_ident, callback, arg);
+	if ((cw = s->sd->slider_bg)) cw->gen->bind_callback(cw, bind_ident, callback, arg);
+	orig_bind(s, bind_ident, callback, arg);
 }
 
 
@@ -334,14 +336,14 @@ static void scale_set_value(SCALE *s,float new_value)
 {
 	static char strbuf[24];
 	int app_id;
-	char const *m;
+	struct binding *m;
 
 	s->sd->value = check_value(s->sd->from, s->sd->to, new_value);
 	ftoa(s->sd->value, 2, strbuf, 24);
 	if (s->sd->var) s->sd->var->var->set_string(s->sd->var, &strbuf[0]);
 
 	/* notify client that bound an "change"-event */
-	m = s->gen->get_bind_msg(s, "change");
+	m = s->gen->get_binding(s, "change");
 	app_id = s->gen->get_app_id(s);
 	if (m) msg->send_action_event(app_id, "change", m);
 
@@ -438,7 +440,7 @@ static void slider_motion_callback(WIDGET *w, int dx, int dy)
 {
 	float from, to, value;
 	s32 pos, size, app_id;
-	char const *m;
+	struct binding *m;
 
 	if (!(scale_get_orient_bit(curr_scale) & SCALE_VER)) {
 		pos  = osx + dx;
@@ -455,7 +457,7 @@ static void slider_motion_callback(WIDGET *w, int dx, int dy)
 
 	scale_set_value(curr_scale, value);
 
-	m = curr_scale->gen->get_bind_msg(curr_scale, "slide");
+	m = curr_scale->gen->get_binding(curr_scale, "slide");
 	app_id = curr_scale->gen->get_app_id(curr_scale);
 	if (m) msg->send_action_event(app_id, "slide", m);
 
@@ -466,7 +468,7 @@ static void slider_motion_callback(WIDGET *w, int dx, int dy)
 
 static void slider_release_callback(WIDGET *s, int dx, int dy)
 {
-	char const *m = curr_scale->gen->get_bind_msg(curr_scale, "slid");
+	struct binding *m = curr_scale->gen->get_binding(curr_scale, "slid");
 	int app_id = curr_scale->gen->get_app_id(curr_scale);
 	if (m) msg->send_action_event(app_id, "slid", m);
 }
@@ -593,18 +595,18 @@ int init_scale(struct dope_services *d)
 	/* define general widget functions */
 	widman->default_widget_methods(&gen_methods);
 
-	orig_bind                = gen_methods.bind;
-	orig_set_app_id          = gen_methods.set_app_id;
-	orig_updatepos           = gen_methods.updatepos;
-
-	gen_methods.get_type     = scale_get_type;
-	gen_methods.draw         = scale_draw;
-	gen_methods.updatepos    = scale_updatepos;
-	gen_methods.find         = scale_find;
-	gen_methods.bind         = scale_bind;
-	gen_methods.set_app_id   = scale_set_app_id;
-	gen_methods.calc_minmax  = scale_calc_minmax;
-	gen_methods.free_data    = scale_free_data;
+	orig_bind                 = gen_methods.bind_callback;
+	orig_set_app_id           = gen_methods.set_app_id;
+	orig_updatepos            = gen_methods.updatepos;
+
+	gen_methods.get_type      = scale_get_type;
+	gen_methods.draw          = scale_draw;
+	gen_methods.updatepos     = scale_updatepos;
+	gen_methods.find          = scale_find;
+	gen_methods.bind_callback = scale_bind;
+	gen_methods.set_app_id    = scale_set_app_id;
+	gen_methods.calc_minmax   = scale_calc_minmax;
+	gen_methods.free_data     = scale_free_data;
 
 	build_script_lang();
 
@@ -17,6 +17,7 @@
 
 /* Genode includes */
 #include <base/snprintf.h>
+#include <base/lock.h>
 #include <util/string.h>
 
 /* local includes */
@@ -29,9 +30,17 @@
 #include "scope.h"
 #include "screen.h"
 #include "timer.h"
+#include "tick.h"
+#include "input.h"
+#include "messenger.h"
+#include "watch.h"
+#include "layout.h"
+#include "widget.h"
 
 /* DOpE client includes */
+#include <dope/dopedef.h>
 #include <dope/dopelib.h>
+#include <dope/opstream.h>
 #include <dope/vscreen.h>
 
 
@@ -42,6 +51,11 @@ static struct screen_services    *screen;
 static struct redraw_services    *redraw;
 static struct timer_services     *timer;
 static struct userstate_services *userstate;
+static struct tick_services      *tick;
+static struct input_services     *input;
+static struct messenger_services *msg;
+static struct watch_services     *watch;
+static struct layout_services    *layout;
 
 int init_simple_scheduler(struct dope_services *d);
 
@@ -49,6 +63,16 @@ extern int dope_client_main(int argc, char **argv);
 
 int config_redraw_granularity = 500*1000;
 
+/*
+ * Only one thread at a time blocks for input. It handles the input on behalf
+ * of all applications. Other threads calling 'dope_wait_event' queue up at
+ * 'wait_lock'.
+ */
+static Genode::Lock wait_lock;
+static int          num_waiters[MAX_APPS + 1];  /* waiting threads per app,  */
+                                                /* index 0 for DOPE_ALL_APPS */
+static int          waiting;                    /* a thread blocks for input */
+
 struct dope_services *dope_services;
 
 
@@ -56,11 +80,42 @@ struct dope_services *dope_services;
  ** Utilities **
  ***************/
 
-static void vsnprintf(char *dst, size_t dst_len, char const *format,
-                      va_list list)
+static size_t vsnprintf(char *dst, size_t dst_len, char const *format,
+                        va_list list)
 {
 	Genode::String_console sc(dst, dst_len);
 	sc.vprintf(format, list);
+	return sc.len();
+}
+
+
+/**
+ * Format string, allocate a larger buffer if the provided one is too small
+ *
+ * \param buf   initial buffer, usually located on the caller's stack
+ * \return      formatted string or NULL if out of memory
+ *
+ * If the returned string is not located in 'buf', the caller must free it.
+ */
+static char *vformat(char *buf, size_t size, char const *format, va_list list)
+{
+	char *dst = buf;
+
+	for (;;) {
+		va_list l;
+		size_t  len;
+
+		va_copy(l, list);
+		len = vsnprintf(dst, size, format, l);
+		va_end(l);
+
+		/* the string is complete if it did not fill up the buffer */
+		if (len + 1 < size) return dst;
+
+		if (dst != buf) free(dst);
+		size *= 2;
+		if (!(dst = (char *)malloc(size))) return NULL;
+	}
 }
 
 
@@ -87,7 +142,8 @@ static void rt_remove_widget(WIDGET *w) { }
  ** Dope client lib emulation **
  *******************************/
 
-static char cmdstr[1024];
+enum { CMDSTR_SIZE = 1024 };   /* size of formatted command strings */
+
 extern int dope_main(int argc, char **argv);
 
 
@@ -100,10 +156,17 @@ void dope_deinit(void)
 
 long dope_init_app(const char *appname)
 {
-	s32 app_id = appman->reg_app(appname);
-	SCOPE *rootscope = scope->create();
+	s32 app_id;
+	SCOPE *rootscope;
+
 	INFO(printf("dope_init_app called\n"));
+
+	appman->lock(0);
+	app_id    = appman->reg_app(appname);
+	rootscope = scope->create();
 	appman->set_rootscope(app_id, rootscope);
+	appman->unlock(0);
+
 	INFO(printf("dope_init_app returns app_id=%d\n", (int)app_id));
 	return app_id;
 }
@@ -112,29 +175,71 @@ long dope_init_app(const char *appname)
 long dope_deinit_app(long app_id)
 {
 	INFO(printf("Server(deinit_app): application (id=%lu) deinit requested\n", app_id);)
+	appman->lock(app_id);
 	screen->forget_children(app_id);
+	watch->release_app(app_id);
+	msg->release_app(app_id);
 	appman->unreg_app(app_id);
+	appman->unlock(app_id);
 	return 0;
 }
 
 
+/**
+ * Wake up the thread that blocks for input
+ *
+ * A command may queue redraw work or ticks. The blocking thread must take
+ * them into account.
+ */
+static inline void wakeup_waiter(void)
+{
+	if (waiting) input->wakeup();
+}
+
+
+/**
+ * Let watched attributes be sampled after a command that may have changed them
+ */
+static void touch_watches(long app_id)
+{
+	appman->lock(app_id);
+	watch->touch();
+	appman->unlock(app_id);
+}
+
+
 int dope_cmd(long app_id, const char *cmd)
 {
+	int ret;
+
 	INFO(printf("app %d requests dope_cmd \"%s\"\n", (int)app_id, cmd));
-	return script->exec_command(app_id, (char *)cmd, NULL, 0);
+	ret = script->exec_command(app_id, (char *)cmd, NULL, 0);
+	touch_watches(app_id);
+	wakeup_waiter();
+	return ret;
 }
 
 
+/*
+ * The format-string variants format their commands into buffers on the
+ * stack of the calling thread. So client threads can issue commands
+ * concurrently. Larger commands are formatted into heap buffers.
+ */
+
 int dope_cmdf(long app_id, const char *format, ...)
 {
 	int ret;
+	char buf[CMDSTR_SIZE], *cmdstr;
 	va_list list;
 
 	va_start(list, format);
-	vsnprintf(cmdstr, sizeof(cmdstr), format, list);
+	cmdstr = vformat(buf, sizeof(buf), format, list);
 	va_end(list);
+	if (!cmdstr) return DOPECMD_ERR_NO_MEM;
+
 	ret = dope_cmd(app_id, cmdstr);
 
+	if (cmdstr != buf) free(cmdstr);
 	return ret;
 }
 
@@ -156,53 +261,242 @@ int dope_cmd_seq(int app_id, ...)
 }
 
 
+/**
+ * Execute pending layout work so that requests report up-to-date geometry
+ */
+static void flush_layout(long app_id)
+{
+	appman->lock(app_id);
+	layout->flush();
+	appman->unlock(app_id);
+}
+
+
 int dope_req(long app_id, char *dst, int dst_size, const char *cmd)
 {
 	INFO(printf("dope_req \"%s\" requested by app_id=%lu\n", cmd, (long)app_id);)
-	return script->exec_command(app_id, (char *)cmd, dst, dst_size);
+	flush_layout(app_id);
+	int ret = script->exec_command(app_id, (char *)cmd, dst, dst_size);
+	touch_watches(app_id);
+	wakeup_waiter();
+	return ret;
 }
 
 
 int dope_reqf(long app_id, char *dst, int dst_size, const char *format, ...)
 {
+	int ret;
+	char buf[CMDSTR_SIZE], *cmdstr;
 	va_list list;
 
 	va_start(list, format);
-	vsnprintf(cmdstr, sizeof(cmdstr), format, list);
+	cmdstr = vformat(buf, sizeof(buf), format, list);
 	va_end(list);
-	return dope_req(app_id, dst, dst_size, cmdstr);
+	if (!cmdstr) return DOPECMD_ERR_NO_MEM;
+
+	ret = dope_req(app_id, dst, dst_size, cmdstr);
+
+	if (cmdstr != buf) free(cmdstr);
+	return ret;
+}
+
+
+int dope_req_multi(long app_id, Dope_req_entry *entries, int num,
+                   char *strbuf, int strbuf_size)
+{
+	flush_layout(app_id);
+	return script->req_multi(app_id, entries, num, strbuf, strbuf_size);
+}
+
+
+int dope_submit(long app_id, const void *buf, size_t len)
+{
+	int ret = script->exec_ops(app_id, buf, len);
+	touch_watches(app_id);
+	wakeup_waiter();
+	return ret;
 }
 
 
 void dope_bind(long app_id,const char *var, const char *event_type,
                void (*callback)(Event_union *,void *),void *arg) {
-	dope_cmdf(app_id, "%s.bind(%s, \"%08lx, %08lx\")",
-	          var, event_type, (long)callback, (long)arg);
+	WIDGET *w;
+
+	/* bind natively instead of passing the callback through the interpreter */
+	appman->lock(app_id);
+	if ((w = script->lookup_widget(app_id, var)))
+		w->gen->bind_callback(w, event_type, callback, arg);
+	appman->unlock(app_id);
 }
 
 
 void dope_bindf(long id, const char *varfmt, const char *event_type,
                 void (*callback)(Event_union *,void *), void *arg,...) {
-	static char varstr[1024];
+	char buf[CMDSTR_SIZE], *varstr;
 	va_list list;
 
 	va_start(list, arg);
-	vsnprintf(varstr, 1024, varfmt, list);
+	varstr = vformat(buf, sizeof(buf), varfmt, list);
 	va_end(list);
+	if (!varstr) return;
+
+	dope_bind(id, varstr, event_type, callback, arg);
 
-	snprintf(cmdstr, 256,"%s.bind(\"%s\", \"%08lx, %08lx\")",
-	         varstr, event_type, (long)callback, (long)arg);
-	dope_cmd(id, cmdstr);
+	if (varstr != buf) free(varstr);
 }
 
 
-void dope_process_event(long app_id)
+int dope_watch(long app_id, const char *var_attr,
+               void (*callback)(Event_union *, void *), void *arg)
+{
+	int ret;
+
+	appman->lock(app_id);
+	ret = watch->add(app_id, var_attr, callback, arg);
+	appman->unlock(app_id);
+	wakeup_waiter();
+	return ret;
+}
+
+
+void dope_unwatch(long app_id, const char *var_attr)
+{
+	appman->lock(app_id);
+	watch->remove(app_id, var_attr);
+	appman->unlock(app_id);
+}
+
+
+/**
+ * Handle input, layout and redraw work that is due
+ *
+ * Must be called with the widget-tree lock held.
+ */
+static void handle_input(void)
 {
 	userstate->handle();
+	layout->flush();
 	redraw->process_pixels(config_redraw_granularity);
 }
 
 
+/**
+ * Return number of threads waiting for events of an application
+ */
+static inline int *waiters(long app_id)
+{
+	return &num_waiters[app_id < 0 || app_id >= MAX_APPS ? 0 : app_id + 1];
+}
+
+
+/**
+ * Check if another waiting thread has events to process
+ *
+ * Must be called with the widget-tree lock held.
+ */
+static int other_waiter_ready(long app_id)
+{
+	if (app_id >= 0 && *waiters(DOPE_ALL_APPS) && msg->pending(DOPE_ALL_APPS))
+		return 1;
+
+	for (long i = 0; i < MAX_APPS; i++)
+		if (i != app_id && *waiters(i) && msg->pending(i))
+			return 1;
+
+	return 0;
+}
+
+
+int dope_wait_event(long app_id, long timeout)
+{
+	u32 last = timer->get_time();
+	int num  = 0;
+
+	/*
+	 * The waiting time is accumulated in 64 bit because the microseconds
+	 * of long timeouts exceed the range of the 32-bit timer values.
+	 */
+	unsigned long long waited = 0, limit = (unsigned long long)timeout*1000;
+
+	appman->lock(app_id);
+	++*waiters(app_id);
+	appman->unlock(app_id);
+
+	wait_lock.lock();
+
+	for (;;) {
+		s32 block_usec;
+		int handover;
+
+		/*
+		 * Event callbacks are executed by the thread that dispatches the
+		 * events, see 'dope_process_event'. Here, the events are just queued.
+		 */
+		appman->lock(app_id);
+		handle_input();
+		num = msg->pending(app_id);
+
+		/* do not block if redraw work is left, otherwise sleep until next tick */
+		block_usec = redraw->get_noque() ? 0 : tick->next_deadline();
+		handover   = !num && other_waiter_ready(app_id);
+		waiting    = !num && !handover;
+		appman->unlock(app_id);
+
+		if (num) break;
+
+		/* let another thread pick up the events queued on its behalf */
+		if (handover) {
+			waiting = 0;
+			wait_lock.unlock();
+			wait_lock.lock();
+			continue;
+		}
+
+		if (timeout >= 0) {
+			u32 now = timer->get_time();
+			waited += timer->get_diff(last, now);
+			last    = now;
+
+			if (waited >= limit) break;
+			if (block_usec < 0 || (unsigned long long)block_usec > limit - waited)
+				block_usec = MIN(limit - waited, 0x7fffffffULL);
+		}
+
+		input->wait(block_usec);
+	}
+
+	waiting = 0;
+	wait_lock.unlock();
+
+	appman->lock(app_id);
+	--*waiters(app_id);
+	appman->unlock(app_id);
+	return num;
+}
+
+
+void dope_process_event(long app_id)
+{
+	struct delivery *d;
+
+	if (dope_wait_event(app_id, -1) <= 0) return;
+
+	appman->lock(app_id);
+	d = msg->dequeue(app_id);
+	appman->unlock(app_id);
+
+	if (!d) return;
+
+	/*
+	 * Event callbacks are executed synchronously by the calling thread but
+	 * without holding the widget-tree lock. So callbacks are free to issue
+	 * commands and to wait for events.
+	 */
+	d->callback(d->ev, d->arg);
+	free(d);
+}
+
+
 void dope_eventloop(long app_id)
 {
 	while (1) dope_process_event(app_id);
@@ -211,7 +505,7 @@ void dope_eventloop(long app_id)
 
 int dope_events_pending(int app_id)
 {
-	return 1;
+	return dope_wait_event(app_id, 0);
 }
 
 
@@ -286,6 +580,11 @@ int init_simple_scheduler(struct dope_services *d)
 	scope     = (struct scope_services     *)d->get_module("Scope 1.0");
 	screen    = (struct screen_services    *)d->get_module("Screen 1.0");
 	timer     = (struct timer_services     *)d->get_module("Timer 1.0");
+	tick      = (struct tick_services      *)d->get_module("Tick 1.0");
+	input     = (struct input_services     *)d->get_module("Input 1.0");
+	msg       = (struct messenger_services *)d->get_module("Messenger 1.0");
+	watch     = (struct watch_services     *)d->get_module("Watch 1.0");
+	layout    = (struct layout_services    *)d->get_module("Layout 1.0");
 
 	dope_services = d;
 
@@ -27,8 +27,7 @@ struct scope;
 #include "widget_help.h"
 
 enum {
-	VAR_HASHTAB_SIZE = 32,   /* applications variable hash table config */
-	VAR_HASH_CHARS   =  5,
+	VAR_HASHTAB_SIZE = 32,   /* initial size of variable hash table */
 };
 
 static struct hashtab_services *hashtab;
@@ -199,7 +198,7 @@ static SCOPE *create(void)
 	SET_WIDGET_DEFAULTS(scope, struct scope, &scope_methods);
 
 	/* create hash table to store the variables of the scope */
-	scope->sd->vars = hashtab->create(VAR_HASHTAB_SIZE, VAR_HASH_CHARS);
+	scope->sd->vars = hashtab->create(VAR_HASHTAB_SIZE);
 	if (!scope->sd->vars) {
 		free(scope);
 		return NULL;
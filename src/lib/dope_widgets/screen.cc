@@ -51,12 +51,33 @@ static struct window_services     *win;
 static struct gfx_services        *gfx;
 static struct frame_services      *frame;
 
+enum {
+	INDEX_MIN_WINS   = 16,   /* smallest window stack worth an index       */
+	INDEX_CELL_SHIFT = 7,    /* index cells are 128x128 pixels             */
+};
+
 struct screen_data {
 	WIDGET *first_win;       /* first window of window stack               */
 	WIDGET *active_win;      /* window that holds the keyboard focus       */
 	struct gfx_ds *scr_ds;   /* GFX container to use for the screen output */
 	BUTTON *menubutton;      /* Button displaying the name of active win   */
 	SCREEN *next;            /* next screen in the screen list             */
+
+	/*
+	 * Window index for 'find'
+	 *
+	 * The screen area is divided into a uniform grid of cells. Each cell
+	 * refers to the windows that overlap the cell, in stacking order.
+	 * The windows of cell 'i' are stored at 'index_wins[index_start[i]]'
+	 * up to 'index_wins[index_start[i + 1] - 1]'.
+	 */
+	int      index_valid;    /* index matches the current window stack     */
+	int      index_cols;     /* number of index columns, 0 if unused       */
+	int      index_rows;     /* number of index rows                       */
+	int      index_cells;    /* number of allocated cells                  */
+	int     *index_start;    /* offsets of cell lists in 'index_wins'      */
+	int      index_size;     /* capacity of 'index_wins'                   */
+	WIDGET **index_wins;     /* concatenated window lists of all cells     */
 };
 
 int init_screen(struct dope_services *d);
@@ -126,6 +147,93 @@ static int draw_rec(GFX_CONTAINER *ds, WIDGET *cw, WIDGET *origin,
 }
 
 
+/**
+ * Determine range of index cells covered by a window
+ *
+ * \return  0 if the window lies outside of the indexed area
+ */
+static inline int index_range(long pos, long size, int num, int *beg, int *end)
+{
+	*beg = MAX(pos, 0) >> INDEX_CELL_SHIFT;
+	*end = (pos + size - 1) >> INDEX_CELL_SHIFT;
+	if (*end >= num) *end = num - 1;
+	return (pos + size > 0) && (*beg <= *end);
+}
+
+
+/**
+ * Build window index from the current window stack
+ *
+ * For small window stacks, the index is not used at all. If memory for
+ * the index cannot be allocated, 'find' falls back to traversing the
+ * window stack.
+ */
+static void rebuild_win_index(SCREEN *scr)
+{
+	struct screen_data *sd = scr->sd;
+	int num_wins = 0, num_cells, total, i, j, c;
+	int x1, y1, x2, y2;
+	WIDGET *cw;
+
+	sd->index_valid = 1;
+	sd->index_cols  = 0;
+
+	for (cw = sd->first_win; cw; cw = cw->wd->next) num_wins++;
+	if (num_wins < INDEX_MIN_WINS || scr->wd->w <= 0 || scr->wd->h <= 0) return;
+
+	sd->index_rows = (scr->wd->h + (1 << INDEX_CELL_SHIFT) - 1) >> INDEX_CELL_SHIFT;
+	num_cells      = (scr->wd->w + (1 << INDEX_CELL_SHIFT) - 1) >> INDEX_CELL_SHIFT;
+	num_cells     *= sd->index_rows;
+
+	if (num_cells > sd->index_cells) {
+		free(sd->index_start);
+		sd->index_start = (int *)malloc((num_cells + 1)*sizeof(int));
+		sd->index_cells = sd->index_start ? num_cells : 0;
+		if (!sd->index_start) return;
+	}
+	sd->index_cols = num_cells / sd->index_rows;
+
+	/* count windows per cell, cell 'i' is counted at 'index_start[i + 1]' */
+	memset(sd->index_start, 0, (num_cells + 1)*sizeof(int));
+	for (cw = sd->first_win; cw; cw = cw->wd->next) {
+		if (!index_range(cw->wd->x, cw->wd->w, sd->index_cols, &x1, &x2)
+		 || !index_range(cw->wd->y, cw->wd->h, sd->index_rows, &y1, &y2)) continue;
+		for (j = y1; j <= y2; j++) for (i = x1; i <= x2; i++)
+			sd->index_start[j*sd->index_cols + i + 1]++;
+	}
+
+	for (c = 0; c < num_cells; c++)
+		sd->index_start[c + 1] += sd->index_start[c];
+
+	total = sd->index_start[num_cells];
+	if (total > sd->index_size) {
+		free(sd->index_wins);
+		sd->index_wins = (WIDGET **)malloc(2*total*sizeof(WIDGET *));
+		sd->index_size = sd->index_wins ? 2*total : 0;
+		if (!sd->index_wins) {
+			sd->index_cols = 0;
+			return;
+		}
+	}
+
+	/*
+	 * Fill in windows in stacking order. Afterwards, 'index_start[i]'
+	 * points to the end of the list of cell 'i', which is the start of
+	 * the list of cell 'i + 1'.
+	 */
+	for (cw = sd->first_win; cw; cw = cw->wd->next) {
+		if (!index_range(cw->wd->x, cw->wd->w, sd->index_cols, &x1, &x2)
+		 || !index_range(cw->wd->y, cw->wd->h, sd->index_rows, &y1, &y2)) continue;
+		for (j = y1; j <= y2; j++) for (i = x1; i <= x2; i++)
+			sd->index_wins[sd->index_start[j*sd->index_cols + i]++] = cw;
+	}
+
+	for (c = num_cells; c > 0; c--)
+		sd->index_start[c] = sd->index_start[c - 1];
+	sd->index_start[0] = 0;
+}
+
+
 /**
  * Determine the last 'staytop'-window of the window stack
  */
@@ -304,6 +412,7 @@ static void chain_window(SCREEN *scr, WIDGET *win, WIDGET *after)
 	}
 
 	win->wd->parent = scr;
+	scr->sd->index_valid = 0;
 }
 
 
@@ -336,6 +445,7 @@ static void unchain_window(SCREEN *scr, WIDGET *win)
 
 	/* isolate unchained window */
 	win->wd->parent = win->wd->next = NULL;
+	scr->sd->index_valid = 0;
 }
 
 
@@ -356,11 +466,32 @@ static inline void redraw_window_area(SCREEN *scr, WIDGET *win)
 
 /**
  * Find widget at a specified absolute screen position
+ *
+ * With many windows on screen, only the windows that overlap the index
+ * cell of the position are asked. Positions outside of the screen area
+ * are looked up by traversing the whole window stack.
  */
 static WIDGET *scr_find(SCREEN *scr, long x, long y)
 {
-	WIDGET *win = scr->sd->first_win;
+	struct screen_data *sd = scr->sd;
+	WIDGET *win = sd->first_win;
 	WIDGET *result;
+	int i, c;
+
+	if (!sd->index_valid) rebuild_win_index(scr);
+
+	if (sd->index_cols && (x >= 0) && (y >= 0)
+	 && ((x >> INDEX_CELL_SHIFT) < sd->index_cols)
+	 && ((y >> INDEX_CELL_SHIFT) < sd->index_rows)) {
+
+		c = (y >> INDEX_CELL_SHIFT)*sd->index_cols + (x >> INDEX_CELL_SHIFT);
+		for (i = sd->index_start[c]; i < sd->index_start[c + 1]; i++) {
+			win = sd->index_wins[i];
+			if ((result = win->gen->find(win, x, y))) return result;
+		}
+		return NULL;
+	}
+
 	while (win != NULL) {
 		if ((result = win->gen->find(win, x, y))) return result;
 		win = win->gen->get_next(win);
@@ -484,6 +615,7 @@ static void scr_set_gfx(SCREEN *scr, GFX_CONTAINER *ds)
 	scr->sd->scr_ds = ds;
 	scr->wd->min_w = scr->wd->max_w = scr->wd->w = gfx->get_width(ds);
 	scr->wd->min_h = scr->wd->max_h = scr->wd->h = gfx->get_height(ds);
+	scr->sd->index_valid = 0;
 
 	/*
 	 * Now we know the size of the gfx container,
@@ -570,6 +702,7 @@ static void scr_place(SCREEN *scr, WIDGET *ww, long x, long y, long w, long h)
 	ww->gen->set_w(ww, w);
 	ww->gen->set_h(ww, h);
 	ww->gen->updatepos(ww);
+	scr->sd->index_valid = 0;
 
 	/* create a view if this window is new */
 	if (!ww->wd->context) ww->wd->context = viewman->create();
@@ -13,11 +13,13 @@
  */
 
 #include <dope/dopedef.h>
+#include <dope/dopelib.h>
+#include <dope/opstream.h>
 
 #include "dopestd.h"
 #include "widget.h"
 #include "appman.h"
-#include "hashtab.h"
+#include "symtab.h"
 #include "tokenizer.h"
 #include "script.h"
 #include "scope.h"
@@ -26,26 +28,24 @@
 
 
 enum {
-	WIDTYPE_HASHTAB_SIZE = 32,
-	WIDTYPE_HASH_CHARS   = 5,
-
-	METHODS_HASHTAB_SIZE = 32,
-	METHODS_HASH_CHARS   = 5,
-
-	ATTRIBS_HASHTAB_SIZE = 32,
-	ATTRIBS_HASH_CHARS   = 5,
-
-	MAX_TOKENS    = 256,  /* max number of command tokens             */
-	MAX_ARGSTRING = 256,  /* max lenght of string argument            */
-	MAX_ARGS      =  16,  /* max number of arguments per dope command */
-	MAX_ERRBUF    = 256,  /* max size of error result substring       */
+	SYMTAB_CHUNK    =    32,  /* granularity of symbol-indexed tables         */
+
+	MIN_TOKENS      =    64,  /* initial capacity of token buffers            */
+	MAX_DESC_TOKENS =   256,  /* max number of tokens of a method signature   */
+	MAX_UPDATES     =    16,  /* max number of deferred update functions      */
+	MAX_ERRBUF      =   256,  /* max size of error result substring           */
+	ARENA_CHUNK     =  4096,  /* default size of command arena chunks         */
+	ARENA_KEEP      = 65536,  /* max size of arena chunk kept across commands */
 };
 
 static struct appman_services    *appman;
-static struct hashtab_services   *hashtab;
+static struct symtab_services    *symtab;
 static struct tokenizer_services *tokenizer;
 
-static HASHTAB *widtypes;
+static struct widtype **widtypes;   /* widget types indexed by symbol ID */
+static s32              widtypes_size;
+
+static s32 sym_set, sym_new, sym_scope;   /* symbols of keywords */
 
 
 /**
@@ -72,32 +72,60 @@ struct assignment {
 };
 
 
+/**
+ * Chunk of memory used for the allocations of one command
+ *
+ * The payload follows the chunk header.
+ */
+struct arena_chunk {
+	struct arena_chunk *next;  /* previously allocated chunk */
+	size_t              size;  /* size of payload            */
+	size_t              used;  /* allocated part of payload  */
+};
+
+
 /**
  * Environment of an interpreter
  */
 struct interpreter {
-	char   *tokens[MAX_TOKENS];   /* pointers token substrings             */
-	u32    tok_len[MAX_TOKENS];   /* lengths of token substrings           */
-	u32    tok_off[MAX_TOKENS];   /* character offsets of token substrings */
-	int    num_tok;               /* total number of tokens                */
-	SCOPE *scope;                 /* root scope of the interpreter         */
-	char  *dst;                   /* buffer for command result string      */
-	int    dst_len;               /* length of result buffer               */
-	char   errbuf[MAX_ERRBUF];    /* used for creating error output        */
-	char   strbuf[MAX_ARGS][MAX_ARGSTRING];
-} cmdint, *ci = &cmdint;
+	char  **tokens;               /* pointers token substrings             */
+	u32    *tok_len;              /* lengths of token substrings           */
+	u32    *tok_off;              /* character offsets of token substrings */
+	s32    *tok_sym;              /* symbol IDs of identifier tokens       */
+	int     num_tok;              /* total number of tokens                */
+	int     max_tok;              /* capacity of token buffers             */
+	SCOPE  *scope;                /* root scope of the interpreter         */
+	char   *dst;                  /* buffer for command result string      */
+	int     dst_len;              /* length of result buffer               */
+	char    errbuf[MAX_ERRBUF];   /* used for creating error output        */
+	struct arena_chunk *arena;    /* memory of the current command         */
+	int     busy;                 /* context is used by a command          */
+	struct interpreter *next;     /* next context of the same application  */
+};
 
 #define INTERPRETER struct interpreter
 
+/*
+ * Interpreter contexts of each application
+ *
+ * Commands of different threads, or commands issued by event callbacks
+ * while another command of the same application is executed, use distinct
+ * contexts. The context lists are protected by the command locks of the
+ * application manager.
+ */
+static INTERPRETER *interps[MAX_APPS];
+
 
 /**
  * Internal widget type representation
  */
 struct widtype {
-	char const *ident;          /* name of widget type          */
-	void    * (*create)(void);  /* widget creation routine      */
-	HASHTAB    *methods;        /* widget methods information   */
-	HASHTAB    *attribs;        /* widget attributs information */
+	char const     *ident;         /* name of widget type             */
+	void        * (*create)(void); /* widget creation routine         */
+	struct method **methods;       /* methods indexed by symbol ID    */
+	struct attrib **attribs;       /* attributes indexed by symbol ID */
+	s32             methods_size;  /* size of methods table           */
+	s32             attribs_size;  /* size of attributes table        */
 };
 
 
@@ -109,7 +137,9 @@ struct methodarg {
 	char *arg_name;          /* argument name                   */
 	char *arg_type;          /* argument type identifier string */
 	char *arg_default;       /* argument default value          */
+	union arg default_arg;   /* converted default value         */
 	int   baseclass;         /* base class of argument type     */
+	s32   arg_sym;           /* symbol ID of argument name      */
 	struct methodarg *next;  /* next argument in argument list  */
 };
 
@@ -123,6 +153,7 @@ struct method {
 	int      ret_baseclass;         /* base class of return type        */
 	void  *(*routine)(void *,...);  /* method address                   */
 	struct methodarg *args;         /* list of arguments                */
+	int      num_args;              /* number of arguments              */
 };
 
 
@@ -194,12 +225,99 @@ int init_script(struct dope_services *d);
  */
 static char *err_token(INTERPRETER *ci, int tok)
 {
-	memcpy(&ci->errbuf[0], ci->tokens[tok], ci->tok_len[tok]);
-	ci->errbuf[ci->tok_len[tok]] = 0;
+	u32 len = ci->tok_len[tok];
+	if (len >= MAX_ERRBUF) len = MAX_ERRBUF - 1;
+	memcpy(&ci->errbuf[0], ci->tokens[tok], len);
+	ci->errbuf[len] = 0;
 	return &ci->errbuf[0];
 }
 
 
+/**
+ * Allocate memory that lives until the end of the current command
+ *
+ * \return  zero-initialized memory or NULL if out of memory
+ */
+static void *arena_alloc(INTERPRETER *ci, size_t size)
+{
+	struct arena_chunk *c = ci->arena;
+	void *result;
+
+	size = (size + sizeof(long) - 1) & ~(sizeof(long) - 1);
+
+	if (!c || c->used + size > c->size) {
+		size_t chunk_size = size > ARENA_CHUNK ? size : ARENA_CHUNK;
+		if (!(c = (struct arena_chunk *)malloc(sizeof(struct arena_chunk) + chunk_size))) {
+			ERROR(printf("Script(arena_alloc): out of memory\n");)
+			return NULL;
+		}
+		c->next   = ci->arena;
+		c->size   = chunk_size;
+		c->used   = 0;
+		ci->arena = c;
+	}
+
+	result   = (char *)(c + 1) + c->used;
+	c->used += size;
+	memset(result, 0, size);
+	return result;
+}
+
+
+/**
+ * Release memory of the previous command
+ *
+ * The most recent chunk is kept for the next command unless it is huge.
+ */
+static void arena_reset(INTERPRETER *ci)
+{
+	struct arena_chunk *c = ci->arena, *next;
+
+	if (!c) return;
+
+	for (next = c->next; next; ) {
+		struct arena_chunk *n = next->next;
+		free(next);
+		next = n;
+	}
+	c->next = NULL;
+	c->used = 0;
+
+	if (c->size > ARENA_KEEP) {
+		free(c);
+		ci->arena = NULL;
+	}
+}
+
+
+/**
+ * Make token buffers large enough to hold the specified number of tokens
+ */
+static int reserve_tokens(INTERPRETER *ci, int num_tok)
+{
+	int max_tok = ci->max_tok ? ci->max_tok : MIN_TOKENS;
+
+	if (num_tok <= ci->max_tok) return 0;
+
+	while (max_tok < num_tok) max_tok *= 2;
+
+	free(ci->tokens); free(ci->tok_len); free(ci->tok_off); free(ci->tok_sym);
+	ci->tokens  = (char **)malloc(sizeof(char *)*max_tok);
+	ci->tok_len = (u32   *)malloc(sizeof(u32)   *max_tok);
+	ci->tok_off = (u32   *)malloc(sizeof(u32)   *max_tok);
+	ci->tok_sym = (s32   *)malloc(sizeof(s32)   *max_tok);
+	ci->max_tok = max_tok;
+
+	if (ci->tokens && ci->tok_len && ci->tok_off && ci->tok_sym) return 0;
+
+	ERROR(printf("Script(reserve_tokens): out of memory\n");)
+	free(ci->tokens); free(ci->tok_len); free(ci->tok_off); free(ci->tok_sym);
+	ci->tokens  = NULL; ci->tok_len = NULL; ci->tok_off = NULL; ci->tok_sym = NULL;
+	ci->max_tok = 0;
+	return -1;
+}
+
+
 /**
  * Utility: checking constraints for command processing
  *
@@ -293,6 +411,55 @@ static char *new_symbol(const char *s,u32 length)
 }
 
 
+/**
+ * Request entry of symbol-indexed table
+ */
+static inline void *get_sym_entry(void *tab, s32 size, s32 sym)
+{
+	if (sym < 0 || sym >= size) return NULL;
+	return ((void **)tab)[sym];
+}
+
+
+/**
+ * Store entry in symbol-indexed table, grow table if needed
+ *
+ * \param tab   pointer to table pointer
+ * \param size  pointer to number of table entries
+ */
+static void set_sym_entry(void *tab, s32 *size, s32 sym, void *value)
+{
+	void ***t = (void ***)tab;
+
+	if (sym < 0) return;
+
+	if (sym >= *size) {
+		s32 new_size = (sym/SYMTAB_CHUNK + 1)*SYMTAB_CHUNK;
+		void **new_tab = (void **)zalloc(sizeof(void *)*new_size);
+		if (!new_tab) {
+			ERROR(printf("Script(set_sym_entry): out of memory\n");)
+			return;
+		}
+		if (*t) {
+			memcpy(new_tab, *t, sizeof(void *)*(*size));
+			free(*t);
+		}
+		*t    = new_tab;
+		*size = new_size;
+	}
+	(*t)[sym] = value;
+}
+
+
+/**
+ * Request widget type by its symbol ID
+ */
+static inline struct widtype *get_widtype(s32 sym)
+{
+	return (struct widtype *)get_sym_entry(widtypes, widtypes_size, sym);
+}
+
+
 static u32 get_baseclass(char *vartype)
 {
 	if (!vartype) return 0;
@@ -301,7 +468,7 @@ static u32 get_baseclass(char *vartype)
 	if (streq(vartype,"string",  7)) return VAR_BASECLASS_STRING;
 	if (streq(vartype,"boolean", 8)) return VAR_BASECLASS_BOOLEAN;
 	if (streq(vartype,"Widget",  7)) return VAR_BASECLASS_WIDGET;
-	if (hashtab->get_elem(widtypes, vartype, 255)) return VAR_BASECLASS_WIDGET;
+	if (get_widtype(symtab->lookup(vartype, 255))) return VAR_BASECLASS_WIDGET;
 	return VAR_BASECLASS_UNDEFINED;
 }
 
@@ -321,13 +488,20 @@ static struct methodarg *new_methodarg(void)
 /**
  * Convert immediate value to function argument
  *
+ * \param ci         interpreter that holds the command, or NULL when
+ *                   converting the default value of a method argument
  * \param baseclass  desired type of the value
  * \param value      string representation of the value
  * \param len        length of value string
  * \param dst        result argument buffer
  * \return           0 on success or a negative error code
+ *
+ * Quoted strings are unescaped in place. The resulting string is a slice
+ * of the command that is terminated at the position of the closing quote.
+ * Unquoted strings are not followed by a free character. Hence, they are
+ * copied to the command arena.
  */
-static int convert_value_arg(int baseclass, char *value, int len,
+static int convert_value_arg(INTERPRETER *ci, int baseclass, char *value, int len,
                              union arg *dst) {
 	switch (baseclass) {
 		case VAR_BASECLASS_LONG:
@@ -349,7 +523,22 @@ static int convert_value_arg(int baseclass, char *value, int len,
 			break;
 
 		case VAR_BASECLASS_STRING:
-			if (extract_string(value, len, dst->string, MAX_ARGSTRING) >= 0) return 0;
+			if (!ci) break;
+			if (*value == '"') {
+				int i;
+				dst->string = value + 1;
+
+				/* strings without escape sequences need no unescaping */
+				for (i = 1; i < len - 1 && value[i] != '\\'; i++);
+				if (len >= 2 && i == len - 1) {
+					value[len - 1] = 0;
+					return 0;
+				}
+				if (extract_string(value, len, dst->string, len) >= 0) return 0;
+				break;
+			}
+			if (!(dst->string = (char *)arena_alloc(ci, len + 1))) break;
+			if (extract_string(value, len, dst->string, len) >= 0) return 0;
 			break;
 
 		case VAR_BASECLASS_FLOAT:
@@ -426,16 +615,13 @@ static int convert_reference_arg(INTERPRETER *ci, int baseclass, int tok,
  * \param tok        index of the first token of the argument
  * \param dst        pointer to argument buffer
  * \return           number of processed tokens
- *
- * The string element of the dst parameter must be initialized
- * to point to a valid string with the length of MAX_ARGSTRING.
  */
 static int convert_arg(INTERPRETER *ci, int baseclass, int tok,
                        union arg *dst) {
 	int ret;
 
 	/* try to convert value argument */
-	ret = convert_value_arg(baseclass, ci->tokens[tok], ci->tok_len[tok], dst);
+	ret = convert_value_arg(ci, baseclass, ci->tokens[tok], ci->tok_len[tok], dst);
 	if (ret >= 0) return 1;
 
 	/* try to convert reference argument */
@@ -469,24 +655,65 @@ static int convert_result(int baseclass, union arg *value, char *dst, int dst_le
 }
 
 
+/**
+ * Look up readable attribute of a widget
+ *
+ * \return  0 on success or a negative error code
+ */
+static int find_attrib(WIDGET *w, char const *name, struct attrib **out)
+{
+	struct widtype *w_type;
+	struct attrib  *attrib;
+
+	if (!w || !name) return DOPECMD_ERR_UNKNOWN_VAR;
+
+	w_type = get_widtype(symtab->lookup(w->gen->get_type(w), 255));
+	if (!w_type) return DOPECMD_ERR_UNKNOWN_VAR;
+
+	attrib = (struct attrib *)get_sym_entry(w_type->attribs, w_type->attribs_size,
+	                                        symtab->lookup(name, 255));
+	if (!attrib)      return DOPECMD_ERR_NO_SUCH_MEMBER;
+	if (!attrib->get) return DOPECMD_ERR_ATTR_R_PERM;
+
+	*out = attrib;
+	return 0;
+}
+
+
+/**
+ * Request current value of attribute
+ */
+static void attrib_value(WIDGET *w, struct attrib *attrib, union arg *res)
+{
+	if (streq(attrib->type, "float", 6)) {
+		float (*float_get)(WIDGET *w) = (float (*)(WIDGET *))attrib->get;
+		res->float_value = float_get(w);
+	} else {
+		res->pointer = attrib->get(w);
+	}
+}
+
+
 /***********************
  ** Service functions **
  ***********************/
 
 static widtype *register_widget_type(char const *widtype_name, void *(*create_func)(void))
 {
-	struct widtype *widtype = (struct widtype *)zalloc(sizeof(struct widtype));
+	struct widtype *widtype;
+	s32 sym = symtab->intern(widtype_name, 255);
 
-	if (hashtab->get_elem(widtypes, widtype_name, 255)) {
+	if (get_widtype(sym)) {
 		INFO(printf("Script(register_widget_type): widget type already exists\n");)
 		return NULL;
 	}
 
+	widtype = (struct widtype *)zalloc(sizeof(struct widtype));
+	if (!widtype) return NULL;
+
 	widtype->create  = create_func;
-	widtype->methods = hashtab->create(METHODS_HASHTAB_SIZE, METHODS_HASH_CHARS);
-	widtype->attribs = hashtab->create(ATTRIBS_HASHTAB_SIZE, ATTRIBS_HASH_CHARS);
 	widtype->ident   = widtype_name;
-	hashtab->add_elem(widtypes, widtype_name, widtype);
+	set_sym_entry(&widtypes, &widtypes_size, sym, widtype);
 
 	/* return pointer to widget type structure */
 	return widtype;
@@ -497,13 +724,14 @@ static void register_widget_method(struct widtype *widtype, char const *desc, vo
 {
 	struct method  *method;
 	struct methodarg *m_arg,**cl;
-	u32  tok_off[MAX_TOKENS];
-	u32  tok_len[MAX_TOKENS];
-	char *tokens[MAX_TOKENS];
+	u32  tok_off[MAX_DESC_TOKENS];
+	u32  tok_len[MAX_DESC_TOKENS];
+	char *tokens[MAX_DESC_TOKENS];
 	u32  num_tok;
 	u32  i;
 
-	num_tok = tokenizer->parse(desc, MAX_TOKENS, tok_off, tok_len);
+	num_tok = tokenizer->parse(desc, MAX_DESC_TOKENS, tok_off, tok_len);
+	if (num_tok > MAX_DESC_TOKENS) num_tok = MAX_DESC_TOKENS;
 	for (i=0; i<num_tok; i++) {
 		tokens[i] = (char *)(desc + tok_off[i]);
 	}
@@ -528,6 +756,7 @@ static void register_widget_method(struct widtype *widtype, char const *desc, vo
 
 			/* read argument name */
 			m_arg->arg_name = new_symbol(desc + tok_off[i], tok_len[i]);
+			m_arg->arg_sym  = symtab->intern(m_arg->arg_name, 255);
 			if (++i >= num_tok) break;
 
 			/* check if a default value is specified */
@@ -535,6 +764,13 @@ static void register_widget_method(struct widtype *widtype, char const *desc, vo
 				if (++i >= num_tok) break;
 				m_arg->arg_default = new_symbol(desc + tok_off[i], tok_len[i]);
 //				printf("arg_default = \"%s\"\n", m_arg->arg_default);
+
+				/* convert default value once, strings are used as they are */
+				if (m_arg->baseclass == VAR_BASECLASS_STRING)
+					m_arg->default_arg.string = m_arg->arg_default;
+				else
+					convert_value_arg(NULL, m_arg->baseclass, m_arg->arg_default,
+					                  255, &m_arg->default_arg);
 				if (++i >= num_tok) break;
 			} else {
 				m_arg->arg_default = NULL;
@@ -543,23 +779,25 @@ static void register_widget_method(struct widtype *widtype, char const *desc, vo
 			m_arg->next = NULL;
 			*cl = m_arg;
 			cl = (struct methodarg **)&m_arg->next;
+			method->num_args++;
 
 			/* skip comma */
 			if (++i >= num_tok) break;
 		}
 	}
 
-	hashtab->add_elem(widtype->methods, method->name, method);
+	set_sym_entry(&widtype->methods, &widtype->methods_size,
+	              symtab->intern(method->name, 255), method);
 }
 
 
 static void register_widget_attrib(struct widtype *widtype, char const *desc,
                                    void *get, void *set, void *update) {
 	struct attrib  *attrib;
-	u32 tok_off[MAX_TOKENS];
-	u32 tok_len[MAX_TOKENS];
+	u32 tok_off[MAX_DESC_TOKENS];
+	u32 tok_len[MAX_DESC_TOKENS];
 
-	tokenizer->parse(desc, MAX_TOKENS, tok_off, tok_len);
+	tokenizer->parse(desc, MAX_DESC_TOKENS, tok_off, tok_len);
 
 	attrib = (struct attrib *)zalloc(sizeof(struct attrib));
 	if (!attrib) return;
@@ -571,43 +809,11 @@ static void register_widget_attrib(struct widtype *widtype, char const *desc,
 	attrib->set       = (void (*)(void*, void*))set;
 	attrib->update    = (void (*)(void*, u16))update;
 
-	hashtab->add_elem(widtype->attribs, attrib->name, attrib);
+	set_sym_entry(&widtype->attribs, &widtype->attribs_size,
+	              symtab->intern(attrib->name, 255), attrib);
 }
 
 
-/**
- * Create new event binding
- *
- * \param w        widget to attach the binding to
- * \param app_id   application to which the events should be delivered
- * \param tokens   array of binding parameter tokens
- * \param tok_len  lengths of tokens
- * \param num_tok  number of tokens that belong to the bind parameters
- * \param err      error code
- * \return         new binding or NULL if an error occured
- *
- * The token list contain the left and right parenthesis. The name
- * is a mandatory argument, followed by multiple -tag value pairs, which
- * describe the arguments to be passed with events and the conditions
- * of the event.
- */
-//static struct new_binding *create_binding(WIDGET *w, SCOPE *rs, char **tokens,
-//                                      int tok_len, int num_tok, int *err) {
-//	struct new_binding *new = zalloc(sizeof(struct new_binding));
-//	int num_args = 0, num_conds = 0;
-//	int i;
-//
-//	*err = 0;
-//	if (!new) return NULL;
-//
-//	/* count conditions and arguments */
-//	for (i=0; i<num_tok; i++) {
-//		
-//	}
-//	return NULL;
-//}
-
-
 /**
  * Call widget function
  *
@@ -690,7 +896,7 @@ static int get_variable(INTERPRETER *ci, SCOPE *s, int tok,
 		if (!type_name)
 			ERR(INVALID_VAR, "variable '%s' has invalid type", err_token(ci, tok));
 
-		*out_w_type = (widtype *)(hashtab->get_elem(widtypes, type_name, 255));
+		*out_w_type = get_widtype(symtab->lookup(type_name, 255));
 
 		/* we can skip two tokens (the variable name and the dot) */
 		return 2;
@@ -704,7 +910,7 @@ static int get_variable(INTERPRETER *ci, SCOPE *s, int tok,
 
 	/* return the scope */
 	*out_w = (WIDGET *)s;
-	*out_w_type = (widtype *)(hashtab->get_elem(widtypes, "Scope", 255));
+	*out_w_type = get_widtype(sym_scope);
 
 	/* keep current token */
 	return 0;
@@ -720,19 +926,16 @@ static int get_variable(INTERPRETER *ci, SCOPE *s, int tok,
  * \param tok      index to tag token followed by its value
  * \param assign   resulting assignment information
  * \return         number of consumed tokens or negative error code
- *
- * The arg->string element of the dst parameter must be initialized to a
- * sting with the length of MAX_ARGSTRING before calling the function.
  */
 static int parse_assignment(INTERPRETER *ci, WIDGET *w, struct widtype *widtype,
                             int tok, struct assignment *assign) {
 	struct attrib *attrib;
-	char *tag = ci->tokens[tok];
 	int ret, consumed_tokens = 0;
 
 	/* determine attribute type */
 	CHECK(constraints_tag(ci, tok));
-	attrib = (struct attrib *)(hashtab->get_elem(widtype->attribs, tag + 1, ci->tok_len[tok] - 1));
+	attrib = (struct attrib *)get_sym_entry(widtype->attribs, widtype->attribs_size,
+	                                        ci->tok_sym[tok]);
 
 	if (!attrib)
 		ERR(UNKNOWN_TAG, "'%s' is not a valid tag", err_token(ci, tok));
@@ -793,11 +996,17 @@ static int exec_set(INTERPRETER *ci, WIDGET *w, struct widtype *w_type, int tok)
 {
 	int ret = 0, i, j;
 	int num_assignments = 0;
-	struct assignment assignments[MAX_ARGS], *ca;
+	struct assignment *assignments, *ca;
 
 	CHECK(constraints_parameter_block(ci, tok));
 	tok++;
 
+	/* each assignment consumes at least a tag and a value token */
+	assignments = (struct assignment *)
+		arena_alloc(ci, sizeof(struct assignment)*((ci->num_tok - tok)/2 + 1));
+	if (!assignments)
+		ERR(NO_MEM, "out of memory for attribute assignments");
+
 	/* parse tag value assignments */
 	for (; tok < ci->num_tok;) {
 
@@ -806,7 +1015,6 @@ static int exec_set(INTERPRETER *ci, WIDGET *w, struct widtype *w_type, int tok)
 
 		/* retrieve information for current assignment */
 		ca = &assignments[num_assignments];
-		ca->arg.string = &ci->strbuf[num_assignments][0];
 		ret = parse_assignment(ci, w, w_type, tok, ca);
 
 		/* return on parse error */
@@ -817,8 +1025,7 @@ static int exec_set(INTERPRETER *ci, WIDGET *w, struct widtype *w_type, int tok)
 
 		/* skip processed tokens */
 		tok += ret;
-		if (num_assignments++ >= MAX_ARGS)
-			ERR(TOO_MANY_ARGS, "too many attribute assignments in one command");
+		num_assignments++;
 	}
 
 	CHECK(constraints_end_of_command(ci, tok));
@@ -848,13 +1055,13 @@ static int exec_set(INTERPRETER *ci, WIDGET *w, struct widtype *w_type, int tok)
 static int exec_function(INTERPRETER *ci, WIDGET *w, struct widtype *w_type,
                          struct method *meth, int tok) {
 	struct methodarg *m_arg, *o_arg;
-	union arg args[20];
+	union arg *args;
 	union arg res;
 	int   i, ret, num_args = 1, num_m_args = 0, num_o_args = 0;
 
-	for (i=1; i<MAX_ARGS; i++) {
-		args[i].string = &ci->strbuf[i][0];
-	}
+	args = (union arg *)arena_alloc(ci, sizeof(union arg)*(meth->num_args + 1));
+	if (!args)
+		ERR(NO_MEM, "out of memory for method arguments");
 	args[0].pointer = w;
 
 	CHECK(constraints_parameter_block(ci, tok));
@@ -893,10 +1100,7 @@ static int exec_function(INTERPRETER *ci, WIDGET *w, struct widtype *w_type,
 		o_arg = m_arg;
 		num_o_args = 0;
 		for (i=num_args; o_arg; o_arg = o_arg->next, i++) {
-			if (i >= MAX_ARGS)
-				ERR(TOO_MANY_ARGS, "too many optional arguments");
-
-			convert_value_arg(o_arg->baseclass, o_arg->arg_default, 255, &args[i]);
+			args[i] = o_arg->default_arg;
 			num_o_args++;
 		}
 	}
@@ -914,11 +1118,10 @@ static int exec_function(INTERPRETER *ci, WIDGET *w, struct widtype *w_type,
 
 	/* set optional parameters that are specified as tag value pairs */
 	for (; tok<ci->num_tok-1;) {
-		char *tag = ci->tokens[tok];
-		
+
 		CHECK(constraints_tag(ci, tok));
 		for (o_arg = m_arg, i = num_args; o_arg; o_arg = o_arg->next, i++)
-			if (streq(tag+1, o_arg->arg_name, ci->tok_len[tok]-1))
+			if (o_arg->arg_sym == ci->tok_sym[tok] && o_arg->arg_sym != SYM_NONE)
 				break;
 
 		if (!o_arg)
@@ -929,6 +1132,7 @@ static int exec_function(INTERPRETER *ci, WIDGET *w, struct widtype *w_type,
 		/* convert default argument string to function argument */
 		CHECK(constraints_value(ci, tok));
 		ret = convert_arg(ci, o_arg->baseclass, tok, &args[i]);
+		if (ret < 0) return ret;
 		tok += ret;
 	}
 	num_args += num_o_args;
@@ -952,19 +1156,56 @@ static int exec_attrib(INTERPRETER *ci, WIDGET *w, struct attrib *attrib, int to
 	if (!attrib->get)
 		ERR(ATTR_R_PERM, "attribute '%s' is not readable", attrib->name);
 
-	if (streq(attrib->type, "float", 6)) {
-		float (*float_get)(WIDGET *w) = (float (*)(WIDGET *))attrib->get;
-		res.float_value = float_get(w);
-	} else {
-		res.pointer = attrib->get(w);
-	}
+	attrib_value(w, attrib, &res);
 	return convert_result(attrib->baseclass, &res, ci->dst, ci->dst_len);
 }
 
 
-static int exec_command(u32 app_id, const char *cmd, char *dst, int dst_len)
+/**
+ * Obtain unused interpreter context of an application
+ */
+static INTERPRETER *acquire_interpreter(u32 app_id)
+{
+	INTERPRETER *ci;
+
+	if (app_id >= MAX_APPS) return NULL;
+
+	appman->lock_cmd(app_id);
+
+	for (ci = interps[app_id]; ci && ci->busy; ci = ci->next);
+
+	if (!ci && (ci = (INTERPRETER *)zalloc(sizeof(INTERPRETER)))) {
+		reserve_tokens(ci, MIN_TOKENS);
+		ci->next        = interps[app_id];
+		interps[app_id] = ci;
+	}
+	if (ci) ci->busy = 1;
+
+	appman->unlock_cmd(app_id);
+
+	if (!ci) ERROR(printf("Script(acquire_interpreter): out of memory\n");)
+	return ci;
+}
+
+
+/**
+ * Hand back interpreter context
+ */
+static void release_interpreter(u32 app_id, INTERPRETER *ci)
+{
+	appman->lock_cmd(app_id);
+	ci->busy = 0;
+	appman->unlock_cmd(app_id);
+}
+
+
+/**
+ * Execute tokenized command
+ *
+ * The widget tree must be locked by the caller.
+ */
+static int exec_tokens(INTERPRETER *ci, u32 app_id)
 {
-	s32 i;
 	WIDGET *w;
 	struct widtype *w_type;
 	struct attrib *attrib;
@@ -973,21 +1214,7 @@ static int exec_command(u32 app_id, const char *cmd, char *dst, int dst_len)
 	void *res_value = NULL;
 	char const *res_type  = NULL;
 	int cmd_type;
-	SCOPE *s;
-
-	ci->dst     = dst;
-	ci->dst_len = dst_len;
-	ci->scope   = appman->get_rootscope(app_id);
-
-	if (!(s = ci->scope)) return DOPE_ERR_PERM;
-
-	ci->num_tok = tokenizer->parse(cmd, MAX_TOKENS, &ci->tok_off[0], &ci->tok_len[0]);
-	for (i=0; i<ci->num_tok; i++) {
-		ci->tokens[i] = (char *)(cmd + ci->tok_off[i]);
-	}
-
-	/* ignore empty commands */
-	if (ci->num_tok <= 0) return 0;
+	SCOPE *s = ci->scope;
 
 	/* set default result string */
 	if (ci->dst) ci->dst[0] = 0;
@@ -1012,10 +1239,10 @@ static int exec_command(u32 app_id, const char *cmd, char *dst, int dst_len)
 		if (ci->num_tok < tok + 4)
 			ERR(UNCOMPLETE, "unexpected end of command");
 
-		if (!streq(ci->tokens[tok + 2], "new", ci->tok_len[tok + 2]))
+		if (ci->tok_sym[tok + 2] != sym_new)
 			ERR(ILLEGAL_CMD, "unknown keyword '%s'", err_token(ci, tok + 2));
 
-		w_type = (widtype *)(hashtab->get_elem(widtypes, ci->tokens[tok + 3], ci->tok_len[tok + 3]));
+		w_type = get_widtype(ci->tok_sym[tok + 3]);
 		if (!w_type)
 			ERR(UNKNOWN_VAR, "widget type '%s' does not exist", err_token(ci, 3));
 
@@ -1047,7 +1274,7 @@ static int exec_command(u32 app_id, const char *cmd, char *dst, int dst_len)
 			}
 			s->scope->set_var(s, res_type, ci->tokens[tok], ci->tok_len[tok], (widget *)res_value);
 		}
-		if (dst) snprintf(dst, dst_len, "ok");
+		if (ci->dst) snprintf(ci->dst, ci->dst_len, "ok");
 		return 0;
 	}
 
@@ -1066,11 +1293,12 @@ static int exec_command(u32 app_id, const char *cmd, char *dst, int dst_len)
 		if (cmd_type == CMD_TYPE_METHOD) {
 
 			/* get information structure of the method to call */
-			meth = (method *)(hashtab->get_elem(w_type->methods, ci->tokens[tok], ci->tok_len[tok]));
+			meth = (method *)get_sym_entry(w_type->methods, w_type->methods_size,
+			                               ci->tok_sym[tok]);
 
 			if (meth) {
 				return exec_function(ci, w, w_type, meth, tok + 1);
-			} else if (streq(ci->tokens[tok], "set", ci->tok_len[tok])) {
+			} else if (ci->tok_sym[tok] == sym_set) {
 				return exec_set(ci, w, w_type, tok + 1);
 			}
 		}
@@ -1078,7 +1306,8 @@ static int exec_command(u32 app_id, const char *cmd, char *dst, int dst_len)
 		if (cmd_type == CMD_TYPE_REQUEST) {
 
 			/* get widget attribute information structure */
-			attrib = (struct attrib *)(hashtab->get_elem(w_type->attribs, ci->tokens[tok], ci->tok_len[tok]));
+			attrib = (struct attrib *)get_sym_entry(w_type->attribs, w_type->attribs_size,
+			                                        ci->tok_sym[tok]);
 
 			if (!attrib)
 				ERR(NO_SUCH_MEMBER, "attribute '%s' does not exist", err_token(ci, tok));
@@ -1094,6 +1323,533 @@ static int exec_command(u32 app_id, const char *cmd, char *dst, int dst_len)
 }
 
 
+static int exec_command(u32 app_id, const char *cmd, char *dst, int dst_len)
+{
+	INTERPRETER *ci;
+	s32 i;
+	int ret = 0;
+	size_t len = strlen(cmd);
+	char *cmdbuf;
+
+	if (!(ci = acquire_interpreter(app_id))) return DOPE_ERR_PERM;
+
+	ci->dst     = dst;
+	ci->dst_len = dst_len;
+
+	/*
+	 * Take a private copy of the command. String arguments are unescaped
+	 * in place and passed to the widgets as slices of this copy.
+	 */
+	arena_reset(ci);
+	if (!(cmdbuf = (char *)arena_alloc(ci, len + 1))) {
+		release_interpreter(app_id, ci);
+		return DOPECMD_ERR_NO_MEM;
+	}
+	memcpy(cmdbuf, cmd, len);
+
+	/* tokenizing does not touch any widgets, so the widget tree stays unlocked */
+	ci->num_tok = tokenizer->parse(cmdbuf, ci->max_tok, ci->tok_off, ci->tok_len);
+	if (ci->num_tok > ci->max_tok) {
+		if (reserve_tokens(ci, ci->num_tok) < 0) {
+			release_interpreter(app_id, ci);
+			return DOPECMD_ERR_NO_MEM;
+		}
+		tokenizer->parse(cmdbuf, ci->max_tok, ci->tok_off, ci->tok_len);
+	}
+	for (i=0; i<ci->num_tok; i++) {
+		ci->tokens[i] = cmdbuf + ci->tok_off[i];
+	}
+	tokenizer->resolve(cmdbuf, ci->num_tok, ci->tok_off, ci->tok_len, ci->tok_sym);
+
+	appman->lock(app_id);
+
+	/* empty commands are ignored */
+	if (!(ci->scope = appman->get_rootscope(app_id)))
+		ret = DOPE_ERR_PERM;
+	else if (ci->num_tok > 0)
+		ret = exec_tokens(ci, app_id);
+
+	appman->unlock(app_id);
+
+	release_interpreter(app_id, ci);
+	return ret;
+}
+
+
+/*************************************
+ ** Binary command stream execution **
+ *************************************/
+
+/**
+ * Read position within a binary command stream
+ */
+struct opreader {
+	u8 const *pos;
+	u8 const *end;
+};
+
+
+/**
+ * Target widget of a binary command stream and its pending update functions
+ */
+struct optarget {
+	WIDGET         *w;
+	struct widtype *w_type;
+	int             num_updates;
+	void          (*updates[MAX_UPDATES]) (void *, u16);
+};
+
+
+static inline int op_read(struct opreader *r, void *dst, u32 len)
+{
+	if (r->pos + len > r->end) return -1;
+	memcpy(dst, r->pos, len);
+	r->pos += len;
+	return 0;
+}
+
+
+/**
+ * Read name and return pointer to its characters within the stream
+ */
+static inline char const *op_read_name(struct opreader *r, u32 *len)
+{
+	u8 l;
+	char const *name;
+
+	if (op_read(r, &l, 1) < 0 || r->pos + l > r->end) return NULL;
+	name = (char const *)r->pos;
+	r->pos += l;
+	*len = l;
+	return name;
+}
+
+
+/**
+ * Utility: return null-terminated copy of a name for error messages
+ */
+static char *err_name(INTERPRETER *ci, char const *name, u32 len)
+{
+	if (len >= MAX_ERRBUF) len = MAX_ERRBUF - 1;
+	memcpy(&ci->errbuf[0], name, len);
+	ci->errbuf[len] = 0;
+	return &ci->errbuf[0];
+}
+
+
+/**
+ * Resolve dotted widget name within the scope hierarchy
+ *
+ * \return  widget or NULL if the name could not be resolved
+ *
+ * An empty name refers to the scope itself.
+ */
+static WIDGET *op_resolve_var(SCOPE *s, char const *name, u32 len,
+                              struct widtype **out_w_type) {
+	u32 i;
+	char const *type_name;
+
+	if (len == 0) {
+		if (out_w_type) *out_w_type = get_widtype(sym_scope);
+		return (WIDGET *)s;
+	}
+
+	/* walk down the subscopes */
+	for (i = 0; i < len; ) {
+		if (name[i] != '.') {
+			i++;
+			continue;
+		}
+		if (!(s = s->scope->get_subscope(s, name, i))) return NULL;
+		name += i + 1;
+		len  -= i + 1;
+		i = 0;
+	}
+
+	if (out_w_type) {
+		type_name   = s->scope->get_vartype(s, name, len);
+		*out_w_type = type_name ? get_widtype(symtab->lookup(type_name, 255)) : NULL;
+	}
+	return s->scope->get_var(s, name, len);
+}
+
+
+/**
+ * Read typed value from stream and convert it to the specified base class
+ *
+ * Long values are accepted for float and boolean arguments. Strings are
+ * passed by reference to the stream buffer.
+ */
+static int op_read_value(struct opreader *r, SCOPE *rs, int baseclass,
+                         union arg *dst) {
+	u8  type, b;
+	u16 slen;
+	u32 len;
+	long l;
+	char const *name;
+
+	if (op_read(r, &type, 1) < 0) return DOPECMD_ERR_UNCOMPLETE;
+
+	switch (type) {
+	case DOPE_OPTYPE_LONG:
+		if (op_read(r, &l, sizeof(l)) < 0) return DOPECMD_ERR_UNCOMPLETE;
+		if      (baseclass == VAR_BASECLASS_LONG)    dst->long_value    = l;
+		else if (baseclass == VAR_BASECLASS_FLOAT)   dst->float_value   = l;
+		else if (baseclass == VAR_BASECLASS_BOOLEAN) dst->boolean_value = !!l;
+		else return DOPECMD_ERR_INVALID_ARG;
+		return 0;
+
+	case DOPE_OPTYPE_FLOAT:
+		if (op_read(r, &dst->float_value, sizeof(float)) < 0) return DOPECMD_ERR_UNCOMPLETE;
+		return baseclass == VAR_BASECLASS_FLOAT ? 0 : DOPECMD_ERR_INVALID_ARG;
+
+	case DOPE_OPTYPE_BOOLEAN:
+		if (op_read(r, &b, 1) < 0) return DOPECMD_ERR_UNCOMPLETE;
+		dst->boolean_value = b;
+		return baseclass == VAR_BASECLASS_BOOLEAN ? 0 : DOPECMD_ERR_INVALID_ARG;
+
+	case DOPE_OPTYPE_STRING:
+		if (op_read(r, &slen, sizeof(slen)) < 0 || r->pos + slen + 1 > r->end)
+			return DOPECMD_ERR_UNCOMPLETE;
+		if (r->pos[slen] != 0) return DOPECMD_ERR_INVALID_ARG;
+		dst->string = (char *)r->pos;
+		r->pos += slen + 1;
+		return baseclass == VAR_BASECLASS_STRING ? 0 : DOPECMD_ERR_INVALID_ARG;
+
+	case DOPE_OPTYPE_WIDGET:
+		if (!(name = op_read_name(r, &len))) return DOPECMD_ERR_UNCOMPLETE;
+		if (baseclass != VAR_BASECLASS_WIDGET) return DOPECMD_ERR_INVALID_ARG;
+		dst->widget = NULL;
+		if (len && !(dst->widget = op_resolve_var(rs, name, len, NULL)))
+			return DOPECMD_ERR_INVALID_ARG;
+		return 0;
+	}
+	return DOPECMD_ERR_INVALID_ARG;
+}
+
+
+/**
+ * Call pending update functions of the target widget
+ */
+static void op_flush_updates(struct optarget *t)
+{
+	for (int i = 0; i < t->num_updates; i++)
+		t->updates[i](t->w, 1);
+	t->num_updates = 0;
+}
+
+
+/**
+ * Defer update function until the target changes or a method is called
+ */
+static void op_add_update(struct optarget *t, void (*update)(void *, u16))
+{
+	int i;
+
+	if (!update) return;
+
+	for (i = 0; i < t->num_updates; i++)
+		if (t->updates[i] == update) return;
+
+	if (t->num_updates >= MAX_UPDATES) op_flush_updates(t);
+	t->updates[t->num_updates++] = update;
+}
+
+
+static int op_set(INTERPRETER *ci, struct opreader *r, SCOPE *rs, struct optarget *t)
+{
+	char const *name;
+	u32 len;
+	int ret;
+	struct attrib *attrib;
+	struct assignment assign;
+
+	if (!(name = op_read_name(r, &len))) return DOPECMD_ERR_UNCOMPLETE;
+	if (!t->w) ERR(UNKNOWN_VAR, "no target widget selected");
+
+	attrib = (struct attrib *)get_sym_entry(t->w_type->attribs, t->w_type->attribs_size,
+	                                        symtab->lookup(name, len));
+	if (!attrib)
+		ERR(UNKNOWN_TAG, "'%s' is not a valid tag", err_name(ci, name, len));
+
+	if (!attrib->set)
+		ERR(ATTR_W_PERM, "attribute '%s' is not configurable", attrib->name);
+
+	ret = op_read_value(r, rs, attrib->baseclass, &assign.arg);
+	if (ret == DOPECMD_ERR_UNCOMPLETE)
+		ERR(UNCOMPLETE, "unexpected end of command stream");
+	if (ret < 0)
+		ERR(INVALID_ARG, "invalid value for attribute '%s'", attrib->name);
+
+	assign.baseclass = attrib->baseclass;
+	assign.set       = (void *)attrib->set;
+	apply_assignment(t->w, &assign);
+	op_add_update(t, attrib->update);
+	return 0;
+}
+
+
+static int op_call(INTERPRETER *ci, struct opreader *r, SCOPE *rs, struct optarget *t)
+{
+	char const *name;
+	u32 len;
+	u8  argc;
+	int i, ret, num_args = 1;
+	struct method *meth;
+	struct methodarg *m_arg;
+	union arg *args;
+
+	if (!(name = op_read_name(r, &len)) || op_read(r, &argc, 1) < 0)
+		return DOPECMD_ERR_UNCOMPLETE;
+	if (!t->w) ERR(UNKNOWN_VAR, "no target widget selected");
+
+	meth = (struct method *)get_sym_entry(t->w_type->methods, t->w_type->methods_size,
+	                                      symtab->lookup(name, len));
+	if (!meth)
+		ERR(NO_SUCH_MEMBER, "method '%s' does not exist", err_name(ci, name, len));
+
+	arena_reset(ci);
+	if (!(args = (union arg *)arena_alloc(ci, sizeof(union arg)*(meth->num_args + 1))))
+		ERR(NO_MEM, "out of memory for method arguments");
+	args[0].pointer = t->w;
+
+	/* positional arguments */
+	for (i = 0, m_arg = meth->args; i < argc; i++, m_arg = m_arg->next) {
+		if (!m_arg)
+			ERR(TOO_MANY_ARGS, "too many arguments for method '%s'", meth->name);
+
+		ret = op_read_value(r, rs, m_arg->baseclass, &args[num_args++]);
+		if (ret == DOPECMD_ERR_UNCOMPLETE)
+			ERR(UNCOMPLETE, "unexpected end of command stream");
+		if (ret < 0)
+			ERR(INVALID_ARG, "invalid argument '%s'", m_arg->arg_name);
+	}
+
+	/* default values of omitted arguments */
+	for (; m_arg; m_arg = m_arg->next) {
+		if (!m_arg->arg_default)
+			ERR(MISSING_ARG, "missing mandatory argument '%s'", m_arg->arg_name);
+
+		args[num_args++] = m_arg->default_arg;
+	}
+
+	/* the method must observe all attribute changes made so far */
+	op_flush_updates(t);
+	call_routine(meth->routine, num_args, args);
+	return 0;
+}
+
+
+/**
+ * Execute binary command stream
+ *
+ * The widget tree must be locked by the caller.
+ */
+static int exec_opstream(INTERPRETER *ci, SCOPE *rs, void const *buf, size_t len)
+{
+	struct opreader r;
+	struct optarget t;
+	char const *name;
+	u32 name_len;
+	u8  op;
+	int ret = 0;
+
+	r.pos = (u8 const *)buf;
+	r.end = r.pos + len;
+	t.w = NULL;
+	t.w_type = NULL;
+	t.num_updates = 0;
+
+	while (ret >= 0 && op_read(&r, &op, 1) == 0) {
+		switch (op) {
+		case DOPE_OP_VAR:
+			op_flush_updates(&t);
+			if (!(name = op_read_name(&r, &name_len))) {
+				ret = DOPECMD_ERR_UNCOMPLETE;
+				break;
+			}
+			t.w = op_resolve_var(rs, name, name_len, &t.w_type);
+			if (!t.w || !t.w_type) {
+				t.w = NULL;
+				printf("Error: unknown variable '%s'\n", err_name(ci, name, name_len));
+				ret = DOPECMD_ERR_UNKNOWN_VAR;
+			}
+			break;
+
+		case DOPE_OP_SET:  ret = op_set(ci, &r, rs, &t);  break;
+		case DOPE_OP_CALL: ret = op_call(ci, &r, rs, &t); break;
+
+		default:
+			printf("Error: illegal opcode %d\n", op);
+			ret = DOPECMD_ERR_ILLEGAL_CMD;
+		}
+	}
+	op_flush_updates(&t);
+	return ret;
+}
+
+
+static WIDGET *lookup_widget(u32 app_id, char const *name)
+{
+	SCOPE *rs = appman->get_rootscope(app_id);
+	if (!rs || !name) return NULL;
+
+	return op_resolve_var(rs, name, strlen(name), NULL);
+}
+
+
+static int get_attrib(WIDGET *w, char const *name, char *dst, int dst_len)
+{
+	struct attrib *attrib;
+	union arg res;
+	int err;
+
+	if ((err = find_attrib(w, name, &attrib))) return err;
+
+	attrib_value(w, attrib, &res);
+	convert_result(attrib->baseclass, &res, dst, dst_len);
+	return 0;
+}
+
+
+static int read_attrib(WIDGET *w, char const *name, Attrib_event *dst)
+{
+	struct attrib *attrib;
+	union arg res;
+	int err;
+
+	if ((err = find_attrib(w, name, &attrib))) return err;
+
+	attrib_value(w, attrib, &res);
+	switch (attrib->baseclass) {
+		case VAR_BASECLASS_LONG:
+			dst->value_type = ATTRIB_TYPE_LONG;
+			dst->long_value = res.long_value;
+			return 0;
+		case VAR_BASECLASS_BOOLEAN:
+			dst->value_type = ATTRIB_TYPE_BOOLEAN;
+			dst->long_value = res.long_value;
+			return 0;
+		case VAR_BASECLASS_FLOAT:
+			dst->value_type  = ATTRIB_TYPE_FLOAT;
+			dst->float_value = res.float_value;
+			return 0;
+		case VAR_BASECLASS_STRING:
+			dst->value_type = ATTRIB_TYPE_STRING;
+			dst->string     = res.string ? res.string : "";
+			return 0;
+		case VAR_BASECLASS_WIDGET:
+			dst->value_type = ATTRIB_TYPE_WIDGET;
+			dst->long_value = (long)res.pointer;
+			return 0;
+	}
+	return DOPECMD_ERR_INVALID_ARG;
+}
+
+
+/**
+ * Read one entry of a bulk request
+ *
+ * \param strbuf  remaining string buffer, advanced by the stored string
+ */
+static int req_entry(SCOPE *rs, struct Dope_req_entry *e, char **strbuf, int *strbuf_size)
+{
+	Attrib_event value;
+	WIDGET *w;
+	int len, dot, err;
+
+	if (!e->path) return DOPECMD_ERR_INVALID_ARG;
+
+	/* split into variable and attribute name at the last dot */
+	len = strlen(e->path);
+	for (dot = len - 1; dot >= 0 && e->path[dot] != '.'; dot--);
+	if (dot < 0) return DOPECMD_ERR_INVALID_ARG;
+
+	if (!(w = op_resolve_var(rs, e->path, dot, NULL)))
+		return DOPECMD_ERR_UNKNOWN_VAR;
+
+	if ((err = read_attrib(w, e->path + dot + 1, &value)))
+		return err;
+
+	e->value_type  = value.value_type;
+	e->long_value  = value.long_value;
+	e->float_value = value.float_value;
+
+	if (value.value_type != ATTRIB_TYPE_STRING) return 0;
+
+	/* copy string into the caller's buffer, the last byte stays reserved */
+	len = strlen(value.string);
+	e->string = "";
+	if (*strbuf_size <= 0) return DOPECMD_WARN_TRUNC_RET_STR;
+
+	err = 0;
+	if (len >= *strbuf_size) {
+		len = *strbuf_size - 1;
+		err = DOPECMD_WARN_TRUNC_RET_STR;
+	}
+	memcpy(*strbuf, value.string, len);
+	(*strbuf)[len] = 0;
+	e->string     = *strbuf;
+	*strbuf      += len + 1;
+	*strbuf_size -= len + 1;
+	return err;
+}
+
+
+static int exec_ops(u32 app_id, void const *buf, size_t len)
+{
+	INTERPRETER *ci;
+	SCOPE *rs;
+	int ret;
+
+	if (!(ci = acquire_interpreter(app_id))) return DOPE_ERR_PERM;
+
+	ci->dst     = NULL;
+	ci->dst_len = 0;
+
+	appman->lock(app_id);
+
+	if (!(rs = appman->get_rootscope(app_id)))
+		ret = DOPE_ERR_PERM;
+	else
+		ret = exec_opstream(ci, rs, buf, len);
+
+	appman->unlock(app_id);
+
+	release_interpreter(app_id, ci);
+	return ret;
+}
+
+
+static int req_multi(u32 app_id, struct Dope_req_entry *entries, int num,
+                     char *strbuf, int strbuf_size)
+{
+	SCOPE *rs;
+	int ret = 0;
+
+	if (!entries) return DOPECMD_ERR_INVALID_ARG;
+	if (!strbuf) strbuf_size = 0;
+
+	appman->lock(app_id);
+
+	rs = appman->get_rootscope(app_id);
+	for (int i = 0; i < num; i++) {
+		struct Dope_req_entry *e = &entries[i];
+
+		e->value_type  = (Attrib_type)0;
+		e->long_value  = 0;
+		e->float_value = 0;
+		e->string      = NULL;
+		e->error       = rs ? req_entry(rs, e, &strbuf, &strbuf_size) : DOPE_ERR_PERM;
+
+		if (e->error && !ret) ret = e->error;
+	}
+
+	appman->unlock(app_id);
+	return ret;
+}
+
+
 /**************************************
  ** Service structure of this module **
  **************************************/
@@ -1103,6 +1859,11 @@ static struct script_services services = {
 	register_widget_method,
 	register_widget_attrib,
 	exec_command,
+	exec_ops,
+	lookup_widget,
+	get_attrib,
+	read_attrib,
+	req_multi,
 };
 
 
@@ -1112,13 +1873,14 @@ static struct script_services services = {
 
 int init_script(struct dope_services *d)
 {
-	hashtab   = (hashtab_services   *)(d->get_module("HashTable 1.0"));
+	symtab    = (symtab_services    *)(d->get_module("SymbolTable 1.0"));
 	appman    = (appman_services    *)(d->get_module("ApplicationManager 1.0"));
 	tokenizer = (tokenizer_services *)(d->get_module("Tokenizer 1.0"));
 
-	INFO(printf("creating hashtab:\n");)
-	widtypes = hashtab->create(WIDTYPE_HASHTAB_SIZE, WIDTYPE_HASH_CHARS);
-	INFO(printf("hashtab created\n");)
+	/* intern keywords of the command language */
+	sym_set   = symtab->intern("set",   255);
+	sym_new   = symtab->intern("new",   255);
+	sym_scope = symtab->intern("Scope", 255);
 
 	d->register_module("Script 1.0",&services);
 	return 1;
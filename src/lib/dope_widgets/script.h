@@ -16,6 +16,8 @@
 #define _DOPE_SCRIPT_H_
 
 struct widtype;
+struct Attrib_event;
+struct Dope_req_entry;
 struct script_services
 {
 	struct widtype *(*reg_widget_type) (char const *widtype_name, void *(*create_func)(void));
@@ -23,6 +25,41 @@ struct script_services
 	void  (*reg_widget_method) (struct widtype *, char const *desc, void *methadr);
 	void  (*reg_widget_attrib) (struct widtype *, char const *desc, void *get, void *set, void *update);
 	int   (*exec_command)      (u32 app_id, char const *cmd, char *dst, int dst_len);
+	int   (*exec_ops)          (u32 app_id, void const *buf, size_t len);
+
+	/**
+	 * Look up widget by its variable name within the application's scope
+	 *
+	 * The name may refer to widgets of sub scopes using dots. The caller
+	 * must hold the widget-tree lock.
+	 */
+	struct widget *(*lookup_widget) (u32 app_id, char const *name);
+
+	/**
+	 * Read attribute of a widget in its textual representation
+	 *
+	 * \return  0 on success or a negative error code if the attribute
+	 *          does not exist or is not readable
+	 */
+	int (*get_attrib) (struct widget *w, char const *name, char *dst, int dst_len);
+
+	/**
+	 * Read attribute of a widget as typed value
+	 *
+	 * \return  0 on success or a negative error code
+	 *
+	 * Only the value fields of 'dst' are assigned. A string value refers
+	 * to the widget's data and stays valid until the widget changes.
+	 */
+	int (*read_attrib) (struct widget *w, char const *name, struct Attrib_event *dst);
+
+	/**
+	 * Read several attributes given as "var.attr" paths
+	 *
+	 * \return  0 on success or the error code of the first failed entry
+	 */
+	int (*req_multi) (u32 app_id, struct Dope_req_entry *entries, int num,
+	                  char *strbuf, int strbuf_size);
 };
 
 
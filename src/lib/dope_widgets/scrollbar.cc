@@ -375,7 +375,7 @@ static void scrollbar_set_view_offset (SCROLLBAR *s, s32 new_view_offset)
 
 	/* send change event to the application */
 	{
-		char const *message = s->gen->get_bind_msg(s, "change");
+		struct binding *message = s->gen->get_binding(s, "change");
 		int         app_id  = s->gen->get_app_id(s);
 		if (message) msg->send_action_event(app_id, "change", message);
 	}
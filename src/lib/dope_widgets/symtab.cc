@@ -0,0 +1,115 @@
+/*
+ * \brief   DOpE symbol table module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * This module assigns dense integer IDs to the
+ * identifiers of the command language such as
+ * widget types, method names and attribute
+ * names. Once resolved, those identifiers can
+ * be used as indices into dispatch tables.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#include "dopestd.h"
+#include "hashtab.h"
+#include "symtab.h"
+
+enum {
+	SYM_HASHTAB_SIZE = 256,  /* initial size of symbol hash table */
+	SYM_NAMES_CHUNK  = 64,   /* granularity of name array growth  */
+};
+
+static struct hashtab_services *hashtab;
+
+static HASHTAB     *syms;       /* maps identifier to symbol ID + 1 */
+static char const **names;      /* maps symbol ID to identifier     */
+static s32          num_syms;   /* number of interned symbols       */
+static s32          max_syms;   /* capacity of names array          */
+
+int init_symtab(struct dope_services *d);
+
+
+/***********************
+ ** Service functions **
+ ***********************/
+
+static s32 symtab_lookup(char const *ident, unsigned len)
+{
+	adr value = (adr)hashtab->get_elem(syms, ident, len);
+	return value ? (s32)(value - 1) : SYM_NONE;
+}
+
+
+static s32 symtab_intern(char const *ident, unsigned len)
+{
+	s32 sym = symtab_lookup(ident, len);
+	if (sym != SYM_NONE) return sym;
+
+	/* grow name array */
+	if (num_syms == max_syms) {
+		char const **new_names = (char const **)zalloc(sizeof(char *)*(max_syms + SYM_NAMES_CHUNK));
+		if (!new_names) {
+			ERROR(printf("SymbolTable(intern): out of memory\n");)
+			return SYM_NONE;
+		}
+		if (names) {
+			memcpy(new_names, names, sizeof(char *)*max_syms);
+			free(names);
+		}
+		names     = new_names;
+		max_syms += SYM_NAMES_CHUNK;
+	}
+
+	/* create null-terminated copy of identifier */
+	unsigned ident_len = 0;
+	while (ident_len < len && ident[ident_len]) ident_len++;
+
+	char *name = (char *)zalloc(ident_len + 1);
+	if (!name) return SYM_NONE;
+	memcpy(name, ident, ident_len);
+
+	sym = num_syms++;
+	names[sym] = name;
+	hashtab->add_elem(syms, name, (void *)(adr)(sym + 1));
+	return sym;
+}
+
+
+static char const *symtab_name(s32 sym)
+{
+	if (sym < 0 || sym >= num_syms) return "";
+	return names[sym];
+}
+
+
+/**************************************
+ ** Service structure of this module **
+ **************************************/
+
+static struct symtab_services services = {
+	symtab_intern,
+	symtab_lookup,
+	symtab_name,
+};
+
+
+/************************
+ ** Module entry point **
+ ************************/
+
+int init_symtab(struct dope_services *d)
+{
+	hashtab = (hashtab_services *)(d->get_module("HashTable 1.0"));
+
+	syms = hashtab->create(SYM_HASHTAB_SIZE);
+
+	d->register_module("SymbolTable 1.0", &services);
+	return 1;
+}
@@ -0,0 +1,41 @@
+/*
+ * \brief   Interface of symbol table module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _DOPE_SYMTAB_H_
+#define _DOPE_SYMTAB_H_
+
+enum { SYM_NONE = -1 };   /* identifier is not a known symbol */
+
+struct symtab_services {
+
+	/**
+	 * Return symbol ID of identifier, create a new symbol if needed
+	 *
+	 * Symbol IDs are dense and start at zero. The identifier is considered
+	 * up to len characters or up to its null-termination.
+	 */
+	s32 (*intern) (char const *ident, unsigned len);
+
+	/**
+	 * Return symbol ID of identifier or SYM_NONE if it is not interned
+	 */
+	s32 (*lookup) (char const *ident, unsigned len);
+
+	/**
+	 * Return identifier string of symbol
+	 */
+	char const *(*name) (s32 sym);
+};
+
+
+#endif /* _DOPE_SYMTAB_H_ */
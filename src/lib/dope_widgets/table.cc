@@ -0,0 +1,627 @@
+/*
+ * \brief   DOpE Table widget module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * A Table displays a large number of text rows, typically as the content
+ * of a scrolling Frame. The content of the rows is not stored by the
+ * Table. Only the rows around the visible area are materialized. Missing
+ * rows are requested from the client via a 'rows' event, which the client
+ * answers by calling 'setrow' for each requested row. Row slots are
+ * recycled while scrolling.
+ *
+ * Rows have either a fixed height or their height is measured from the
+ * number of lines of their cells. Measured row offsets are kept in a
+ * Fenwick tree, so that the row at a pixel position and the offset of a
+ * row are found in logarithmic time.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+struct table;
+#define WIDGET struct table
+
+#include <dope/dopedef.h>
+#include <dope/dopelib.h>
+
+/* local includes */
+#include "dopestd.h"
+#include "table.h"
+#include "gfx.h"
+#include "fontman.h"
+#include "script.h"
+#include "widget_data.h"
+#include "widget_help.h"
+#include "widman.h"
+#include "messenger.h"
+#include "redraw.h"
+#include "fenwick.h"
+
+static struct widman_services    *widman;
+static struct gfx_services       *gfx;
+static struct fontman_services   *font;
+static struct script_services    *script;
+static struct messenger_services *msg;
+static struct redraw_services    *redraw;
+
+enum {
+	MAX_COLUMNS   = 32,   /* max number of columns                     */
+	DEFAULT_COL_W = 80,   /* width of columns without configured size  */
+	OVERSCAN      = 8,    /* rows materialized around the visible area */
+	PAD_X         = 3,    /* horizontal distance of text to cell border */
+	PAD_Y         = 1,    /* vertical distance of text to cell border  */
+};
+
+struct row_slot {
+	long  row;                       /* row shown by the slot or -1   */
+	char *text;                      /* null-separated cell lines or
+	                                    NULL while the row is requested */
+	u8    num_cells;                 /* number of cells in 'text'     */
+	u8    cell_lines[MAX_COLUMNS];   /* number of lines per cell      */
+};
+
+struct table_data {
+	long             num_rows;
+	long             num_cols;
+	long             col_w[MAX_COLUMNS];  /* column widths             */
+	long             row_h;          /* fixed row height or 0 (measured) */
+	s16              font_id;
+	u16             *heights;        /* measured row heights           */
+	long            *index;          /* Fenwick tree over 'heights'    */
+	struct row_slot *slots;          /* materialized rows              */
+	long             num_slots;      /* number of row slots            */
+	long             mat_first;      /* first materialized row         */
+	long             mat_last;       /* last materialized row          */
+};
+
+int init_table(struct dope_services *d);
+
+static const color_t BLACK_SOLID = GFX_RGBA(0, 0, 0, 255);
+static const color_t BLACK_MIXED = GFX_RGBA(0, 0, 0, 48);
+
+
+/********************************
+ ** Functions for internal use **
+ ********************************/
+
+static inline long line_height(TABLE *t)
+{
+	return font->calc_str_height(t->td->font_id, "");
+}
+
+
+/**
+ * Return max number of lines of the cells of a row
+ */
+static int row_lines(char const *text)
+{
+	int max = 1, lines = 1;
+
+	for (; *text; text++) {
+		if (*text == '\n') max = MAX(max, ++lines);
+		if (*text == '\t') lines = 1;
+	}
+	return max;
+}
+
+
+static inline long measured_height(TABLE *t, int lines)
+{
+	return MIN(lines*line_height(t) + 2*PAD_Y, 0xffff);
+}
+
+
+/**
+ * Set up index of measured row heights
+ *
+ * Rows that were not measured yet are assumed to have a single line. If
+ * there is not enough memory, the table falls back to fixed row heights.
+ */
+static void build_index(TABLE *t)
+{
+	long n = t->td->num_rows;
+
+	free(t->td->heights); t->td->heights = NULL;
+	free(t->td->index);   t->td->index   = NULL;
+	if (t->td->row_h) return;
+
+	t->td->heights = (u16  *)malloc(n*sizeof(u16));
+	t->td->index   = (long *)zalloc((n + 1)*sizeof(long));
+	if (!t->td->heights || !t->td->index) {
+		ERROR(printf("Table(build_index): out of memory!\n");)
+		free(t->td->heights); t->td->heights = NULL;
+		free(t->td->index);   t->td->index   = NULL;
+		t->td->row_h = line_height(t) + 2*PAD_Y;
+		return;
+	}
+
+	for (long i = 0; i < n; i++)
+		t->td->heights[i] = measured_height(t, 1);
+
+	/* materialized rows are measured already */
+	for (long i = 0; i < t->td->num_slots; i++) {
+		struct row_slot *s = &t->td->slots[i];
+		int lines = 1;
+		if (s->row < 0 || s->row >= n || !s->text) continue;
+		for (int c = 0; c < s->num_cells; c++) lines = MAX(lines, s->cell_lines[c]);
+		t->td->heights[s->row] = measured_height(t, lines);
+	}
+
+	/* offsets of the rows */
+	for (long i = 0; i < n; i++)
+		t->td->index[i + 1] = t->td->heights[i];
+	fenwick_build(t->td->index, n);
+}
+
+
+static inline long row_offset(TABLE *t, long row)
+{
+	return t->td->row_h ? row*t->td->row_h : fenwick_prefix(t->td->index, row);
+}
+
+
+static inline long row_height(TABLE *t, long row)
+{
+	return t->td->row_h ? t->td->row_h : t->td->heights[row];
+}
+
+
+static inline long total_height(TABLE *t)
+{
+	return row_offset(t, t->td->num_rows);
+}
+
+
+/**
+ * Return row at the specified offset
+ */
+static inline long row_at(TABLE *t, long offset)
+{
+	long row = t->td->row_h ? offset/t->td->row_h : fenwick_find(t->td->index, t->td->num_rows, offset);
+	return MIN(MAX(row, 0), t->td->num_rows - 1);
+}
+
+
+/*
+ * Row slots
+ */
+
+static void free_slots(TABLE *t)
+{
+	for (long i = 0; i < t->td->num_slots; i++)
+		free(t->td->slots[i].text);
+	free(t->td->slots);
+	t->td->slots     = NULL;
+	t->td->num_slots = 0;
+	t->td->mat_first = t->td->mat_last = -1;
+}
+
+
+/**
+ * Replace row slots by the specified number of empty slots
+ *
+ * \return  0 if out of memory
+ */
+static int alloc_slots(TABLE *t, long num)
+{
+	free_slots(t);
+	t->td->slots = (struct row_slot *)zalloc(num*sizeof(struct row_slot));
+	if (!t->td->slots) {
+		ERROR(printf("Table(alloc_slots): out of memory!\n");)
+		return 0;
+	}
+	for (long i = 0; i < num; i++) t->td->slots[i].row = -1;
+	t->td->num_slots = num;
+	return 1;
+}
+
+
+/**
+ * Return slot that holds the specified row or NULL
+ */
+static inline struct row_slot *slot_of(TABLE *t, long row)
+{
+	struct row_slot *s;
+	if (!t->td->num_slots) return NULL;
+	s = &t->td->slots[row % t->td->num_slots];
+	return s->row == row ? s : NULL;
+}
+
+
+/**
+ * Store content of a row in its slot
+ *
+ * The separators of cells and lines are replaced by null characters.
+ */
+static void store_row(struct row_slot *s, char const *text)
+{
+	int len = strlen(text), cell = 0, lines = 1;
+	char *copy = (char *)malloc(len + 1);
+
+	if (!copy) {
+		ERROR(printf("Table(store_row): out of memory!\n");)
+		return;
+	}
+
+	for (int i = 0; i <= len; i++) {
+		char c = text[i];
+		copy[i] = (c == '\t' || c == '\n') ? 0 : c;
+		if (c == '\n') lines++;
+		if (c == '\t' || c == 0) {
+			if (cell < MAX_COLUMNS) s->cell_lines[cell++] = lines;
+			lines = 1;
+		}
+	}
+
+	free(s->text);
+	s->text      = copy;
+	s->num_cells = cell;
+}
+
+
+/**
+ * Ask the client for the content of rows
+ */
+static void request_rows(TABLE *t, long first, long num)
+{
+	struct binding *b = t->gen->get_binding(t, "rows");
+	Event_union ev;
+
+	if (!b) return;
+
+	ev.type       = EVENT_TYPE_ROWS;
+	ev.rows.first = first;
+	ev.rows.num   = num;
+	msg->send_event(t->gen->get_app_id(t), &ev, b);
+}
+
+
+/**
+ * Assign row slots to the rows around the visible area
+ *
+ * The visible area is the part of the table that lies within its parent.
+ * Rows without content are requested from the client with a single event.
+ * A request that the client did not pick up yet is replaced by the new
+ * one, which therefore covers all rows that are still missing.
+ */
+static void materialize(TABLE *t)
+{
+	WIDGET *p = (WIDGET *)t->gen->get_parent(t);
+	long top, bottom, first, last, req_first = -1, req_last = -1;
+
+	if (!p || !t->td->num_rows) return;
+
+	top    = MAX(0, -t->wd->y);
+	bottom = MIN(total_height(t), p->wd->h - t->wd->y) - 1;
+	if (top > bottom) return;
+
+	first = MAX(row_at(t, top)    - OVERSCAN, 0);
+	last  = MIN(row_at(t, bottom) + OVERSCAN, t->td->num_rows - 1);
+	if (first == t->td->mat_first && last == t->td->mat_last) return;
+
+	/* provide enough slots, keeping some in reserve for larger views */
+	if (last - first + 1 > t->td->num_slots
+	 && !alloc_slots(t, 2*(last - first + 1))) return;
+
+	/* recycle slots of rows that left the materialized range */
+	for (long row = first; row <= last; row++) {
+		struct row_slot *s = &t->td->slots[row % t->td->num_slots];
+
+		if (s->row != row) {
+			free(s->text);
+			s->text      = NULL;
+			s->num_cells = 0;
+			s->row       = row;
+		}
+		if (s->text) continue;
+
+		if (req_first < 0) req_first = row;
+		req_last = row;
+	}
+
+	t->td->mat_first = first;
+	t->td->mat_last  = last;
+
+	if (req_first >= 0) request_rows(t, req_first, req_last - req_first + 1);
+}
+
+
+static void draw_row(TABLE *t, struct gfx_ds *ds, long x, long y, long row)
+{
+	struct row_slot *s = slot_of(t, row);
+	long h  = row_height(t, row);
+	long fh = line_height(t);
+	long cx = x;
+	char const *str;
+
+	gfx->draw_hline(ds, x, y + h - 1, t->wd->w, BLACK_MIXED);
+	if (!s || !s->text) return;
+
+	str = s->text;
+	for (int c = 0; c < s->num_cells && c < t->td->num_cols; c++) {
+
+		/* the last column takes the remaining width */
+		long w = (c == t->td->num_cols - 1) ? x + t->wd->w - cx : t->td->col_w[c];
+
+		gfx->push_clipping(ds, cx, y, w, h);
+		for (int l = 0; l < s->cell_lines[c]; l++) {
+			gfx->draw_string(ds, cx + PAD_X, y + PAD_Y + l*fh, BLACK_SOLID, 0,
+			                 t->td->font_id, str);
+			str += strlen(str) + 1;
+		}
+		gfx->pop_clipping(ds);
+		cx += w;
+	}
+}
+
+
+/****************************
+ ** General widget methods **
+ ****************************/
+
+static int tab_draw(TABLE *t, struct gfx_ds *ds, long x, long y, WIDGET *origin)
+{
+	long cy1, cy2, row, last;
+
+	x += t->wd->x;
+	y += t->wd->y;
+
+	if (origin == t) return 1;
+	if (origin) return 0;
+
+	materialize(t);
+	if (!t->td->num_rows) return 1;
+
+	/* determine rows within the clipping area */
+	cy1 = MAX(0, gfx->get_clip_y(ds) - y);
+	cy2 = MIN(total_height(t), gfx->get_clip_y(ds) + gfx->get_clip_h(ds) - y) - 1;
+	if (cy1 > cy2) return 1;
+
+	gfx->push_clipping(ds, x, y, t->wd->w, t->wd->h);
+	for (row = row_at(t, cy1), last = row_at(t, cy2); row <= last; row++)
+		draw_row(t, ds, x, y + row_offset(t, row), row);
+	gfx->pop_clipping(ds);
+
+	return 1;
+}
+
+
+/**
+ * Determine min/max size of a table
+ *
+ * The height of the table is the sum of all row heights.
+ */
+static void tab_calc_minmax(TABLE *t)
+{
+	long w = 0;
+
+	for (int c = 0; c < t->td->num_cols; c++) w += t->td->col_w[c];
+
+	t->wd->min_w = w;
+	t->wd->max_w = MAX(w, 99999);
+	t->wd->min_h = t->wd->max_h = total_height(t);
+}
+
+
+/**
+ * Free table widget data
+ */
+static void tab_free_data(TABLE *t)
+{
+	free_slots(t);
+	free(t->td->heights);
+	free(t->td->index);
+}
+
+
+/**
+ * Return widget type identifier
+ */
+static char const *tab_get_type(TABLE *t)
+{
+	return "Table";
+}
+
+
+/****************************
+ ** Table specific methods **
+ ****************************/
+
+static void tab_set_rows(TABLE *t, long num_rows)
+{
+	t->td->num_rows = MAX(num_rows, 0);
+
+	/* drop slots of rows that vanished */
+	for (long i = 0; i < t->td->num_slots; i++) {
+		struct row_slot *s = &t->td->slots[i];
+		if (s->row < t->td->num_rows) continue;
+		free(s->text);
+		s->text = NULL;
+		s->row  = -1;
+	}
+	t->td->mat_first = t->td->mat_last = -1;
+
+	build_index(t);
+	t->wd->update |= WID_UPDATE_MINMAX;
+}
+
+
+static long tab_get_rows(TABLE *t)
+{
+	return t->td->num_rows;
+}
+
+
+static void tab_set_columns(TABLE *t, long num_cols)
+{
+	t->td->num_cols = MIN(MAX(num_cols, 1), MAX_COLUMNS);
+	t->wd->update |= WID_UPDATE_MINMAX;
+}
+
+
+static long tab_get_columns(TABLE *t)
+{
+	return t->td->num_cols;
+}
+
+
+static void tab_set_rowheight(TABLE *t, long row_h)
+{
+	t->td->row_h = MAX(row_h, 0);
+	build_index(t);
+	t->td->mat_first = t->td->mat_last = -1;
+	t->wd->update |= WID_UPDATE_MINMAX;
+}
+
+
+static long tab_get_rowheight(TABLE *t)
+{
+	return t->td->row_h;
+}
+
+
+static void tab_set_row(TABLE *t, long row, char const *text)
+{
+	struct row_slot *s;
+	int resized = 0;
+
+	if (row < 0 || row >= t->td->num_rows || !text) return;
+
+	/* measured rows change their height with their content */
+	if (!t->td->row_h) {
+		long h = measured_height(t, row_lines(text));
+		if (h != t->td->heights[row]) {
+			fenwick_add(t->td->index, t->td->num_rows, row, h - t->td->heights[row]);
+			t->td->heights[row] = h;
+			resized = 1;
+		}
+	}
+
+	/* content of rows outside the materialized range is not kept */
+	if ((s = slot_of(t, row))) store_row(s, text);
+
+	if (resized) {
+		t->wd->update |= WID_UPDATE_MINMAX;
+		t->gen->update(t);
+	} else if (s) {
+		long y = row_offset(t, row);
+		redraw->draw_widgetarea(t, 0, y, t->wd->w - 1, y + row_height(t, row) - 1);
+	}
+}
+
+
+static void tab_refresh(TABLE *t)
+{
+	for (long i = 0; i < t->td->num_slots; i++) {
+		free(t->td->slots[i].text);
+		t->td->slots[i].text = NULL;
+		t->td->slots[i].row  = -1;
+	}
+	t->td->mat_first = t->td->mat_last = -1;
+	t->gen->force_redraw(t);
+}
+
+
+/**
+ * Configure column width
+ *
+ * \param size  width in pixels, a negative size selects the default width
+ */
+static void tab_column_config(TABLE *t, long index, long size)
+{
+	if (index < 0 || index >= MAX_COLUMNS) return;
+
+	t->td->col_w[index] = size < 0 ? DEFAULT_COL_W : size;
+	if (index >= t->td->num_cols) t->td->num_cols = index + 1;
+
+	t->wd->update |= WID_UPDATE_MINMAX;
+	t->gen->update(t);
+}
+
+
+static struct widget_methods gen_methods;
+static struct table_methods tab_methods = {
+	tab_set_rows,
+	tab_get_rows,
+	tab_set_row,
+	tab_refresh,
+};
+
+
+/***********************
+ ** Service functions **
+ ***********************/
+
+static TABLE *create(void)
+{
+	TABLE *t = ALLOC_WIDGET(struct table);
+	SET_WIDGET_DEFAULTS(t, struct table, &tab_methods);
+
+	/* set table specific attributes */
+	t->td->num_cols  = 1;
+	t->td->row_h     = line_height(t) + 2*PAD_Y;
+	t->td->mat_first = t->td->mat_last = -1;
+	for (int c = 0; c < MAX_COLUMNS; c++) t->td->col_w[c] = DEFAULT_COL_W;
+	gen_methods.update(t);
+
+	return t;
+}
+
+
+/**************************************
+ ** Service structure of this module **
+ **************************************/
+
+static struct table_services services = {
+	create
+};
+
+
+/************************
+ ** Module entry point **
+ ************************/
+
+static void build_script_lang(void)
+{
+	widtype *widtype;
+
+	widtype = script->reg_widget_type("Table", (void *(*)(void))create);
+
+	script->reg_widget_attrib(widtype, "long rows", (void *)tab_get_rows, (void *)tab_set_rows, (void *)gen_methods.update);
+	script->reg_widget_attrib(widtype, "long columns", (void *)tab_get_columns, (void *)tab_set_columns, (void *)gen_methods.update);
+	script->reg_widget_attrib(widtype, "long rowheight", (void *)tab_get_rowheight, (void *)tab_set_rowheight, (void *)gen_methods.update);
+	script->reg_widget_method(widtype, "void columnconfig(long index,long size=-1)", (void *)tab_column_config);
+	script->reg_widget_method(widtype, "void setrow(long row,string text)", (void *)tab_set_row);
+	script->reg_widget_method(widtype, "void refresh()", (void *)tab_refresh);
+
+	widman->build_script_lang(widtype, &gen_methods);
+}
+
+
+int init_table(struct dope_services *d)
+{
+	widman = (widman_services    *)(d->get_module("WidgetManager 1.0"));
+	gfx    = (gfx_services       *)(d->get_module("Gfx 1.0"));
+	font   = (fontman_services   *)(d->get_module("FontManager 1.0"));
+	script = (script_services    *)(d->get_module("Script 1.0"));
+	msg    = (messenger_services *)(d->get_module("Messenger 1.0"));
+	redraw = (redraw_services    *)(d->get_module("RedrawManager 1.0"));
+
+	/* define general widget functions */
+	widman->default_widget_methods(&gen_methods);
+
+	gen_methods.draw        = tab_draw;
+	gen_methods.get_type    = tab_get_type;
+	gen_methods.calc_minmax = tab_calc_minmax;
+	gen_methods.free_data   = tab_free_data;
+
+	build_script_lang();
+
+	d->register_module("Table 1.0", &services);
+	return 1;
+}
@@ -0,0 +1,53 @@
+/*
+ * \brief   Interface of DOpE Table widget module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _DOPE_TABLE_H_
+#define _DOPE_TABLE_H_
+
+#include "widget.h"
+
+struct table_methods;
+struct table_data;
+
+#define TABLE struct table
+
+struct table {
+	struct widget_methods *gen;
+	struct table_methods  *tab;
+	struct widget_data    *wd;
+	struct table_data     *td;
+};
+
+struct table_methods {
+	void (*set_rows) (TABLE *, long num_rows);
+	long (*get_rows) (TABLE *);
+
+	/**
+	 * Provide content of a row
+	 *
+	 * \param text  cells separated by tabs, lines of a cell separated
+	 *              by newlines
+	 */
+	void (*set_row)  (TABLE *, long row, char const *text);
+
+	/**
+	 * Drop the content of all rows and request the visible rows anew
+	 */
+	void (*refresh)  (TABLE *);
+};
+
+struct table_services {
+	TABLE *(*create) (void);
+};
+
+#endif /* _DOPE_TABLE_H_ */
@@ -0,0 +1,457 @@
+/*
+ * \brief   DOpE TextView widget module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * A TextView displays multi-line text such as logs or configuration files.
+ * It is meant to be used as the content of a Frame, which provides the
+ * scrollbars. The text is stored line by line in a chain of text blocks
+ * that are never moved. A line index refers to the start of each line
+ * within the blocks and caches the pixel width of the line. Appending text
+ * extends the last line in place and adds new lines to the index without
+ * touching the existing text. If the last line runs out of space, it is
+ * moved to a location with twice the needed space, which keeps the copying
+ * costs linear for lines that are appended in small pieces. Only the lines
+ * that intersect the clipping area are drawn.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+struct textview;
+#define WIDGET struct textview
+
+/* local includes */
+#include "dopestd.h"
+#include "textview.h"
+#include "gfx.h"
+#include "fontman.h"
+#include "script.h"
+#include "widget_data.h"
+#include "widget_help.h"
+#include "widman.h"
+#include "redraw.h"
+
+static struct widman_services  *widman;
+static struct gfx_services     *gfx;
+static struct fontman_services *font;
+static struct script_services  *script;
+static struct redraw_services  *redraw;
+
+enum {
+	BLOCK_SIZE = 4096,   /* default size of a text block              */
+	MIN_LINES  = 64,     /* initial capacity of line index            */
+	PAD        = 2,      /* distance of text to the widget border     */
+};
+
+struct text_block {
+	struct text_block *next;
+	s32                size;   /* capacity of block                 */
+	s32                used;   /* number of used bytes              */
+	char              *data;   /* located right after the structure */
+};
+
+struct line {
+	char *text;    /* null-terminated line within a text block */
+	s32   len;     /* length of line in bytes                  */
+	s32   size;    /* bytes reserved for the line              */
+	s32   width;   /* pixel width of line                      */
+};
+
+struct textview_data {
+	struct text_block *first_block;
+	struct text_block *last_block;   /* block that receives new text   */
+	struct line       *lines;        /* line index                     */
+	s32                num_lines;    /* number of lines, at least one  */
+	s32                max_lines;    /* capacity of line index         */
+	s32                text_w;       /* pixel width of widest line     */
+	s16                font_id;
+};
+
+int init_textview(struct dope_services *d);
+
+static const color_t BLACK_SOLID = GFX_RGBA(0, 0, 0, 255);
+
+
+/********************************
+ ** Functions for internal use **
+ ********************************/
+
+static inline s32 line_height(TEXTVIEW *t)
+{
+	return font->calc_str_height(t->td->font_id, "");
+}
+
+
+static void free_text(TEXTVIEW *t)
+{
+	struct text_block *b = t->td->first_block, *next;
+
+	for (; b; b = next) {
+		next = b->next;
+		free(b);
+	}
+	t->td->first_block = t->td->last_block = NULL;
+	t->td->num_lines   = 0;
+	t->td->text_w      = 0;
+}
+
+
+/**
+ * Reserve space for the specified number of bytes at the end of the text
+ *
+ * \return  pointer to reserved space or NULL if out of memory
+ */
+static char *alloc_text(TEXTVIEW *t, s32 len)
+{
+	struct text_block *b = t->td->last_block;
+	char *dst;
+
+	if (!b || b->used + len > b->size) {
+		s32 size = MAX(len, (s32)BLOCK_SIZE);
+
+		b = (struct text_block *)malloc(sizeof(struct text_block) + size);
+		if (!b) {
+			ERROR(printf("TextView(alloc_text): out of memory!\n");)
+			return NULL;
+		}
+		b->next = NULL;
+		b->size = size;
+		b->used = 0;
+		b->data = (char *)((adr)b + sizeof(struct text_block));
+
+		if (t->td->last_block) t->td->last_block->next = b;
+		else                   t->td->first_block      = b;
+		t->td->last_block = b;
+	}
+
+	dst = b->data + b->used;
+	b->used += len;
+	return dst;
+}
+
+
+/**
+ * Start new empty line
+ *
+ * \return  0 if out of memory
+ */
+static int new_line(TEXTVIEW *t)
+{
+	struct line *l;
+	char *text;
+
+	/* enlarge line index */
+	if (t->td->num_lines == t->td->max_lines) {
+		s32 max = t->td->max_lines ? 2*t->td->max_lines : MIN_LINES;
+		struct line *lines = (struct line *)malloc(max*sizeof(struct line));
+		if (!lines) {
+			ERROR(printf("TextView(new_line): out of memory!\n");)
+			return 0;
+		}
+		if (t->td->lines) {
+			memcpy(lines, t->td->lines, t->td->num_lines*sizeof(struct line));
+			free(t->td->lines);
+		}
+		t->td->lines     = lines;
+		t->td->max_lines = max;
+	}
+
+	if (!(text = alloc_text(t, 1))) return 0;
+	text[0] = 0;
+
+	l = &t->td->lines[t->td->num_lines++];
+	l->text  = text;
+	l->len   = 0;
+	l->size  = 1;
+	l->width = 0;
+	return 1;
+}
+
+
+/**
+ * Append characters to the last line
+ *
+ * The line is extended in place if its reserved space suffices or if it
+ * is located at the end of the last text block. Otherwise, it is moved to
+ * a new location that leaves room for further growth.
+ */
+static void extend_line(TEXTVIEW *t, char const *src, s32 len)
+{
+	struct line       *l = &t->td->lines[t->td->num_lines - 1];
+	struct text_block *b = t->td->last_block;
+	s32   need = l->len + len + 1;
+	char *dst;
+
+	if (need > l->size && b && l->text + l->size == b->data + b->used
+	 && b->used + need - l->size <= b->size) {
+		b->used += need - l->size;
+		l->size  = need;
+	}
+
+	if (need > l->size) {
+		if (!(dst = alloc_text(t, 2*need))) return;
+		memcpy(dst, l->text, l->len);
+		l->text = dst;
+		l->size = 2*need;
+	}
+
+	dst = l->text;
+	memcpy(dst + l->len, src, len);
+	dst[l->len + len] = 0;
+	l->width += font->calc_str_width(t->td->font_id, dst + l->len);
+	l->len   += len;
+	t->td->text_w = MAX(t->td->text_w, l->width);
+}
+
+
+/**
+ * Append text, splitting it into lines
+ */
+static void append_text(TEXTVIEW *t, char const *text)
+{
+	if (!t->td->num_lines && !new_line(t)) return;
+
+	while (*text) {
+		s32 len = 0;
+
+		while (text[len] && text[len] != '\n') len++;
+		if (len) extend_line(t, text, len);
+
+		text += len;
+		if (*text == '\n') {
+			if (!new_line(t)) return;
+			text++;
+		}
+	}
+}
+
+
+/****************************
+ ** General widget methods **
+ ****************************/
+
+static int tv_draw(TEXTVIEW *t, struct gfx_ds *ds, long x, long y, WIDGET *origin)
+{
+	s32 lh = line_height(t), first, last;
+
+	x += t->wd->x;
+	y += t->wd->y;
+
+	if (origin == t) return 1;
+	if (origin) return 0;
+	if (!lh) return 1;
+
+	/* determine lines within the clipping area */
+	first = MAX(gfx->get_clip_y(ds) - y - PAD, 0)/lh;
+	last  = MIN((gfx->get_clip_y(ds) + gfx->get_clip_h(ds) - y - PAD)/lh,
+	            t->td->num_lines - 1);
+
+	gfx->push_clipping(ds, x, y, t->wd->w, t->wd->h);
+	for (s32 i = first; i <= last; i++)
+		gfx->draw_string(ds, x + PAD, y + PAD + i*lh, BLACK_SOLID, 0,
+		                 t->td->font_id, t->td->lines[i].text);
+	gfx->pop_clipping(ds);
+
+	return 1;
+}
+
+
+/**
+ * Determine min/max size of a text view
+ *
+ * The text view is as high as its lines and at least as wide as its
+ * widest line.
+ */
+static void tv_calc_minmax(TEXTVIEW *t)
+{
+	t->wd->min_w = t->td->text_w + 2*PAD;
+	t->wd->max_w = MAX(t->wd->min_w, 99999);
+	t->wd->min_h = t->wd->max_h = t->td->num_lines*line_height(t) + 2*PAD;
+}
+
+
+/**
+ * Free text view widget data
+ */
+static void tv_free_data(TEXTVIEW *t)
+{
+	free_text(t);
+	free(t->td->lines);
+}
+
+
+/**
+ * Return widget type identifier
+ */
+static char const *tv_get_type(TEXTVIEW *t)
+{
+	return "TextView";
+}
+
+
+/*******************************
+ ** TextView specific methods **
+ *******************************/
+
+static void tv_clear(TEXTVIEW *t)
+{
+	free_text(t);
+	new_line(t);
+	t->wd->update |= WID_UPDATE_MINMAX;
+}
+
+
+static void tv_set_text(TEXTVIEW *t, char const *text)
+{
+	tv_clear(t);
+	if (text) append_text(t, text);
+}
+
+
+/**
+ * Append text
+ *
+ * If the size of the text view stays the same, only the changed lines
+ * are redrawn.
+ */
+static void tv_append(TEXTVIEW *t, char const *text)
+{
+	s32 first = t->td->num_lines - 1, text_w = t->td->text_w;
+	s32 lh    = line_height(t);
+
+	if (!text || first < 0) return;
+	append_text(t, text);
+
+	if (t->td->num_lines - 1 != first || t->td->text_w != text_w) {
+		t->wd->update |= WID_UPDATE_MINMAX;
+		t->gen->update(t);
+		return;
+	}
+	redraw->draw_widgetarea(t, 0, PAD + first*lh, t->wd->w - 1, PAD + (first + 1)*lh - 1);
+}
+
+
+static void tv_script_clear(TEXTVIEW *t)
+{
+	tv_clear(t);
+	t->gen->update(t);
+}
+
+
+static long tv_get_lines(TEXTVIEW *t)
+{
+	return t->td->num_lines;
+}
+
+
+/**
+ * Set font of text view
+ *
+ * Besides the built-in fonts 'default', 'monospaced', and 'title', a
+ * font can be loaded from the ROM module of the specified name.
+ */
+static void tv_set_font(TEXTVIEW *t, char const *fontname)
+{
+	s32 font_id = font->lookup(fontname);
+	if (font_id >= 0) t->td->font_id = font_id;
+
+	/* recalculate line widths */
+	t->td->text_w = 0;
+	for (s32 i = 0; i < t->td->num_lines; i++) {
+		struct line *l = &t->td->lines[i];
+		l->width = font->calc_str_width(t->td->font_id, l->text);
+		t->td->text_w = MAX(t->td->text_w, l->width);
+	}
+	t->wd->update |= WID_UPDATE_MINMAX;
+}
+
+
+static char const *tv_get_font(TEXTVIEW *t)
+{
+	struct font *f = font->get_by_id(t->td->font_id);
+	return f ? f->name : "";
+}
+
+
+static struct widget_methods gen_methods;
+static struct textview_methods tv_methods = {
+	tv_set_text,
+	tv_append,
+	tv_clear,
+	tv_get_lines,
+};
+
+
+/***********************
+ ** Service functions **
+ ***********************/
+
+static TEXTVIEW *create(void)
+{
+	TEXTVIEW *t = ALLOC_WIDGET(struct textview);
+	SET_WIDGET_DEFAULTS(t, struct textview, &tv_methods);
+
+	/* set text view specific attributes */
+	t->td->font_id = 1;
+	new_line(t);
+	gen_methods.update(t);
+
+	return t;
+}
+
+
+/**************************************
+ ** Service structure of this module **
+ **************************************/
+
+static struct textview_services services = {
+	create
+};
+
+
+/************************
+ ** Module entry point **
+ ************************/
+
+static void build_script_lang(void)
+{
+	widtype *widtype;
+
+	widtype = script->reg_widget_type("TextView", (void *(*)(void))create);
+
+	script->reg_widget_attrib(widtype, "string text", NULL, (void *)tv_set_text, (void *)gen_methods.update);
+	script->reg_widget_attrib(widtype, "string font", (void *)tv_get_font, (void *)tv_set_font, (void *)gen_methods.update);
+	script->reg_widget_attrib(widtype, "long lines", (void *)tv_get_lines, NULL, NULL);
+	script->reg_widget_method(widtype, "void append(string text)", (void *)tv_append);
+	script->reg_widget_method(widtype, "void clear()", (void *)tv_script_clear);
+
+	widman->build_script_lang(widtype, &gen_methods);
+}
+
+
+int init_textview(struct dope_services *d)
+{
+	widman = (widman_services  *)(d->get_module("WidgetManager 1.0"));
+	gfx    = (gfx_services     *)(d->get_module("Gfx 1.0"));
+	font   = (fontman_services *)(d->get_module("FontManager 1.0"));
+	script = (script_services  *)(d->get_module("Script 1.0"));
+	redraw = (redraw_services  *)(d->get_module("RedrawManager 1.0"));
+
+	/* define general widget functions */
+	widman->default_widget_methods(&gen_methods);
+
+	gen_methods.draw        = tv_draw;
+	gen_methods.get_type    = tv_get_type;
+	gen_methods.calc_minmax = tv_calc_minmax;
+	gen_methods.free_data   = tv_free_data;
+
+	build_script_lang();
+
+	d->register_module("TextView 1.0", &services);
+	return 1;
+}
@@ -0,0 +1,54 @@
+/*
+ * \brief   Interface of DOpE TextView widget module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _DOPE_TEXTVIEW_H_
+#define _DOPE_TEXTVIEW_H_
+
+#include "widget.h"
+
+struct textview_methods;
+struct textview_data;
+
+#define TEXTVIEW struct textview
+
+struct textview {
+	struct widget_methods   *gen;
+	struct textview_methods *tv;
+	struct widget_data      *wd;
+	struct textview_data    *td;
+};
+
+struct textview_methods {
+
+	/**
+	 * Replace content of the text view
+	 */
+	void (*set_text) (TEXTVIEW *, char const *text);
+
+	/**
+	 * Append text to the content
+	 *
+	 * The text continues the last line. Newline characters start new
+	 * lines.
+	 */
+	void (*append)   (TEXTVIEW *, char const *text);
+
+	void (*clear)    (TEXTVIEW *);
+	long (*get_lines)(TEXTVIEW *);
+};
+
+struct textview_services {
+	TEXTVIEW *(*create) (void);
+};
+
+#endif /* _DOPE_TEXTVIEW_H_ */
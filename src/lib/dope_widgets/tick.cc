@@ -16,95 +16,160 @@
 #include "timer.h"
 #include "tick.h"
 
-enum { MAX_TICKS = 32 };
+enum { MIN_HEAP_SIZE = 32 };
 
-struct tick;
 struct tick {
 	u32         deadline;            /* next deadline          */
 	u32         usec;                /* duration between ticks */
 	int       (*callback) (void *);  /* tick callback          */
 	void        *arg;                /* callback argument      */
-	struct tick *next;               /* next tick in ticklist  */
+	s32          idx;                /* heap position or -1    */
 };
 
-static struct tick ticks[MAX_TICKS];
-static struct tick *head = NULL;     /* head of tick list */
+/*
+ * Pending ticks are kept in a binary min-heap ordered by deadline. The
+ * earliest deadline is at 'heap[0]'. Deadlines are compared via their
+ * distance so that the wraparound of the timer is handled.
+ */
+static struct tick **heap;           /* tick heap                        */
+static s32           heap_len;       /* number of queued ticks           */
+static s32           heap_size;      /* capacity of heap array           */
+
+static struct tick  *curr_tick;      /* tick whose callback is executed  */
+static int           curr_removed;   /* current tick got removed         */
 
 static struct timer_services *timer;
 
 int init_tick(struct dope_services *d);
 
 
-/***********************
- ** Service functions **
- ***********************/
+/********************************
+ ** Functions for internal use **
+ ********************************/
+
+static inline int earlier(struct tick *t1, struct tick *t2)
+{
+	return (s32)(t1->deadline - t2->deadline) < 0;
+}
+
+
+static inline void heap_set(s32 idx, struct tick *t)
+{
+	heap[idx] = t;
+	t->idx    = idx;
+}
+
+
+static void sift_up(s32 idx)
+{
+	struct tick *t = heap[idx];
+
+	for (; idx > 0 && earlier(t, heap[(idx - 1)/2]); idx = (idx - 1)/2)
+		heap_set(idx, heap[(idx - 1)/2]);
+
+	heap_set(idx, t);
+}
+
+
+static void sift_down(s32 idx)
+{
+	struct tick *t = heap[idx];
+	s32 child;
+
+	for (; (child = 2*idx + 1) < heap_len; idx = child) {
+		if (child + 1 < heap_len && earlier(heap[child + 1], heap[child]))
+			child++;
+		if (!earlier(heap[child], t)) break;
+		heap_set(idx, heap[child]);
+	}
+
+	heap_set(idx, t);
+}
+
 
 /**
- * Schedule new tick event
+ * Schedule tick according to its deadline
+ *
+ * \return  0 if the heap could not be enlarged
  */
-static void queue_tick(struct tick *t)
+static int queue_tick(struct tick *t)
 {
-	struct tick *curr;
-	
-	/* if ticklist is empty add first element */
-	if (!head) {
-		t->next = 0;
-		head    = t;
-		return;
+	if (heap_len == heap_size) {
+		s32 new_size = heap_size ? 2*heap_size : MIN_HEAP_SIZE;
+		struct tick **new_heap = (struct tick **)malloc(new_size*sizeof(struct tick *));
+		if (!new_heap) return 0;
+
+		if (heap) {
+			memcpy(new_heap, heap, heap_len*sizeof(struct tick *));
+			free(heap);
+		}
+		heap      = new_heap;
+		heap_size = new_size;
 	}
 
-	/* if deadline is smaller than any other deadline, put it on the head */
-	if (t->deadline < head->deadline) {
-		t->next = head;
-		head    = t;
-		return;
-	}
+	heap_set(heap_len++, t);
+	sift_up(t->idx);
+	return 1;
+}
 
-	/* find list element with a higher deadline */
-	curr = head;
-	while (curr->next && (curr->next->deadline < t->deadline)) curr = curr->next;
 
-	/* if end of list is reached, append new element */
-	if (!curr->next) {
-		curr->next = t;
-		return;
-	}
+/**
+ * Remove tick from the heap
+ */
+static void dequeue_tick(struct tick *t)
+{
+	s32 idx = t->idx;
+
+	t->idx = -1;
+	if (--heap_len == idx) return;
 
-	/* insert element in middle of list */
-	t->next    = curr->next;
-	curr->next = t;
+	/* fill the gap with the last element and restore the heap property */
+	heap_set(idx, heap[heap_len]);
+	sift_down(idx);
+	sift_up(heap[idx]->idx);
 }
 
 
+/***********************
+ ** Service functions **
+ ***********************/
+
 /**
  * Register new timer tick callback routine
- *
- * \param msec      duration between ticks
- * \param callback  routine that is called for every tick
- * \param arg       private argument for callback
- * \return          1 on success
- *
- * The return code of this function should be evaluated!
  */
-static int tick_add(s32 msec, int (*callback)(void *), void *arg)
+static struct tick *tick_add(s32 msec, int (*callback)(void *), void *arg)
 {
-	int i;
+	struct tick *t = (struct tick *)zalloc(sizeof(struct tick));
+	if (!t) return NULL;
 
-	/* find empty tick slot */
-	for (i=0; i<MAX_TICKS; i++)
-		if (ticks[i].callback == NULL) break;
+	t->usec     = msec * 1000;
+	t->deadline = timer->get_time() + t->usec;
+	t->callback = callback;
+	t->arg      = arg;
 
-	/* no empty tick slot - return 0 */
-	if (i == MAX_TICKS) return 0;
+	if (!queue_tick(t)) {
+		free(t);
+		return NULL;
+	}
+	return t;
+}
 
-	/* put new tick at the beginning of the ticklist */
-	ticks[i].usec     = msec * 1000;
-	ticks[i].deadline = timer->get_time() + ticks[i].usec;
-	ticks[i].callback = callback;
-	ticks[i].arg      = arg;
-	queue_tick(&ticks[i]);
 
-	return 1;
+/**
+ * Cancel tick
+ */
+static void tick_remove(struct tick *t)
+{
+	if (!t) return;
+
+	/* the tick is not queued while its callback is executed */
+	if (t == curr_tick) {
+		curr_removed = 1;
+		return;
+	}
+
+	if (t->idx >= 0) dequeue_tick(t);
+	free(t);
 }
 
 
@@ -114,34 +179,58 @@ static int tick_add(s32 msec, int (*callback)(void *), void *arg)
 static void tick_handle(void)
 {
 	u32 now = timer->get_time();
-	struct tick *curr = head;
-	
-	while ((curr = head) && ((s32)now > (s32)head->deadline)) {
-		void *arg = head->arg;
-
-		/* remove tick from head of the list */
-		head = curr->next;
-		curr->next = NULL;
-
-		if (curr->callback(arg)) {
-			/* tick is still valid - schedule next event */
-			curr->deadline = now + curr->usec;
-			queue_tick(curr);
-		} else {
-			/* mark tick slot as free */
-			curr->callback = NULL;
+	struct tick *t;
+
+	while (heap_len && ((s32)(now - heap[0]->deadline) > 0)) {
+		int keep_ticking;
+
+		t = heap[0];
+		dequeue_tick(t);
+
+		curr_tick    = t;
+		curr_removed = 0;
+		keep_ticking = t->callback(t->arg);
+		curr_tick    = NULL;
+
+		if (!keep_ticking || curr_removed) {
+			free(t);
+			continue;
 		}
+
+		/*
+		 * Tick is still valid - schedule next event. If this fails, the
+		 * handle stays valid until the owner removes the tick.
+		 */
+		t->deadline = now + t->usec;
+		queue_tick(t);
 	}
 }
 
 
+/**
+ * Return time until the earliest tick deadline
+ */
+static s32 tick_next_deadline(void)
+{
+	s32 left;
+
+	if (!heap_len) return -1;
+
+	/* ticks are due once the deadline is passed, see 'tick_handle' */
+	left = (s32)(heap[0]->deadline - timer->get_time()) + 1;
+	return left < 0 ? 0 : left;
+}
+
+
 /**************************************
  ** Service structure of this module **
  **************************************/
 
 static struct tick_services services = {
 	tick_add,
+	tick_remove,
 	tick_handle,
+	tick_next_deadline,
 };
 
 
@@ -15,9 +15,38 @@
 #ifndef _DOPE_TICK_H_
 #define _DOPE_TICK_H_
 
+struct tick;
 struct tick_services {
-	int   (*add)    (s32 msec, int (*callback)(void *), void *arg);
+
+	/**
+	 * Register tick callback
+	 *
+	 * \param msec      duration between ticks
+	 * \param callback  routine that is called for every tick, the tick
+	 *                  is removed when the callback returns 0
+	 * \param arg       private argument for callback
+	 * \return          tick handle or NULL if out of memory
+	 *
+	 * The handle becomes invalid once the callback returned 0 or the tick
+	 * got removed via 'remove'.
+	 */
+	struct tick *(*add) (s32 msec, int (*callback)(void *), void *arg);
+
+	/**
+	 * Cancel tick
+	 *
+	 * It is safe to remove a tick from within its own callback.
+	 */
+	void  (*remove) (struct tick *);
+
 	void  (*handle) (void);
+
+	/**
+	 * Return time until the next tick is due
+	 *
+	 * \return  microseconds until the next tick or -1 if no tick is scheduled
+	 */
+	s32   (*next_deadline) (void);
 };
 
 #endif /* _DOPE_TICK_H_ */
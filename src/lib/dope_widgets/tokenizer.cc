@@ -17,8 +17,11 @@
  */
 
 #include "dopestd.h"
+#include "symtab.h"
 #include "tokenizer.h"
 
+static struct symtab_services *symtab;
+
 int init_tokenizer(struct dope_services *d);
 
 
@@ -152,15 +155,19 @@ static int parse(const char *s, u32 max_tok, u32 *offbuf, u32 *lenbuf)
 {
 	u32 num_tok = 0;
 	u32 offset  = 0;
+	u32 len;
 
 	/* go to first token of the string */
 	while ((*(s + offset)) != 0) {
 		offset = skip_space(s, offset);
-		*offbuf = offset;
-		*lenbuf = token_size(s, offset);
-		offset += *lenbuf;
-		lenbuf++;
-		offbuf++;
+		len    = token_size(s, offset);
+
+		/* tokens beyond the buffer capacity are only counted */
+		if (num_tok < max_tok) {
+			offbuf[num_tok] = offset;
+			lenbuf[num_tok] = len;
+		}
+		offset += len;
 		num_tok++;
 	}
 
@@ -168,13 +175,36 @@ static int parse(const char *s, u32 max_tok, u32 *offbuf, u32 *lenbuf)
 }
 
 
+static void resolve(const char *s, u32 num_tok, u32 *offbuf, u32 *lenbuf,
+                    s32 *symbuf)
+{
+	for (u32 i = 0; i < num_tok; i++) {
+		const char *tok = s + offbuf[i];
+		u32         len = lenbuf[i];
+
+		symbuf[i] = SYM_NONE;
+		if (token_type(tok, 0) != TOKEN_IDENT) continue;
+
+		/* identifiers followed by a dot or assignment are variable names */
+		if (i + 1 < num_tok && (s[offbuf[i + 1]] == '.' || s[offbuf[i + 1]] == '='))
+			continue;
+
+		/* skip minus of tag */
+		if (tok[0] == '-') { tok++; len--; }
+
+		symbuf[i] = symtab->lookup(tok, len);
+	}
+}
+
+
 /**************************************
  ** Service structure of this module **
  **************************************/
 
 static struct tokenizer_services services = {
 	parse,
-	token_type
+	token_type,
+	resolve,
 };
 
 
@@ -184,6 +214,8 @@ static struct tokenizer_services services = {
 
 int init_tokenizer(struct dope_services *d)
 {
+	symtab = (symtab_services *)(d->get_module("SymbolTable 1.0"));
+
 	d->register_module("Tokenizer 1.0",&services);
 	return 1;
 }
@@ -26,8 +26,30 @@ enum {
 };
 
 struct tokenizer_services {
+
+	/**
+	 * Split string into tokens
+	 *
+	 * \param max_tok  capacity of the offset and length buffers
+	 * \return         total number of tokens of the string
+	 *
+	 * If the string contains more than max_tok tokens, only the first
+	 * max_tok tokens are stored. The caller can detect this case by
+	 * comparing the return value with max_tok.
+	 */
 	int (*parse)  (const char *str, u32 max_tok, u32 *offbuf, u32 *lenbuf);
 	int (*toktype)(const char *str, u32 offset);
+
+	/**
+	 * Resolve identifier tokens to symbol IDs
+	 *
+	 * For each token, the corresponding symbol ID is written to symbuf. For
+	 * tags (identifiers with a leading minus), the symbol ID of the tag name
+	 * is returned. Variable names (identifiers followed by a dot or an
+	 * assignment) and all other tokens are marked with SYM_NONE.
+	 */
+	void (*resolve)(const char *str, u32 num_tok, u32 *offbuf, u32 *lenbuf,
+	                s32 *symbuf);
 };
 
 #endif /* _DOPE_TOKENIZER_H_ */
@@ -35,12 +35,14 @@
 #include "widget_data.h"
 #include "keymap.h"
 #include "window.h"
+#include "watch.h"
 
 static struct input_services  *input;
 static struct scrdrv_services *scrdrv;
 static struct redraw_services *redraw;
 static struct tick_services   *tick;
 static struct keymap_services *keymap;
+static struct watch_services  *watch;
 
 static s32        omx,omy,omb;                 /* original mouse postion     */
 static s32        curr_mx, curr_my;            /* current mouse position     */
@@ -285,6 +287,7 @@ static int tick_handle_repeat(void *arg)
 		WIDGET *cw = curr_window->win->get_kfocus(curr_window);
 		if (cw) cw->gen->handle_event(cw, &key_repeat_event, NULL);
 	}
+	watch->touch();
 	return 1;
 }
 
@@ -347,22 +350,43 @@ static void handle(void)
 	static EVENT event;
 
 	WIDGET *new_mfocus = NULL;
+	int motion_pending = 0;
+	int num_events     = 0;
 
 	old_mx = curr_mx;
 	old_my = curr_my;
 
+	/*
+	 * Consecutive motion events are coalesced into a single position update.
+	 * The mouse focus is determined only once for a sequence of motion events,
+	 * along with the next event or after the last event. This way, press and
+	 * release events are handled at the exact mouse position. The motion
+	 * event delivered to the widgets below carries the accumulated relative
+	 * motion of the whole sequence.
+	 */
 	while (input->get_event(&event)) {
-		switch (event.type) {
 
-		case EVENT_MOTION:
+		num_events++;
+
+		if (event.type == EVENT_MOTION) {
 			set_pos(curr_mx + event.rel_x, curr_my + event.rel_y);
-			break;
+			motion_pending = 1;
+			continue;
+		}
 
-		case EVENT_ABSMOTION:
+		if (event.type == EVENT_ABSMOTION) {
 			set_pos(event.abs_x, event.abs_y);
-			break;
+			motion_pending = 1;
+			continue;
+		}
+
+		switch (event.type) {
 
 		case EVENT_PRESS:
+
+			/* the mouse focus is frozen while a button is pressed */
+			if (motion_pending) update_mfocus();
+
 			press_cnt++;
 
 			if (event.code == Input::BTN_LEFT)  curr_mb = curr_mb | 0x01;
@@ -395,6 +419,7 @@ static void handle(void)
 			break;
 		}
 
+		motion_pending = 0;
 		update_mfocus();
 
 		if ((event.type == EVENT_PRESS) || (event.type == EVENT_RELEASE)) {
@@ -443,6 +468,9 @@ static void handle(void)
 		}
 	}
 
+	if (motion_pending)
+		update_mfocus();
+
 	/*
 	 * Hell! We got more key release events than press events
 	 * This can happen when a key is pressed during the bootup
@@ -547,6 +575,10 @@ static void handle(void)
 		break;
 	}
 	scrdrv->set_mouse_pos(curr_mx, curr_my);
+
+	/* widgets may have changed by input or while being touched or dragged */
+	if (num_events || curr_state != USERSTATE_IDLE)
+		watch->touch();
 }
 
 
@@ -688,6 +720,7 @@ int init_userstate(struct dope_services *d)
 	redraw  = (redraw_services *)(d->get_module("RedrawManager 1.0"));
 	tick    = (tick_services   *)(d->get_module("Tick 1.0"));
 	keymap  = (keymap_services *)(d->get_module("Keymap 1.0"));
+	watch   = (watch_services  *)(d->get_module("Watch 1.0"));
 
 	d->register_module("UserState 1.0",&services);
 	return 1;
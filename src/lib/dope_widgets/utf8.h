@@ -0,0 +1,101 @@
+/*
+ * \brief   UTF-8 decoding and encoding
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * All strings handled by DOpE are UTF-8 encoded. Bytes that do not start
+ * a well-formed UTF-8 sequence are taken as Latin-1 characters, which
+ * keeps 8-bit text of legacy clients readable.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _DOPE_UTF8_H_
+#define _DOPE_UTF8_H_
+
+enum { UTF8_MAX_LEN = 4 };   /* max length of an encoded code point */
+
+
+/**
+ * Return true if byte continues a UTF-8 sequence
+ */
+static inline int utf8_is_cont(char c)
+{
+	return ((u8)c & 0xc0) == 0x80;
+}
+
+
+/**
+ * Decode code point and advance string pointer to the next character
+ */
+static inline u32 utf8_decode(char const **str)
+{
+	u8 const *s = (u8 const *)*str;
+	u32 c = s[0], len, min, i;
+
+	if (c < 0x80) {
+		*str += 1;
+		return c;
+	}
+
+	if      ((c & 0xe0) == 0xc0) { len = 2; min = 0x80;    c &= 0x1f; }
+	else if ((c & 0xf0) == 0xe0) { len = 3; min = 0x800;   c &= 0x0f; }
+	else if ((c & 0xf8) == 0xf0) { len = 4; min = 0x10000; c &= 0x07; }
+	else                         { *str += 1; return s[0]; }
+
+	/* the null termination ends an incomplete sequence */
+	for (i = 1; i < len; i++) {
+		if (!utf8_is_cont(s[i])) {
+			*str += 1;
+			return s[0];
+		}
+		c = (c << 6) | (s[i] & 0x3f);
+	}
+
+	/* reject overlong encodings and code points beyond unicode */
+	if (c < min || c > 0x10ffff) {
+		*str += 1;
+		return s[0];
+	}
+
+	*str += len;
+	return c;
+}
+
+
+/**
+ * Encode code point
+ *
+ * \param dst  destination buffer of at least 'UTF8_MAX_LEN' bytes
+ * \return     number of bytes written to 'dst'
+ */
+static inline int utf8_encode(u32 c, char *dst)
+{
+	if (c < 0x80) {
+		dst[0] = c;
+		return 1;
+	}
+	if (c < 0x800) {
+		dst[0] = 0xc0 | (c >> 6);
+		dst[1] = 0x80 | (c & 0x3f);
+		return 2;
+	}
+	if (c < 0x10000) {
+		dst[0] = 0xe0 | (c >> 12);
+		dst[1] = 0x80 | ((c >> 6) & 0x3f);
+		dst[2] = 0x80 | (c & 0x3f);
+		return 3;
+	}
+	dst[0] = 0xf0 | (c >> 18);
+	dst[1] = 0x80 | ((c >> 12) & 0x3f);
+	dst[2] = 0x80 | ((c >> 6) & 0x3f);
+	dst[3] = 0x80 | (c & 0x3f);
+	return 4;
+}
+
+#endif /* _DOPE_UTF8_H_ */
@@ -46,6 +46,7 @@ struct variable_connection {
 
 struct variable_data {
 	char const *text;
+	struct text_layout *layout;   /* cached layout of text */
 	s16         font_id;
 	s16         flags;
 	struct variable_connection *connections;
@@ -68,7 +69,13 @@ static int var_draw(VARIABLE *v, struct gfx_ds *ds, long x, long y, WIDGET *orig
 	if (origin == v) return 1;
 	if (origin) return 0;
 
-	if (v->vd->text) {
+	if (v->vd->layout) {
+		struct text_layout *lay = v->vd->layout;
+
+		/* skip characters left of the clipping area */
+		s32 i = font->layout_char_at(lay, gfx->get_clip_x(ds) - tx);
+		gfx->draw_string(ds, tx + lay->offsets[i], ty, BLACK_SOLID, 0, v->vd->font_id, lay->str + i);
+	} else if (v->vd->text) {
 		gfx->draw_string(ds, tx, ty, BLACK_SOLID, 0, v->vd->font_id, v->vd->text);
 	} else {
 		gfx->draw_string(ds, tx, ty, BLACK_SOLID, 0, v->vd->font_id, "<no value>");
@@ -85,7 +92,8 @@ static void var_calc_minmax(VARIABLE *v)
 	char const *txt = "<no_value>";
 	if (v->vd->text) txt = v->vd->text;
 	
-	v->wd->min_w = v->wd->max_w = font->calc_str_width (v->vd->font_id, txt) + 4;
+	v->wd->min_w = v->wd->max_w = (v->vd->layout ? v->vd->layout->width
+	                                             : font->calc_str_width(v->vd->font_id, txt)) + 4;
 	v->wd->min_h = v->wd->max_h = font->calc_str_height(v->vd->font_id, txt) + 4;
 }
 
@@ -108,6 +116,7 @@ static void var_free_data(VARIABLE *v)
 {
 	FREE_CONNECTED_LIST(struct variable_connection, v->vd->connections, free_var_connection);
 	if (v->vd->text) free(v->vd->text);
+	font->release_layout(v->vd->layout);
 }
 
 
@@ -130,6 +139,8 @@ static void var_set_value(VARIABLE *v, char const *new_txt)
 
 	if (v->vd->text) free(v->vd->text);
 	v->vd->text = strdup(new_txt);
+	font->release_layout(v->vd->layout);
+	v->vd->layout = font->get_layout(v->vd->font_id, v->vd->text);
 
 	/* notify all connected widgets */
 	cc = v->vd->connections;
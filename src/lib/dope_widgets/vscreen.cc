@@ -215,14 +215,14 @@ static void grab_tick_callback(WIDGET *w, int dx, int dy)
 static void (*orig_handle_event)(WIDGET *w, EVENT *, WIDGET *from);
 static void vscr_handle_event(VSCREEN *vs, EVENT *e, WIDGET *from)
 {
-	char const *m;
+	struct binding *m;
 	s32 app_id;
 	if (e->type == EVENT_PRESS) {
 		/* transition from grabbed to grab */
 		if (vs->vd->grabmouse == VSCR_MOUSEMODE_GRABBED) {
 			if (e->code == Input::KEY_PAUSE) {
 				vs->vd->grabmouse = VSCR_MOUSEMODE_GRAB;
-				m = vs->gen->get_bind_msg(vs, "discharge");
+				m = vs->gen->get_binding(vs, "discharge");
 				app_id = vs->gen->get_app_id(vs);
 				if (m) msg->send_action_event(app_id, "discharge", m);
 				msg_cnt = 0;
@@ -239,7 +239,7 @@ static void vscr_handle_event(VSCREEN *vs, EVENT *e, WIDGET *from)
 			if (w) w->win->top(w);
 
 			vs->vd->grabmouse = VSCR_MOUSEMODE_GRABBED;
-			m = vs->gen->get_bind_msg(vs, "catch");
+			m = vs->gen->get_binding(vs, "catch");
 			app_id = vs->gen->get_app_id(vs);
 			if (m) msg->send_action_event(app_id, "catch", m);
 			msg_x = (vs->wd->w - msg_w)/2;
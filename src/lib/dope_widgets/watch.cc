@@ -0,0 +1,276 @@
+/*
+ * \brief   DOpE attribute watch module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ *
+ * Clients may subscribe to the attributes of widgets instead of polling
+ * them. Whenever the state of widgets may have changed, the watched
+ * attributes are sampled with the next frame of the animation frame clock.
+ * Changed values are queued as typed events. If the client did not pick up
+ * the previous event of a subscription yet, the queued event is updated
+ * instead of queueing another one. Without changes, the frame clock is
+ * not kept running by the watches.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#include <dope/dopedef.h>
+#include <dope/dopelib.h>
+
+/* local includes */
+#include "dopestd.h"
+#include "widget.h"
+#include "widget_data.h"
+#include "script.h"
+#include "messenger.h"
+#include "relax.h"
+#include "watch.h"
+
+static struct script_services    *script;
+static struct messenger_services *msg;
+static struct relax_services     *relax;
+
+struct watch;
+struct watch {
+	s32             app_id;      /* subscribing application          */
+	WIDGET         *w;           /* watched widget, referenced       */
+	char           *name;        /* attribute as given by the client */
+	char const     *attr;        /* attribute name within 'name'     */
+	struct binding  b;           /* callback of the client           */
+	Attrib_event    last;        /* last reported value              */
+	char           *str;         /* copy of last string value        */
+	int             str_size;    /* size of 'str' buffer             */
+	struct watch   *next;
+};
+
+static struct watch      *first_watch;
+static struct relax_anim *sampler;   /* pending sampling of attributes */
+
+int init_watch(struct dope_services *d);
+
+
+/********************************
+ ** Functions for internal use **
+ ********************************/
+
+/**
+ * Check if sampled value differs from the last reported one
+ */
+static int value_changed(struct watch *wa, Attrib_event const *ev)
+{
+	if (ev->value_type != wa->last.value_type) return 1;
+
+	switch (ev->value_type) {
+		case ATTRIB_TYPE_FLOAT:  return ev->float_value != wa->last.float_value;
+		case ATTRIB_TYPE_STRING: return !streq(ev->string, wa->str, wa->str_size);
+		default:                 return ev->long_value  != wa->last.long_value;
+	}
+}
+
+
+/**
+ * Remember string value, the reported event refers to the copy
+ *
+ * \return  0 if out of memory
+ */
+static int store_string(struct watch *wa, char const *string)
+{
+	int len = strlen(string);
+
+	if (len >= wa->str_size) {
+		int   new_size = len + 1;
+		char *new_str  = (char *)malloc(new_size);
+		if (!new_str) return 0;
+
+		free(wa->str);
+		wa->str      = new_str;
+		wa->str_size = new_size;
+	}
+	memcpy(wa->str, string, len + 1);
+	return 1;
+}
+
+
+/**
+ * Sample attribute and report a changed value to the client
+ *
+ * \param force  report value even if it did not change
+ */
+static void sample(struct watch *wa, int force)
+{
+	Event_union ev;
+
+	if (script->read_attrib(wa->w, wa->attr, &ev.attrib) < 0) return;
+	if (!force && !value_changed(wa, &ev.attrib)) return;
+
+	/*
+	 * A queued event that still refers to the old string gets replaced by
+	 * the new event because the binding coalesces its events.
+	 */
+	if (ev.attrib.value_type == ATTRIB_TYPE_STRING) {
+		if (!store_string(wa, ev.attrib.string)) return;
+		ev.attrib.string = wa->str;
+	}
+
+	ev.type        = EVENT_TYPE_ATTRIB;
+	ev.attrib.name = wa->name;
+	wa->last       = ev.attrib;
+	msg->send_event(wa->app_id, &ev, &wa->b);
+}
+
+
+/**
+ * Frame-clock callback
+ *
+ * The sampling is done once per request via 'touch'.
+ */
+static int sample_watches(void *arg)
+{
+	for (struct watch *wa = first_watch; wa; wa = wa->next)
+		sample(wa, 0);
+
+	sampler = NULL;
+	return 0;
+}
+
+
+static void free_watch(struct watch *wa)
+{
+	msg->discard(wa->app_id, &wa->b);
+	msg->free_filter(wa->b.filter);
+	wa->w->gen->dec_ref(wa->w);
+	free(wa->str);
+	free(wa->name);
+	free(wa);
+}
+
+
+/***********************
+ ** Service functions **
+ ***********************/
+
+static void watch_remove(s32 app_id, char const *var_attr)
+{
+	struct watch **wp, *wa;
+
+	for (wp = &first_watch; (wa = *wp); wp = &wa->next) {
+		if (wa->app_id != app_id || !streq(wa->name, var_attr, 256)) continue;
+
+		*wp = wa->next;
+		free_watch(wa);
+		return;
+	}
+}
+
+
+static int watch_add(s32 app_id, char const *var_attr,
+                     void (*callback)(Event_union *, void *), void *arg)
+{
+	struct watch *wa;
+	Attrib_event  probe;
+	WIDGET       *w;
+	int len, dot, err;
+
+	if (!var_attr || !callback) return DOPECMD_ERR_INVALID_ARG;
+
+	/* split into variable and attribute name at the last dot */
+	len = strlen(var_attr);
+	for (dot = len - 1; dot > 0 && var_attr[dot] != '.'; dot--);
+	if (dot <= 0) return DOPECMD_ERR_INVALID_ARG;
+
+	if (!(wa = (struct watch *)zalloc(sizeof(struct watch)))
+	 || !(wa->name = (char *)malloc(len + 1))) {
+		free(wa);
+		return DOPECMD_ERR_NO_MEM;
+	}
+	memcpy(wa->name, var_attr, len + 1);
+	wa->name[dot] = 0;
+	wa->attr = wa->name + dot + 1;
+
+	w = script->lookup_widget(app_id, wa->name);
+	wa->name[dot] = '.';
+
+	err = w ? script->read_attrib(w, wa->attr, &probe) : DOPECMD_ERR_UNKNOWN_VAR;
+	if (err < 0) {
+		free(wa->name);
+		free(wa);
+		return err;
+	}
+
+	watch_remove(app_id, var_attr);
+
+	wa->b.filter = msg->create_filter("-coalesce yes");
+	if (!wa->b.filter) {
+		msg->free_filter(wa->b.filter);
+		free(wa->name);
+		free(wa);
+		return DOPECMD_ERR_NO_MEM;
+	}
+
+	w->gen->inc_ref(w);
+	wa->app_id     = app_id;
+	wa->w          = w;
+	wa->b.callback = callback;
+	wa->b.arg      = arg;
+	wa->b.widget   = w;
+	wa->next       = first_watch;
+	first_watch    = wa;
+
+	/* report initial value */
+	sample(wa, 1);
+	return 0;
+}
+
+
+static void watch_release_app(s32 app_id)
+{
+	struct watch **wp, *wa;
+
+	for (wp = &first_watch; (wa = *wp); ) {
+		if (wa->app_id != app_id) {
+			wp = &wa->next;
+			continue;
+		}
+		*wp = wa->next;
+		free_watch(wa);
+	}
+}
+
+
+static void watch_touch(void)
+{
+	if (first_watch && !sampler)
+		sampler = relax->animate(sample_watches, NULL);
+}
+
+
+/**************************************
+ ** Service structure of this module **
+ **************************************/
+
+static struct watch_services services = {
+	watch_add,
+	watch_remove,
+	watch_release_app,
+	watch_touch,
+};
+
+
+/************************
+ ** Module entry point **
+ ************************/
+
+int init_watch(struct dope_services *d)
+{
+	script = (script_services    *)(d->get_module("Script 1.0"));
+	msg    = (messenger_services *)(d->get_module("Messenger 1.0"));
+	relax  = (relax_services     *)(d->get_module("Relax 1.0"));
+
+	d->register_module("Watch 1.0",&services);
+	return 1;
+}
@@ -0,0 +1,52 @@
+/*
+ * \brief   Interface of attribute watch module
+ * \date    2026-10-18
+ * \author  Genode Labs
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the DOpE package, which is distributed under
+ * the terms of the GNU General Public Licence 2.
+ */
+
+#ifndef _DOPE_WATCH_H_
+#define _DOPE_WATCH_H_
+
+union Event_union;
+struct watch_services {
+
+	/**
+	 * Subscribe to the changes of a widget attribute
+	 *
+	 * \param var_attr  variable name of the widget followed by a dot and
+	 *                  the attribute name
+	 * \return          0 on success or a negative error code
+	 *
+	 * An existing subscription to the same attribute is replaced. The
+	 * caller must hold the widget-tree lock.
+	 */
+	int  (*add) (s32 app_id, char const *var_attr,
+	             void (*callback)(union Event_union *, void *), void *arg);
+
+	/**
+	 * Cancel subscription
+	 */
+	void (*remove) (s32 app_id, char const *var_attr);
+
+	/**
+	 * Cancel all subscriptions of an application
+	 */
+	void (*release_app) (s32 app_id);
+
+	/**
+	 * Request sampling of the watched attributes with the next frame
+	 *
+	 * Must be called whenever the state of widgets may have changed, for
+	 * example, after updating a widget or handling user input.
+	 */
+	void (*touch) (void);
+};
+
+#endif /* _DOPE_WATCH_H_ */
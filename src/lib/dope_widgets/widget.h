@@ -37,6 +37,8 @@ enum {
 
 struct widget_methods;
 struct gfx_ds;
+struct binding;
+union  Event_union;
 
 struct widget {
 	struct widget_methods *gen;   /* generic widget functions       */
@@ -317,7 +319,24 @@ struct widget_methods {
 	void        (*bind)         (WIDGETARG *, char const *bind_ident,
 	                                          char const *message);
 	void        (*unbind)       (WIDGETARG *, char const *bind_ident);
-	char const *(*get_bind_msg) (WIDGETARG *, char const *bind_ident);
+
+
+	/**
+	 * Bind callback function to an event
+	 *
+	 * In contrast to 'bind', which is used by the command interpreter,
+	 * the callback and its argument are passed directly.
+	 */
+	void (*bind_callback) (WIDGETARG *, char const *bind_ident,
+	                       void (*callback)(union Event_union *, void *), void *arg);
+
+
+	/**
+	 * Request binding for the specified event
+	 *
+	 * \return  binding or NULL if the widget is not bound to the event
+	 */
+	struct binding *(*get_binding) (WIDGETARG *, char const *bind_ident);
 
 
 	/**
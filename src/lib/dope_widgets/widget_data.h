@@ -15,6 +15,8 @@
 #ifndef _DOPE_WIDGET_DATA_H_
 #define _DOPE_WIDGET_DATA_H_
 
+#include "event.h"
+
 /**
  * Widget property and state flags
  */
@@ -39,26 +41,30 @@ enum {
 	WID_UPDATE_MINMAX   = 0x0002,
 	WID_UPDATE_NEWCHILD = 0x0004,
 	WID_UPDATE_REFRESH  = 0x0008,
+	WID_UPDATE_LAYOUT   = 0x0010,  /* queued for the next layout pass */
 };
 
+union Event_union;
+struct bind_filter;
+
 struct binding;
 struct binding {
-	s16             ev_type;     /* event type          */
-	char     const *bind_ident;  /* action event string */
-	char     const *msg;         /* associated message  */
-	struct binding *next;        /* next binding        */
+	s16                 ev_type;     /* event type                    */
+	char         const *bind_ident;  /* action event string           */
+	void              (*callback) (union Event_union *, void *);
+	void               *arg;         /* argument passed to callback   */
+	WIDGET             *widget;      /* widget that owns the binding  */
+	struct bind_filter *filter;      /* delivery options or NULL      */
+	struct binding     *next;        /* next binding                  */
 };
 
-
-struct new_binding;
-struct new_binding {
-	int         app_id;       /* application to receive the event */
-	char const *name;         /* name of binding                  */
-	char      **args;         /* arguments to pass with the event */
-	char      **cond_names;   /* conditions to be checked         */
-	char      **cond_values;  /* desired values of the conditions */
-	struct new_binding *next;
-};
+/**
+ * Number of slots of the per-widget input binding table
+ *
+ * The table is indexed by the input event type. Action bindings are kept
+ * in the 'bindings' list of the widget.
+ */
+enum { NUM_INPUT_BINDINGS = EVENT_KEY_REPEAT + 1 };
 
 
 struct widget_data {
@@ -74,9 +80,23 @@ struct widget_data {
 	void    (*click) (void *);  /* event handle routine                */
 	long    ref_cnt;            /* reference counter                   */
 	s32     app_id;             /* application that owns the widget    */
-	struct binding *bindings;   /* event bindings                      */
-	struct new_binding *new_bindings;
+	struct binding *bindings;   /* action event bindings               */
+	struct binding **input_bindings;  /* input bindings by event type  */
 };
 
 
+/**
+ * Look up input binding of a widget for the specified event type
+ *
+ * \return  binding or NULL if the event type is not bound
+ */
+static inline struct binding *input_binding(struct widget_data *wd, long ev_type)
+{
+	if (!wd->input_bindings || ev_type <= 0 || ev_type >= NUM_INPUT_BINDINGS)
+		return 0;
+
+	return wd->input_bindings[ev_type];
+}
+
+
 #endif /* _DOPE_WIDGET_DATA_H_ */
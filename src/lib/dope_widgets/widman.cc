@@ -31,12 +31,16 @@
 #include "list_macros.h"
 #include "window.h"
 #include "userstate.h"
+#include "layout.h"
+#include "watch.h"
 
 static struct redraw_services    *redraw;
 static struct script_services    *script;
 static struct appman_services    *appman;
 static struct userstate_services *userstate;
 static struct messenger_services *msg;
+static struct layout_services    *layout;
+static struct watch_services     *watch;
 
 int init_widman(struct dope_services *d);
 
@@ -59,31 +63,25 @@ static inline void free_binding(struct binding *b)
 {
 	if (b->bind_ident)
 		free(b->bind_ident);
-	if (b->msg)
-		free(b->msg);
+	if (b->filter)
+		msg->free_filter(b->filter);
 	free(b);
 }
 
 
 /**
- * Deallocate binding data structure
+ * Free input binding table of a widget
  */
-static void free_new_binding(struct new_binding *b)
+static void free_input_bindings(struct widget_data *wd)
 {
-	int i;
-	if (b->name)
-		free(b->name);
+	if (!wd->input_bindings) return;
 
-	for (i=0; b->args[i]; i++) free(b->args[i]);
-	free(b->args);
+	for (int i = 0; i < NUM_INPUT_BINDINGS; i++)
+		if (wd->input_bindings[i])
+			free_binding(wd->input_bindings[i]);
 
-	for (i=0; b->cond_names[i]; i++) free(b->cond_names[i]);
-	free(b->cond_names);
-
-	for (i=0; b->cond_values[i]; i++) free(b->cond_values[i]);
-	free(b->cond_values);
-
-	free(b);
+	free(wd->input_bindings);
+	wd->input_bindings = NULL;
 }
 
 
@@ -498,15 +496,18 @@ static void wid_update(WIDGET *w)
 	 || w->wd->min_h != old_min_h || w->wd->max_h != old_max_h)
 		w->wd->update |= WID_UPDATE_MINMAX;
 	
-	if (w->wd->update & WID_UPDATE_MINMAX) {
-		WIDGET *parent = w->gen->get_parent((WIDGET *)w);
-		if (parent) parent->gen->do_layout(parent, w);
-	}
+	/* let the parent adapt to the new min/max size in the next layout pass */
+	if ((w->wd->update & WID_UPDATE_MINMAX) && w->gen->get_parent(w))
+		layout->update_parent(w);
+
 	if (w->wd->update) {
 		w->gen->updatepos(w);
 		w->gen->force_redraw(w);
 	}
 	w->wd->update = 0;
+
+	/* attributes of the widget may have changed */
+	watch->touch();
 }
 
 
@@ -542,7 +543,7 @@ static void wid_dec_ref(WIDGET *w)
 
 	/* free bindings */
 	FREE_CONNECTED_LIST(struct binding, w->wd->bindings, free_binding);
-	FREE_CONNECTED_LIST(struct new_binding, w->wd->new_bindings, free_new_binding);
+	free_input_bindings(w->wd);
 
 	/* free widget struct */
 	free(w);
@@ -576,11 +577,9 @@ static void wid_handle_event(WIDGET *cw,EVENT *e, WIDGET *from)
 	}
 
 	/* check bindings */
-	for (cb = cw->wd->bindings; cb; cb = cb->next) {
-		if (cb->ev_type == e->type) {
-			msg->send_input_event(cw->wd->app_id,e,cb->msg);
-			propagate = 0;
-		}
+	if ((cb = input_binding(cw->wd, e->type))) {
+		msg->send_input_event(cw->wd->app_id, e, cb);
+		propagate = 0;
 	}
 
 	/* propagate event to parent widget by default */
@@ -613,7 +612,7 @@ static int wid_do_layout(WIDGET *cw,WIDGET *child)
 	if (child->wd->update & WID_UPDATE_SIZE) child->gen->updatepos(child);
 
 	cw->wd->update |= WID_UPDATE_MINMAX;
-	cw->gen->update(cw);
+	layout->update(cw);
 
 	/*
 	 * return 1 -> we didnt made a redraw - the caller has to do this
@@ -624,60 +623,152 @@ static int wid_do_layout(WIDGET *cw,WIDGET *child)
 }
 
 
-///**
-// * Attach event binding to widget
-// */
-//static void wid_new_bind(WIDGET *cw, struct new_binding *new) {
-//	struct new_binding *b;
-//
-//	/* check if there exists a binding with the same name */
-//	b = cw->wd->new_bindings;
-//	while (b) {
-//		if (dope_streq(b->name, new->name, 255)) {
-//			REMOVE_LIST_ELEMENT(struct new_binding, cw->wd->new_bindings, b, free_new_binding);
-//			break;
-//		}
-//		b = b->next;
-//	}
-//
-//	/* attach new binding */
-//	
-//}
+/**
+ * Determine event type that corresponds to a binding identifier
+ *
+ * Identifiers that do not refer to an input event denote action events.
+ */
+static s16 bind_ident_type(char const *bind_ident)
+{
+	if (streq(bind_ident, "press",     6)) return EVENT_PRESS;
+	if (streq(bind_ident, "release",   8)) return EVENT_RELEASE;
+	if (streq(bind_ident, "motion",    7)) return EVENT_MOTION;
+	if (streq(bind_ident, "leave",     6)) return EVENT_MOUSE_LEAVE;
+	if (streq(bind_ident, "enter",     6)) return EVENT_MOUSE_ENTER;
+	if (streq(bind_ident, "keyrepeat", 10)) return EVENT_KEY_REPEAT;
+	return EVENT_ACTION;
+}
 
 
 /**
- * Add event binding for a widget
+ * Determine length of the event name at the begin of a binding identifier
+ *
+ * The name may be followed by delivery options, separated by a space.
  */
-static void wid_bind(WIDGET *cw, char const *bind_ident, char const *message)
+static inline int bind_name_len(char const *bind_ident)
+{
+	int len = 0;
+	while (bind_ident[len] && bind_ident[len] != ' ') len++;
+	return len;
+}
+
+
+/**
+ * Read hexadecimal number of a textual binding message
+ *
+ * The number ends at the first non-hex character. On return, 's' points
+ * to the character after the number.
+ */
+static unsigned long parse_hex(char const **s)
+{
+	unsigned long result = 0;
+	unsigned i;
+	char c;
+
+	for (i = 0; i < 2*sizeof(unsigned long); i++, (*s)++) {
+		c = **s;
+		if      (c >= '0' && c <= '9') result = result*16 + (c - '0');
+		else if (c >= 'a' && c <= 'f') result = result*16 + (c - 'a' + 10);
+		else if (c >= 'A' && c <= 'F') result = result*16 + (c - 'A' + 10);
+		else break;
+	}
+	return result;
+}
+
+
+/**
+ * Remove event binding from a widget
+ */
+static void wid_unbind(WIDGET *cw, char const *bind_ident)
+{
+	struct binding **b;
+	s16 ev_type = bind_ident_type(bind_ident);
+
+	if (ev_type != EVENT_ACTION) {
+		if (!input_binding(cw->wd, ev_type)) return;
+		free_binding(cw->wd->input_bindings[ev_type]);
+		cw->wd->input_bindings[ev_type] = NULL;
+		return;
+	}
+
+	/* search for binding to remove */
+	for (b = &cw->wd->bindings; *b; b = &(*b)->next) {
+		if (!streq((*b)->bind_ident, bind_ident, 256)) continue;
+
+		struct binding *rb = *b;
+		*b = rb->next;
+		free_binding(rb);
+		return;
+	}
+}
+
+
+/**
+ * Bind callback function to an event of a widget
+ *
+ * An existing binding for the same event is replaced. Input events are
+ * stored in a table indexed by the event type, action events in the
+ * 'bindings' list of the widget. Delivery options following the event
+ * name are evaluated by the messenger.
+ */
+static void wid_bind_callback(WIDGET *cw, char const *bind_ident,
+                              void (*callback)(Event_union *, void *), void *arg)
 {
 	struct binding *binding;
+	int   name_len = bind_name_len(bind_ident);
+	char *name;
+	s16   ev_type;
 
 	INFO(printf("Widman(bind): create new binding for %s\n",bind_ident);)
+
+	if (!(name = (char *)malloc(name_len + 1))) {
+		ERROR(printf("WidgetManager(bind): out of memory!\n");)
+		return;
+	}
+	memcpy(name, bind_ident, name_len);
+	name[name_len] = 0;
+
+	ev_type = bind_ident_type(name);
+	wid_unbind(cw, name);
+
+	if (ev_type != EVENT_ACTION && !cw->wd->input_bindings) {
+		cw->wd->input_bindings = (struct binding **)
+			zalloc(sizeof(struct binding *)*NUM_INPUT_BINDINGS);
+		if (!cw->wd->input_bindings) {
+			ERROR(printf("WidgetManager(bind): out of memory!\n");)
+			free(name);
+			return;
+		}
+	}
+
 	binding = (struct binding *)zalloc(sizeof(struct binding));
 	if (!binding) {
 		ERROR(printf("WidgetManager(bind): out of memory!\n");)
+		free(name);
 		return;
 	}
 
-	binding->msg        = strdup(message);
-	binding->next       = cw->wd->bindings;
-	binding->bind_ident = strdup(bind_ident);
-	cw->wd->bindings    = binding;
+	binding->ev_type    = ev_type;
+	binding->bind_ident = name;
+	binding->callback   = callback;
+	binding->arg        = arg;
+	binding->widget     = cw;
+
+	if (bind_ident[name_len])
+		binding->filter = msg->create_filter(bind_ident + name_len);
 
-	if (streq(bind_ident, "press",     6)) {binding->ev_type = EVENT_PRESS;       }
-	if (streq(bind_ident, "release",   8)) {binding->ev_type = EVENT_RELEASE;     }
-	if (streq(bind_ident, "motion",    7)) {binding->ev_type = EVENT_MOTION;      }
-	if (streq(bind_ident, "leave",     6)) {binding->ev_type = EVENT_MOUSE_LEAVE; }
-	if (streq(bind_ident, "enter",     6)) {binding->ev_type = EVENT_MOUSE_ENTER; }
-	if (streq(bind_ident, "keyrepeat", 9)) {binding->ev_type = EVENT_KEY_REPEAT;  }
+	if (ev_type == EVENT_ACTION) {
+		binding->next    = cw->wd->bindings;
+		cw->wd->bindings = binding;
+		return;
+	}
 
-	if (binding->ev_type == 0)
-		binding->ev_type = EVENT_ACTION;
+	cw->wd->input_bindings[ev_type] = binding;
 
 	/* enable widget to receive the keyboard focus */
-	if (binding->ev_type == EVENT_PRESS
-	 || binding->ev_type == EVENT_RELEASE
-	 || binding->ev_type == EVENT_KEY_REPEAT) {
+	if (ev_type == EVENT_PRESS
+	 || ev_type == EVENT_RELEASE
+	 || ev_type == EVENT_KEY_REPEAT) {
 
 		/* only consider selectable or editable widgets to take the focus */
 		if ((cw->wd->flags & (WID_FLAGS_SELECTABLE | WID_FLAGS_EDITABLE))
@@ -696,31 +787,45 @@ static void wid_bind(WIDGET *cw, char const *bind_ident, char const *message)
 
 
 /**
- * Remove event binding from a widget
+ * Add event binding for a widget
+ *
+ * This is the script-level variant of 'bind'. The message contains the
+ * callback function and its argument as hexadecimal numbers separated by
+ * a comma. It is decoded once when the binding is created.
  */
-static void wid_unbind(WIDGET *cw, char const *bind_ident)
+static void wid_bind(WIDGET *cw, char const *bind_ident, char const *message)
 {
-	struct binding *b = cw->wd->bindings;
+	void (*callback)(Event_union *, void *);
+	void *arg;
 
-	/* search for binding to remove */
-	for (; b && b->next && streq(b->next->bind_ident, bind_ident, 16); b = b->next);
+	callback = (void (*)(Event_union *, void *))parse_hex(&message);
+	while (*message == ',' || *message == ' ') message++;
+	arg = (void *)parse_hex(&message);
 
-	/* remove binding from binding list of the widget */
-	if (!b) return;
-	REMOVE_LIST_ELEMENT(struct binding, &cw->wd->bindings, b, free_binding);
+	if (!callback) {
+		ERROR(printf("WidgetManager(bind): invalid binding message\n");)
+		return;
+	}
+	cw->gen->bind_callback(cw, bind_ident, callback, arg);
 }
 
 
 /**
- * Check if widget is bound to a certain event
+ * Request binding of a widget for a certain event
+ *
+ * \return  binding or NULL if the widget is not bound to the event
  */
-static char const *wid_get_bind_msg(WIDGET *cw, char const *bind_ident)
+static struct binding *wid_get_binding(WIDGET *cw, char const *bind_ident)
 {
 	struct binding *cb;
+	s16 ev_type = bind_ident_type(bind_ident);
+
+	if (ev_type != EVENT_ACTION)
+		return input_binding(cw->wd, ev_type);
 
 	for (cb = cw->wd->bindings; cb; cb = cb->next)
-		if (streq(cb->bind_ident,bind_ident, 256))
-			return cb->msg;
+		if (streq(cb->bind_ident, bind_ident, 256))
+			return cb;
 
 	return NULL;
 }
@@ -810,6 +915,7 @@ static void default_widget_data(struct widget_data *d)
 	d->ref_cnt = 1;
 	d->app_id  = -1;
 	d->bindings= 0;
+	d->input_bindings = 0;
 }
 
 
@@ -870,7 +976,8 @@ static void default_widget_methods(struct widget_methods *m)
 	m->do_layout      = wid_do_layout;
 	m->bind           = wid_bind;
 	m->unbind         = wid_unbind;
-	m->get_bind_msg   = wid_get_bind_msg;
+	m->bind_callback  = wid_bind_callback;
+	m->get_binding    = wid_get_binding;
 	m->drawarea       = wid_drawarea;
 	m->drawbehind     = wid_drawbehind;
 	m->draw_bg        = wid_draw_bg;
@@ -917,6 +1024,8 @@ int init_widman(struct dope_services *d)
 	script    = (script_services    *)(d->get_module("Script 1.0"));
 	appman    = (appman_services    *)(d->get_module("ApplicationManager 1.0"));
 	userstate = (userstate_services *)(d->get_module("UserState 1.0"));
+	layout    = (layout_services    *)(d->get_module("Layout 1.0"));
+	watch     = (watch_services     *)(d->get_module("Watch 1.0"));
 
 	d->register_module("WidgetManager 1.0",&services);
 	return 1;
@@ -213,7 +213,7 @@ static void win_move_motion_callback(WIDGET *cw, int dx, int dy)
 	nwy1 = owy1 + dy;
 	curr_screen->scr->place(curr_screen, curr_window, nwx1, nwy1, NOARG, NOARG);
 	if (dx || dy) {
-		char const *m = curr_window->gen->get_bind_msg((WIDGET *)curr_window, "move");
+		struct binding *m = curr_window->gen->get_binding((WIDGET *)curr_window, "move");
 		s32        id = curr_window->gen->get_app_id((WIDGET *)curr_window);
 		if (m) msg->send_action_event(id, "move", m);
 	}
@@ -221,9 +221,9 @@ static void win_move_motion_callback(WIDGET *cw, int dx, int dy)
 
 
 static void win_close_leave_callback(WIDGET *cw, int dx, int dy) {
-	WINDOW     *w;
-	char const *m;
-	s32         id;
+	WINDOW         *w;
+	struct binding *m;
+	s32             id;
 
 	/* cw is the close button */
 	if (!cw || !cw->gen->get_state(cw)) return;
@@ -233,7 +233,7 @@ static void win_close_leave_callback(WIDGET *cw, int dx, int dy) {
 	if (!w) return;
 
 	/* send close event to client */
-	m  = w->gen->get_bind_msg((WIDGET *)w, "close");
+	m  = w->gen->get_binding((WIDGET *)w, "close");
 	id = w->gen->get_app_id((WIDGET *)w);
 	if (m) msg->send_action_event(id, "close", m);
 
@@ -249,7 +249,7 @@ static void win_move_leave_callback(WIDGET *cw, int dx, int dy)
 	if (!curr_window) return;
 
 	if (dx || dy) {
-		char const *m  = curr_window->gen->get_bind_msg((WIDGET *)curr_window, "moved");
+		struct binding *m  = curr_window->gen->get_binding((WIDGET *)curr_window, "moved");
 		s32         id = curr_window->gen->get_app_id((WIDGET *)curr_window);
 		if (m) msg->send_action_event(id, "moved", m);
 	}
@@ -335,11 +335,11 @@ static void win_resize_leave_callback(WIDGET *cw, int dx, int dy)
 	if (!curr_window) return;
 
 	if (dx || dy) {
-		char const *m = curr_window->gen->get_bind_msg((WIDGET *)curr_window, "resized");
+		struct binding *m = curr_window->gen->get_binding((WIDGET *)curr_window, "resized");
 		s32        id = curr_window->gen->get_app_id((WIDGET *)curr_window);
 		if (m) msg->send_action_event(id, "resized", m);
 		if ((owx1 != nwx1) || (owy1 != nwy1)) {
-			m = curr_window->gen->get_bind_msg((WIDGET *)curr_window, "moved");
+			m = curr_window->gen->get_binding((WIDGET *)curr_window, "moved");
 			if (m) msg->send_action_event(id, "moved", m);
 		}
 	}
@@ -681,9 +681,8 @@ static void win_handle_event(WIDGET *w, EVENT *ev, WIDGET *from)
 	}
 
 	/* check bindings */
-	for (cb = w->wd->bindings; cb; cb = cb->next)
-		if (cb->ev_type == ev->type)
-			msg->send_input_event(w->wd->app_id, ev, cb->msg);
+	if ((cb = input_binding(w->wd, ev->type)))
+		msg->send_input_event(w->wd->app_id, ev, cb);
 
 	if ((ev->type != EVENT_PRESS) || (ev->code != Input::BTN_LEFT)) return;
 
@@ -799,12 +798,12 @@ static void win_close(WINDOW *w)
 static void win_top(WINDOW *w)
 {
 	SCREEN *scr;
-	char const *message;
+	struct binding *message;
 
 	scr = (SCREEN *)w->gen->get_parent(w);
 	if (scr) scr->scr->top(scr, w);;
 
-	message = w->gen->get_bind_msg(w, "top");
+	message = w->gen->get_binding(w, "top");
 	if (message) msg->send_action_event(w->wd->app_id, "top", message);
 
 	userstate->set_active_window(w, 0);
@@ -1002,7 +1001,7 @@ static void win_handle_close(WINDOW *w, WIDGET *cw) {
 	if (!cw) return;
 
 	/* handle close only when binding is set */
-	if (!w->gen->get_bind_msg((WIDGET *)w, "close")) return;
+	if (!w->gen->get_binding((WIDGET *)w, "close")) return;
 
 	cw->gen->set_state(cw, 1);
 	cw->gen->update(cw);
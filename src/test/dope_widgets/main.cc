@@ -15,7 +15,6 @@
 #include <base/printf.h>
 #include <dope/dopelib.h>
 #include <dope/vscreen.h>
-#include <timer_session/connection.h>
 
 /* local */
 #include "util.h"
@@ -116,11 +115,7 @@ int main(int argc, char **argv)
 	/* run the GUI */
 	printf("Running GUI...\n");
 
-	Timer::Connection timer;
-	for (;;) {
-		dope_process_event(0);
-		timer.msleep(10);
-	}
+	dope_eventloop(DOPE_ALL_APPS);
 
 	return 0;
 }